@@ -12,6 +12,8 @@
 #include "Utils/FileHelpers.h"
 #include "Utils/ResourceManager/ResourceManager.h"
 #include "Utils/ImGuiHelper.h"
+#include "Utils/JobSystem.h"
+#include "Utils/PakArchive.h"
 
 // Graphics
 #include "Graphics/Buffers/IndexBuffer.h"
@@ -32,6 +34,7 @@
 #include "Gameplay/Material.h"
 #include "Gameplay/GameObject.h"
 #include "Gameplay/Scene.h"
+#include "Gameplay/Prefab.h"
 
 // Components
 #include "Gameplay/Components/IComponent.h"
@@ -71,6 +74,14 @@ std::string Application::_applicationName = "INFR-2350U - DEMO";
 
 #define DEFAULT_WINDOW_WIDTH 1280
 #define DEFAULT_WINDOW_HEIGHT 720
+// The time in seconds to spend on loading a scene each frame
+#define SCENE_LOAD_FRAME_BUDGET (4.0 / 1000.0)
+// How much memory resources can use before unused ones are unloaded, can be changed in the app settings
+#define DEFAULT_RESOURCE_BUDGET_MB 1024
+// The time in seconds to spend on creating resources requested with ResourceManager::GetAsync each frame
+#define RESOURCE_LOAD_FRAME_BUDGET (2.0 / 1000.0)
+// The archive that assets are packed into for release builds, loose files are used if it doesn't exist
+#define DEFAULT_ASSET_ARCHIVE "assets.pak"
 
 Application::Application() :
 	_window(nullptr),
@@ -79,7 +90,8 @@ Application::Application() :
 	_isEditor(true),
 	_windowTitle("INFR - 2350U"),
 	_currentScene(nullptr),
-	_targetScene(nullptr)
+	_targetScene(nullptr),
+	_sceneLoader(nullptr)
 { }
 
 Application::~Application() = default; 
@@ -119,21 +131,16 @@ void Application::Quit() {
 
 bool Application::LoadScene(const std::string& path) {
 	if (std::filesystem::exists(path)) { 
-
-		std::string manifestPath = std::filesystem::path(path).stem().string() + "-manifest.json";
-		if (std::filesystem::exists(manifestPath)) {
-			LOG_INFO("Loading manifest from \"{}\"", manifestPath);
-			ResourceManager::LoadManifest(manifestPath);
-		}
-
-		Gameplay::Scene::Sptr scene = Gameplay::Scene::Load(path);
-		LoadScene(scene);
-		return scene != nullptr;
+		// The manifest and scene are read on a worker thread, then finished off in _UpdateSceneLoad
+		_sceneLoader = Gameplay::SceneLoader::Start(path);
+		return true;
 	}
 	return false;
 }
 
 void Application::LoadScene(const Gameplay::Scene::Sptr& scene) {
+	// Switching to a scene directly abandons any scene we were loading
+	_sceneLoader = nullptr;
 	_targetScene = scene;
 }
 
@@ -176,9 +183,25 @@ void Application::_Run()
 	// By default, we want our viewport to be the whole screen
 	_primaryViewport = { 0, 0, _windowSize.x, _windowSize.y };
 
+	ResourceManager::SetMemoryBudget(static_cast<size_t>(JsonGet(_appSettings, "resource_budget_mb", DEFAULT_RESOURCE_BUDGET_MB)) * 1024 * 1024);
+
+	// Mount any asset archives before anything gets loaded, so that files are found in them first. Only
+	// the editor saves over assets, so only the editor needs to check for loose files that are newer
+	PakArchive::SetLooseFileOverrides(_isEditor);
+	if (_appSettings.contains("asset_archives") && _appSettings["asset_archives"].is_array()) {
+		for (const auto& archive : _appSettings["asset_archives"]) {
+			if (archive.is_string() && std::filesystem::exists(archive.get<std::string>())) {
+				PakArchive::Mount(archive.get<std::string>());
+			}
+		}
+	}
+
 	// Register all component and resource types
 	_RegisterClasses();
 
+	// Spin up our worker threads
+	JobSystem::Init();
+
 
 	// Load all layers
 	_Load();
@@ -191,6 +214,16 @@ void Application::_Run()
 
 	// Infinite loop as long as the application is running
 	while (_isRunning) {
+		// Upload any resources that finished decoding in the background
+		ResourceManager::UpdateAsync(RESOURCE_LOAD_FRAME_BUDGET);
+		// Unload resources that are no longer used (ex: from the last scene) if we're over budget
+		ResourceManager::EnforceMemoryBudget();
+
+		// Spend part of the frame on any scene that is loading in the background
+		if (_sceneLoader != nullptr) {
+			_UpdateSceneLoad();
+		}
+
 		// Handle scene switching
 		if (_targetScene != nullptr) {
 			_HandleSceneChange();
@@ -264,6 +297,7 @@ void Application::_RegisterClasses()
 	ResourceManager::RegisterType<MeshResource>();
 	ResourceManager::RegisterType<Font>();
 	ResourceManager::RegisterType<Framebuffer>();
+	ResourceManager::RegisterType<Prefab>();
 
 	// Register all of our component types so we can load them from files
 	ComponentManager::RegisterType<Camera>();
@@ -367,6 +401,9 @@ void Application::_Unload() {
 
 	// Clean up ImGui
 	ImGuiHelper::Cleanup();
+
+	// Stop our worker threads
+	JobSystem::Shutdown();
 }
 
 void Application::_HandleSceneChange() {
@@ -401,6 +438,19 @@ void Application::_HandleSceneChange() {
 	_targetScene = nullptr;
 }
 
+void Application::_UpdateSceneLoad() {
+	if (_sceneLoader->Update(SCENE_LOAD_FRAME_BUDGET)) {
+		Gameplay::Scene::Sptr scene = _sceneLoader->GetScene();
+		if (scene != nullptr) {
+			// The scene gets swapped in by _HandleSceneChange, just like any other scene
+			LoadScene(scene);
+		} else {
+			LOG_ERROR("Failed to load scene from \"{}\"", _sceneLoader->GetPath());
+			_sceneLoader = nullptr;
+		}
+	}
+}
+
 void Application::_HandleWindowSizeChanged(const glm::ivec2& newSize) {
 	for (const auto& layer : _layers) {
 		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnWindowResize)) {
@@ -450,6 +500,8 @@ nlohmann::json Application::_GetDefaultAppSettings()
 
 	result["window_width"]  = DEFAULT_WINDOW_WIDTH;
 	result["window_height"] = DEFAULT_WINDOW_HEIGHT;
+	result["resource_budget_mb"] = DEFAULT_RESOURCE_BUDGET_MB;
+	result["asset_archives"] = std::vector<std::string>({ DEFAULT_ASSET_ARCHIVE });
 	return result;
 }
 
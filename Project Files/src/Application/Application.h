@@ -5,6 +5,7 @@
 #include "Utils/Macros.h"
 #include "Application/ApplicationLayer.h"
 #include "Gameplay/Scene.h"
+#include "Gameplay/SceneLoader.h"
 
 struct GLFWwindow;
 
@@ -67,10 +68,11 @@ public:
 	void Quit();
 
 	/**
-	 * Loads a new scene into the application using a path on disk
+	 * Starts loading a new scene into the application using a path on disk. The scene is loaded
+	 * in the background over the next few frames, and is switched to once it is ready
 	 * 
 	 * @param path The path to the scene file to load
-	 * @returns True if the file was found and the scene loaded, false if otherwise
+	 * @returns True if the file was found and the scene has started loading, false if otherwise
 	 */
 	bool LoadScene(const std::string& path);
 	/**
@@ -80,6 +82,15 @@ public:
 	 */
 	void LoadScene(const Gameplay::Scene::Sptr& scene);
 
+	/**
+	 * Returns true if a scene is being loaded in the background
+	 */
+	bool IsLoadingScene() const { return _sceneLoader != nullptr; }
+	/**
+	 * Gets how much of the scene that is loading in the background has been loaded, between 0 and 1
+	 */
+	float GetSceneLoadProgress() const { return _sceneLoader != nullptr ? _sceneLoader->GetProgress() : 0.0f; }
+
 	/**
 	 * Gets the currently loaded scene that the application is working from
 	 */
@@ -136,6 +147,8 @@ protected:
 	Gameplay::Scene::Sptr _currentScene;
 	// The scene to switch to at the start of the next frame
 	Gameplay::Scene::Sptr _targetScene;
+	// The scene that is loading in the background, if any
+	Gameplay::SceneLoader::Sptr _sceneLoader;
 
 	// Stores all the layers of the application, in the order they should be invoked
 	std::vector<ApplicationLayer::Sptr> _layers;
@@ -150,6 +163,7 @@ protected:
 	void _PostRender();
 	void _Unload();
 	void _HandleSceneChange();
+	void _UpdateSceneLoad();
 	void _HandleWindowSizeChanged(const glm::ivec2& newSize);
 	void _ConfigureSettings();
 	nlohmann::json _GetDefaultAppSettings();
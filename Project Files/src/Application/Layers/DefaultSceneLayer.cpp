@@ -30,6 +30,7 @@
 #include "Utils/ImGuiHelper.h"
 #include "Utils/ResourceManager/ResourceManager.h"
 #include "Utils/FileHelpers.h"
+#include "Logging.h"
 #include "Utils/JsonGlmHelpers.h"
 #include "Utils/StringUtils.h"
 #include "Utils/GlmDefines.h"
@@ -100,7 +101,7 @@ void DefaultSceneLayer::_CreateScene()
 
 	bool loadScene = false;
 	// For now we can use a toggle to generate our scene vs load from file
-	if (loadScene && std::filesystem::exists("scene.json")) {
+	if (loadScene && FileHelpers::Exists("scene.json")) {
 		app.LoadScene("scene.json");
 	} else {
 		 
@@ -165,13 +166,17 @@ void DefaultSceneLayer::_CreateScene()
 		Texture2D::Sptr    boxTexture   = ResourceManager::CreateAsset<Texture2D>("textures/box-diffuse.png");
 		Texture2D::Sptr    boxSpec      = ResourceManager::CreateAsset<Texture2D>("textures/box-specular.png");
 		Texture2D::Sptr    monkeyTex    = ResourceManager::CreateAsset<Texture2D>("textures/monkey-uvMap.png");
-		Texture2D::Sptr    leafTex      = ResourceManager::CreateAsset<Texture2D>("textures/leaves.png");
+
+		// Textures from the same file are shared, so settings that differ from the defaults go in the description
+		Texture2DDescription leafDescription;
+		leafDescription.Filename = "textures/leaves.png";
+		leafDescription.MinificationFilter = MinFilter::Nearest;
+		leafDescription.MagnificationFilter = MagFilter::Nearest;
+		Texture2D::Sptr    leafTex      = ResourceManager::CreateAsset<Texture2D>(leafDescription);
 
 		Texture2D::Sptr		roadTexture = ResourceManager::CreateAsset<Texture2D>("textures/road.png");
 		Texture2D::Sptr		sidewalkTexture = ResourceManager::CreateAsset<Texture2D>("textures/sidewalk.png");
 		Texture2D::Sptr		brickTexture = ResourceManager::CreateAsset<Texture2D>("textures/brick.png");
-		leafTex->SetMinFilter(MinFilter::Nearest);
-		leafTex->SetMagFilter(MagFilter::Nearest);
 
 		// Load some images for drag n' drop
 		ResourceManager::CreateAsset<Texture2D>("textures/flashlight.png");
@@ -209,8 +214,10 @@ void DefaultSceneLayer::_CreateScene()
 #pragma endregion 
 
 		// Loading in a 1D LUT
-		Texture1D::Sptr toonLut = ResourceManager::CreateAsset<Texture1D>("luts/toon-1D.png"); 
-		toonLut->SetWrap(WrapMode::ClampToEdge);
+		Texture1DDescription toonLutDescription;
+		toonLutDescription.Filename = "luts/toon-1D.png";
+		toonLutDescription.Wrap = WrapMode::ClampToEdge;
+		Texture1D::Sptr toonLut = ResourceManager::CreateAsset<Texture1D>(toonLutDescription);
 
 		// Here we'll load in the cubemap, as well as a special shader to handle drawing the skybox
 		TextureCube::Sptr testCubemap = ResourceManager::CreateAsset<TextureCube>("cubemaps/ocean/ocean.jpg");
@@ -518,9 +525,28 @@ void DefaultSceneLayer::_CreateScene()
 
 			EnemyController::Sptr controller = enemyMonkey->Add<EnemyController>();
 			controller->SetPlayerRef(playerMonkey);
-			controller->SetBulletMesh(monkeyMesh);
-			controller->SetBulletMaterial(customMaterial);
 		}
+
+		// Bullets are re-used instead of being created for every shot. The pool is shared by all the enemies,
+		// so it's registered here once rather than by each enemy
+		scene->RegisterObjectPool("Bullet", [monkeyMesh, customMaterial](const GameObject::Sptr& bullet) {
+			bullet->SetScale({ 0.5f, 0.5f, 0.5f });
+
+			// Create and attach a renderer for the monkey
+			RenderComponent::Sptr renderer = bullet->Add<RenderComponent>();
+			renderer->SetMesh(monkeyMesh);
+			renderer->SetMaterial(customMaterial);
+
+			// Projectile!
+			bullet->Add<Projectile>();
+
+			TriggerVolume::Sptr volume = bullet->Add<TriggerVolume>();
+			BoxCollider::Sptr collider = BoxCollider::Create(glm::vec3(0.5f, 0.5f, 0.5f));
+			collider->SetPosition(glm::vec3(0.0f, 0.0f, 0.0f));
+			volume->AddCollider(collider);
+
+			bullet->Add<TriggerVolumeEnterBehaviour>();
+		});
 		
 
 		GameObject::Sptr shadowCaster1 = scene->CreateGameObject("Shadow Light");
@@ -640,6 +666,9 @@ void DefaultSceneLayer::_CreateScene()
 		GuiBatcher::SetDefaultTexture(ResourceManager::CreateAsset<Texture2D>("textures/ui-sprite.png"));
 		GuiBatcher::SetDefaultBorderRadius(8);
 
+		ResourceManager::MemoryStats stats = ResourceManager::GetMemoryStats();
+		LOG_INFO("Shared {} resources that were loaded from the same file more than once, saving {:.1f}MB", stats.NumDeduplicated, stats.DeduplicatedBytes / (1024.0 * 1024.0));
+
 		// Save the asset manifest for all the resources we just loaded
 		ResourceManager::SaveManifest("scene-manifest.json");
 		// Save the scene to a JSON file
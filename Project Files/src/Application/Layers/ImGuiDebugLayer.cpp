@@ -3,6 +3,9 @@
 #include "Utils/ImGuiHelper.h"
 #include "imgui_internal.h"
 #include "Gameplay/Scene.h"
+#include "Gameplay/SceneDelta.h"
+#include "Utils/JsonGlmHelpers.h"
+#include "Utils/FileHelpers.h"
 #include "../Timing.h"
 #include "Utils/Windows/FileDialogs.h"
 #include <filesystem>
@@ -20,10 +23,17 @@
 
 ImGuiDebugLayer::ImGuiDebugLayer() :
 	ApplicationLayer(),
-	_dockInvalid(true)
+	_dockInvalid(true),
+	_autosaveInterval(0.0f),
+	_autosaveCompactAfter(0),
+	_autosaveScene(),
+	_autosavePath(""),
+	_autosaveTimer(0.0f),
+	_hasAutosaveBase(false),
+	_numAutosaveDeltas(0)
 {
 	Name = "ImGui Debug Layer";
-	Overrides = AppLayerFunctions::OnAppLoad | AppLayerFunctions::OnAppUnload | AppLayerFunctions::OnPreRender | AppLayerFunctions::OnRender | AppLayerFunctions::OnPostRender;
+	Overrides = AppLayerFunctions::OnAppLoad | AppLayerFunctions::OnAppUnload | AppLayerFunctions::OnUpdate | AppLayerFunctions::OnPreRender | AppLayerFunctions::OnRender | AppLayerFunctions::OnPostRender;
 }
 
 ImGuiDebugLayer::~ImGuiDebugLayer() = default;
@@ -40,6 +50,11 @@ void ImGuiDebugLayer::OnAppLoad(const nlohmann::json& config)
 	RegisterWindow<DebugWindow>();
 	RegisterWindow<GBufferPreviews>();
 	RegisterWindow<PostProcessingSettingsWindow>();
+
+	if (config.contains(Name)) {
+		_autosaveInterval     = JsonGet(config[Name], "autosave_interval", _autosaveInterval);
+		_autosaveCompactAfter = JsonGet(config[Name], "autosave_compact_after", _autosaveCompactAfter);
+	}
 }
 
 void ImGuiDebugLayer::OnAppUnload()
@@ -47,6 +62,37 @@ void ImGuiDebugLayer::OnAppUnload()
 
 }
 
+void ImGuiDebugLayer::OnUpdate()
+{
+	using namespace Gameplay;
+	Application& app = Application::Get();
+	Scene::Sptr scene = app.CurrentScene();
+
+	if (_autosaveInterval <= 0.0f || scene == nullptr || app.IsLoadingScene()) {
+		return;
+	}
+
+	// Start a fresh autosave whenever the scene changes, only scenes that have a file can be autosaved
+	if (_autosaveScene.lock() != scene) {
+		_autosaveScene = scene;
+		_autosavePath  = scene->GetFilePath().empty() ? "" : _GetAutosavePath(scene->GetFilePath());
+		_autosaveTimer = 0.0f;
+		_hasAutosaveBase = false;
+		_numAutosaveDeltas = 0;
+	}
+
+	// Changes made while playing are thrown away when we stop, so there's nothing to save
+	if (_autosavePath.empty() || scene->IsPlaying) {
+		return;
+	}
+
+	_autosaveTimer += Timing::Current().UnscaledDeltaTime();
+	if (_autosaveTimer >= _autosaveInterval) {
+		_autosaveTimer = 0.0f;
+		_Autosave();
+	}
+}
+
 void ImGuiDebugLayer::OnPreRender()
 {
 
@@ -165,7 +211,7 @@ void ImGuiDebugLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 
 				// Load scene item
 				if (ImGui::MenuItem("Load Scene", NULL, false)) {
-					std::optional<std::string> path = FileDialogs::OpenFile("Scene File\0*.json\0\0");
+					std::optional<std::string> path = FileDialogs::OpenFile("Scene File\0*.json;*.bscene\0\0");
 					if (path.has_value()) {
 						app.LoadScene(path.value());
 					}
@@ -173,12 +219,49 @@ void ImGuiDebugLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 
 				// Save scene item
 				if (ImGui::MenuItem("Save Scene", NULL, false)) {
-					std::optional<std::string> path = FileDialogs::SaveFile("Scene File\0*.json\0\0");
+					std::optional<std::string> path = FileDialogs::SaveFile("JSON Scene\0*.json\0Binary Scene\0*.bscene\0\0");
 					if (path.has_value()) {
 						app.CurrentScene()->Save(path.value());
 
 						std::string newFilename = std::filesystem::path(path.value()).stem().string() + "-manifest.json";
 						ResourceManager::SaveManifest(newFilename);
+
+						// The scene file is up to date now, so the next autosave starts over
+						_autosaveScene.reset();
+					}
+				}
+
+				// Loads the autosave for the current scene, along with any deltas saved since then
+				std::string scenePath = app.CurrentScene()->GetFilePath();
+				std::string autosavePath = scenePath.empty() ? "" : _GetAutosavePath(scenePath);
+				if (ImGui::MenuItem("Recover Autosave", NULL, false, !autosavePath.empty() && std::filesystem::exists(autosavePath))) {
+					nlohmann::json blob = SceneDelta::LoadChain(autosavePath);
+					Scene::Sptr recovered = nullptr;
+					if (!blob.is_null()) {
+						try {
+							recovered = Scene::FromJson(blob);
+						}
+						catch (const std::exception& e) {
+							LOG_ERROR("Failed to recover autosave \"{}\": {}", autosavePath, e.what());
+						}
+					}
+					if (recovered != nullptr) {
+						// The recovered scene still belongs to the scene file (so it keeps autosaving), but
+						// none of the recovered edits have been saved to it
+						recovered->SetFilePath(scenePath);
+						recovered->MarkAllChanged(Scene::Checkpoint::Save);
+						app.LoadScene(recovered);
+					}
+				}
+
+				// Converts scenes between the JSON and binary formats, handy for diffing binary scenes
+				if (ImGui::MenuItem("Convert Scene", NULL, false)) {
+					std::optional<std::string> input = FileDialogs::OpenFile("Scene File\0*.json;*.bscene\0\0");
+					if (input.has_value()) {
+						std::optional<std::string> output = FileDialogs::SaveFile("JSON Scene\0*.json\0Binary Scene\0*.bscene\0\0");
+						if (output.has_value()) {
+							Gameplay::SceneBinary::ConvertFile(input.value(), output.value());
+						}
 					}
 				}
 
@@ -262,6 +345,57 @@ void ImGuiDebugLayer::OnPostRender()
 	DebugDrawer::Get().FlushAll();
 }
 
+nlohmann::json ImGuiDebugLayer::GetDefaultConfig()
+{
+	nlohmann::json result = nlohmann::json::object();
+	result["autosave_interval"] = 60.0f;
+	result["autosave_compact_after"] = 10;
+	return result;
+}
+
+void ImGuiDebugLayer::_Autosave()
+{
+	using namespace Gameplay;
+	Scene::Sptr scene = _autosaveScene.lock();
+	if (scene == nullptr || _autosavePath.empty() || !scene->HasUnsavedChanges(Scene::Checkpoint::Autosave)) {
+		return;
+	}
+
+	// The first autosave has to be a full save, since the scene file may be in a different format or
+	// out of date with the checkpoint
+	if (!_hasAutosaveBase) {
+		// Deltas left over from an earlier session would be applied on top of the new autosave
+		for (uint32_t ix = 1; std::filesystem::exists(SceneDelta::GetDeltaPath(_autosavePath, ix)); ix++) {
+			std::filesystem::remove(SceneDelta::GetDeltaPath(_autosavePath, ix));
+		}
+
+		FileHelpers::WriteContentsToFile(_autosavePath, scene->ToJson().dump(1, '\t'));
+		// Autosaves have their own checkpoint, so that they don't hide changes that haven't been saved
+		scene->MarkCheckpoint(Scene::Checkpoint::Autosave);
+		_hasAutosaveBase = true;
+		_numAutosaveDeltas = 0;
+		LOG_INFO("Autosaved scene to \"{}\"", _autosavePath);
+		return;
+	}
+
+	_numAutosaveDeltas++;
+	scene->SaveDelta(SceneDelta::GetDeltaPath(_autosavePath, _numAutosaveDeltas), Scene::Checkpoint::Autosave);
+
+	// Keep the chain short, so that recovering doesn't have to replay too many deltas
+	if (_autosaveCompactAfter > 0 && _numAutosaveDeltas >= _autosaveCompactAfter) {
+		if (SceneDelta::CompactFiles(_autosavePath)) {
+			_numAutosaveDeltas = 0;
+		}
+	}
+}
+
+std::string ImGuiDebugLayer::_GetAutosavePath(const std::string& scenePath)
+{
+	std::filesystem::path path = scenePath;
+	path.replace_filename(path.stem().string() + ".autosave.json");
+	return path.string();
+}
+
 void ImGuiDebugLayer::_RenderGameWindow()
 {
 	using namespace Gameplay;
@@ -300,9 +434,9 @@ void ImGuiDebugLayer::_RenderGameWindow()
 
 	// Draw the play/stop button
 	if (ImGui::Button(buffer)) {
-		// Save scene so it can be restored when exiting play mode
+		// Snapshot the scene so it can be restored when exiting play mode
 		if (!scene->IsPlaying) {
-			_backupState = scene->ToJson();
+			_backupState = scene->TakeSnapshot();
 		}
 
 		// Toggle state
@@ -310,10 +444,11 @@ void ImGuiDebugLayer::_RenderGameWindow()
 
 		// If we've gone from playing to not playing, restore the state from before we started playing
 		if (!scene->IsPlaying) {
-			scene = nullptr;
-			// We reload to scene from our cached state
-			scene = Scene::FromJson(_backupState);
-			app.LoadScene(scene);
+			// Put the scene back the way it was in place, rather than re-loading it
+			if (!scene->RestoreSnapshot(_backupState)) {
+				LOG_ERROR("Failed to restore the scene after playing");
+			}
+			_backupState = Scene::Snapshot();
 		}
 	}
 
@@ -332,6 +467,12 @@ void ImGuiDebugLayer::_RenderGameWindow()
 
 	ImGui::Text("FPS: %.*0f", 3, 1.0f / Timing::Current().DeltaTime());
 
+	// Show how far along any scene that is loading in the background is
+	if (app.IsLoadingScene()) {
+		ImGui::SameLine();
+		ImGui::ProgressBar(app.GetSceneLoadProgress(), ImVec2(200.0f, 0.0f), "Loading Scene...");
+	}
+
 	// Determine the relative position of the window
 	ImVec2 subPos = ImGui::GetWindowPos();
 	ImVec2 cursorPos = ImGui::GetCursorPos();
@@ -3,6 +3,7 @@
 #include "Gameplay/Physics/BulletDebugDraw.h"
 #include "../IEditorWindow.h"
 #include "Logging.h"
+#include "Gameplay/Scene.h"
 
 /**
  * The ImGui Debug Layer allows us to handle editor and debug windows using ImGUI
@@ -43,15 +44,38 @@ public:
 
 	virtual void OnAppLoad(const nlohmann::json& config) override;
 	virtual void OnAppUnload() override;
+	virtual void OnUpdate() override;
 	virtual void OnPreRender() override;
 	virtual void OnRender(const Framebuffer::Sptr& prevLayer) override;
 	virtual void OnPostRender() override;
+	virtual nlohmann::json GetDefaultConfig() override;
 
 protected:
 	std::vector<IEditorWindow::Sptr> _windows;
-	nlohmann::json _backupState;
+	// The state of the scene from before we started playing
+	Gameplay::Scene::Snapshot _backupState;
 	bool           _dockInvalid;
 
+	// Autosave settings, an interval of 0 turns autosaving off
+	float    _autosaveInterval;
+	uint32_t _autosaveCompactAfter;
+	// The scene that we are autosaving, when the current scene changes we start a new autosave
+	std::weak_ptr<Gameplay::Scene> _autosaveScene;
+	std::string _autosavePath;
+	float       _autosaveTimer;
+	// Set once we've written the full scene to the autosave, after that we only write deltas
+	bool        _hasAutosaveBase;
+	uint32_t    _numAutosaveDeltas;
+
 	void _RenderGameWindow();
+	/// <summary>
+	/// Saves the changes to the current scene since the last autosave. The first autosave of a scene
+	/// writes the full scene, and after that only deltas are written until there are enough to compact
+	/// </summary>
+	void _Autosave();
+	/// <summary>
+	/// Gets the path that the autosave for a scene file is stored at
+	/// </summary>
+	static std::string _GetAutosavePath(const std::string& scenePath);
 	ImGuiID& _FindOpenParentWindow(const IEditorWindow::Sptr& window, ImGuiID& mainID, ImGuiDir* direction, float* dist);
 };
\ No newline at end of file
@@ -22,7 +22,7 @@ void ParticleLayer::OnUpdate()
 	// Only update the particle systems when the game is playing, so we can edit them in
 	// the inspector
 	if (app.CurrentScene()->IsPlaying) {
-		app.CurrentScene()->Components().Each<ParticleSystem>([](const ParticleSystem::Sptr& system) {
+		app.CurrentScene()->Components().Each<ParticleSystem>([](ParticleSystem* system) {
 			if (system->IsEnabled) {
 				system->Update();
 			}
@@ -41,7 +41,7 @@ void ParticleLayer::OnPostRender()
 	renderOutput->Bind();
 	glViewport(0, 0, renderOutput->GetWidth(), renderOutput->GetHeight());
 
-	Application::Get().CurrentScene()->Components().Each<ParticleSystem>([](const ParticleSystem::Sptr& system) {
+	Application::Get().CurrentScene()->Components().Each<ParticleSystem>([](ParticleSystem* system) {
 		if (system->IsEnabled) {
 			system->Render(); 
 		}
@@ -193,7 +193,7 @@ void RenderLayer::_AccumulateLighting()
 	// Send in how many active lights we have and the global lighting settings
 	data.AmbientCol = glm::vec3(0.1f);
 	int ix = 0;
-	app.CurrentScene()->Components().Each<Light>([&](const Light::Sptr& light) {
+	app.CurrentScene()->Components().Each<Light>([&](Light* light) {
 		// Get the light's position in view space, since we're doing view space lighting
 		glm::vec4 pos = glm::vec4(light->GetGameObject()->GetWorldPosition(), 1.0f);
 		pos = view * pos;
@@ -232,7 +232,7 @@ void RenderLayer::_AccumulateLighting()
 	}
 
 	// Re-render the scene for shadows
-	app.CurrentScene()->Components().Each<ShadowCamera>([&](const ShadowCamera::Sptr& shadowCam) {
+	app.CurrentScene()->Components().Each<ShadowCamera>([&](ShadowCamera* shadowCam) {
 		// Bind the shadow camera's depth buffer and clear it
 		shadowCam->GetDepthBuffer()->Bind();
 		glClear(GL_DEPTH_BUFFER_BIT);
@@ -260,7 +260,7 @@ void RenderLayer::_AccumulateLighting()
 	_shadowShader->Bind();
 
 	// Add each shadow casting light to the lighting buffers
-	app.CurrentScene()->Components().Each<ShadowCamera>([&](const ShadowCamera::Sptr& shadowCam) {
+	app.CurrentScene()->Components().Each<ShadowCamera>([&](ShadowCamera* shadowCam) {
 
 		// This gets us the light -> view space matrix, which we'll inverse to go from view space to light space
 		glm::mat4 lightSpaceMatrix = camera->GetView() * shadowCam->GetGameObject()->GetTransform();
@@ -567,7 +567,7 @@ void RenderLayer::_RenderScene(const glm::mat4& view, const glm::mat4& projectio
 	_frameUniforms->Update();
 
 	// Render all our objects
-	app.CurrentScene()->Components().Each<RenderComponent>([&](const RenderComponent::Sptr& renderable) {
+	app.CurrentScene()->Components().Each<RenderComponent>([&](RenderComponent* renderable) {
 		// Early bail if mesh not set
 		if (renderable->GetMesh() == nullptr) {
 			return;
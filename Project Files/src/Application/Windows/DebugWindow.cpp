@@ -2,6 +2,14 @@
 #include "Application/Application.h"
 #include "Application/ApplicationLayer.h"
 #include "Application/Layers/RenderLayer.h"
+#include "Gameplay/Prefab.h"
+#include "Utils/ResourceManager/ResourceManager.h"
+#include "Utils/PakArchive.h"
+#include "Utils/ObjParser.h"
+#include "Utils/FileHelpers.h"
+#include "Gameplay/Components/RotatingBehaviour.h"
+#include <GLFW/glfw3.h>
+#include <filesystem>
 
 DebugWindow::DebugWindow() :
 	IEditorWindow()
@@ -24,6 +32,41 @@ void DebugWindow::RenderMenuBar()
 		app.CurrentScene()->SetPhysicsDebugDrawMode(physicsDrawMode);
 	}
 
+	ImGui::Separator();
+
+	if (ImGui::BeginMenu("Resources")) {
+		const double megabyte = 1024.0 * 1024.0;
+		ResourceManager::MemoryStats stats = ResourceManager::GetMemoryStats();
+		ImGui::Text("Resident: %zu (%.1fMB GPU, %.1fMB CPU)", stats.NumResident, stats.GpuBytes / megabyte, stats.CpuBytes / megabyte);
+		if (stats.Budget > 0) {
+			ImGui::Text("Budget: %.1fMB", stats.Budget / megabyte);
+		} else {
+			ImGui::Text("Budget: None");
+		}
+		ImGui::Text("Evicted: %zu (%.1fMB)", stats.NumEvicted, stats.EvictedBytes / megabyte);
+		ImGui::Text("Duplicates Shared: %zu (%.1fMB)", stats.NumDeduplicated, stats.DeduplicatedBytes / megabyte);
+		ImGui::Text("Loading: %zu", ResourceManager::NumPendingLoads());
+		ImGui::Text("Mounted Archives: %zu", PakArchive::NumMounted());
+		ImGui::Separator();
+		// Packs everything in the working directory, so that the next run loads from the archive
+		if (ImGui::MenuItem("Build Asset Archive")) {
+			// The old archive is still mapped if it's mounted, which would stop us from replacing it
+			PakArchive::UnmountAll();
+			if (PakArchive::Build(".", "assets.pak")) {
+				PakArchive::Mount("assets.pak");
+			}
+		}
+		ImGui::EndMenu();
+	}
+
+	if (ImGui::MenuItem("Benchmark Prefabs")) {
+		_BenchmarkPrefab();
+	}
+
+	if (ImGui::MenuItem("Benchmark OBJ Parser")) {
+		_BenchmarkObjParser();
+	}
+
 	/*ImGui::Separator();
 
 	RenderFlags flags = renderLayer->GetRenderFlags();
@@ -38,3 +81,89 @@ void DebugWindow::RenderMenuBar()
 		renderLayer->SetRenderFlags(flags);
 	}*/
 }
+
+void DebugWindow::_BenchmarkPrefab()
+{
+	using namespace Gameplay;
+	// Thousands of objects come and go, so we work in a scratch scene rather than touching the one being edited
+	Scene::Sptr scene = std::make_shared<Scene>();
+
+	// A root with 7 children, that each have 6 children of their own, for 50 objects in total
+	GameObject::Sptr root = scene->CreateGameObject("Prefab Benchmark");
+	root->Add<RotatingBehaviour>();
+	for (int ix = 0; ix < 7; ix++) {
+		GameObject::Sptr child = scene->CreateGameObject("Branch");
+		child->Add<RotatingBehaviour>();
+		root->AddChild(child);
+		for (int jx = 0; jx < 6; jx++) {
+			GameObject::Sptr leaf = scene->CreateGameObject("Leaf");
+			leaf->Add<RotatingBehaviour>();
+			child->AddChild(leaf);
+		}
+	}
+	Prefab::Sptr prefab = Prefab::Create(root);
+	scene->RemoveGameObject(root);
+
+	const int instanceCount = 100;
+	std::vector<GameObject::Sptr> instances;
+	instances.reserve(instanceCount);
+
+	double startTime = glfwGetTime();
+	for (int ix = 0; ix < instanceCount; ix++) {
+		instances.push_back(prefab->Instantiate(scene.get()));
+	}
+	double elapsed = glfwGetTime() - startTime;
+
+	size_t objectCount = instanceCount * prefab->NumObjects();
+	LOG_INFO("Instantiated {} copies of a {} object prefab in {:.2f}ms ({:.1f}us per copy, {:.0f} objects per second)",
+		instanceCount, prefab->NumObjects(), elapsed * 1000.0, elapsed * 1000000.0 / instanceCount, objectCount / elapsed);
+
+	// The instances have to go before the scene they live in
+	instances.clear();
+}
+
+void DebugWindow::_BenchmarkObjParser()
+{
+	const double megabyte = 1024.0 * 1024.0;
+	double totalBytes = 0.0;
+	double totalStream = 0.0;
+	double totalParallel = 0.0;
+
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(".")) {
+		if (!entry.is_regular_file() || entry.path().extension() != ".obj") {
+			continue;
+		}
+
+		// Open once up front, so both parsers read from memory and we're only timing the parsing
+		std::string path = entry.path().string();
+		FileData::Sptr file = FileHelpers::OpenFile(path);
+		if (file == nullptr) {
+			continue;
+		}
+
+		double startTime = glfwGetTime();
+		FileInputStream stream(file);
+		ObjData reference = ObjParser::ParseStream(stream);
+		double streamTime = glfwGetTime() - startTime;
+
+		startTime = glfwGetTime();
+		ObjData result = ObjParser::Parse(file);
+		double parallelTime = glfwGetTime() - startTime;
+
+		double size = file->Size() / megabyte;
+		LOG_INFO("{}: {:.2f}MB, stream {:.2f}ms ({:.1f}MB/s), parallel {:.2f}ms ({:.1f}MB/s), {}",
+			path, size, streamTime * 1000.0, size / streamTime, parallelTime * 1000.0, size / parallelTime,
+			result == reference ? "results match" : "results differ");
+
+		totalBytes += size;
+		totalStream += streamTime;
+		totalParallel += parallelTime;
+	}
+
+	if (totalBytes > 0.0) {
+		LOG_INFO("Parsed {:.2f}MB of OBJ files, stream {:.1f}MB/s, parallel {:.1f}MB/s ({:.1f}x faster)",
+			totalBytes, totalBytes / totalStream, totalBytes / totalParallel, totalStream / totalParallel);
+	} else {
+		LOG_WARN("No OBJ files found to benchmark");
+	}
+}
@@ -15,4 +15,13 @@ public:
 	virtual void RenderMenuBar() override;
 
 protected:
+	/// <summary>
+	/// Times instantiating a 50 object prefab in a scratch scene, and logs the results
+	/// </summary>
+	void _BenchmarkPrefab();
+	/// <summary>
+	/// Parses every OBJ file in the working directory with both the parallel and the stream based OBJ
+	/// parser, and logs how long each one took and whether their results match
+	/// </summary>
+	void _BenchmarkObjParser();
 };
\ No newline at end of file
@@ -37,7 +37,9 @@ void InspectorWindow::Render()
 		ImGui::Separator();
 
 		// Render position label
-		selection->_isLocalTransformDirty |= LABEL_LEFT(ImGui::DragFloat3, "Position", &selection->_position.x, 0.01f);
+		if (LABEL_LEFT(ImGui::DragFloat3, "Position", &selection->_position.x, 0.01f)) {
+			selection->_MarkTransformDirty();
+		}
 
 		// Get the ImGui storage state so we can avoid gimbal locking issues by storing euler angles in the editor
 		glm::vec3 euler = selection->GetRotationEuler();
@@ -63,11 +65,9 @@ void InspectorWindow::Render()
 		}
 
 		// Draw the scale
-		selection->_isLocalTransformDirty |= LABEL_LEFT(ImGui::DragFloat3, "Scale   ", &selection->_scale.x, 0.01f, 0.0f);
-
-		// For if we're not in play mode
-		selection->_RecalcLocalTransform(); 
-		selection->_RecalcWorldTransform();
+		if (LABEL_LEFT(ImGui::DragFloat3, "Scale   ", &selection->_scale.x, 0.01f, 0.0f)) {
+			selection->_MarkTransformDirty();
+		}
 
 		ImGui::Separator();
 
@@ -76,7 +76,7 @@ void InspectorWindow::Render()
 			std::shared_ptr<Gameplay::IComponent> component = selection->_components[ix];
 
 			if (_RenderComponent(component)) {
-				selection->_components.erase(selection->_components.begin() + ix);
+				selection->_RemoveComponentAt(ix);
 				ix--;
 			}
 		}
@@ -119,7 +119,9 @@ bool InspectorWindow::_RenderComponent(Gameplay::IComponent::Sptr component)
 
 	ImGuiID id = ImGui::GetID(component->ComponentTypeName().c_str());
 	bool isOpen = ImGui::CollapsingHeader(component->ComponentTypeName().c_str(), ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_AllowItemOverlap | ImGuiTreeNodeFlags_ClipLabelForTrailingButton);
-	ImGuiHelper::HeaderCheckbox(id, &component->IsEnabled);
+	if (ImGuiHelper::HeaderCheckbox(id, &component->IsEnabled)) {
+		component->MarkChanged();
+	}
 	
 	if (ImGui::BeginPopupContextItem()) {
 		if (ImGui::MenuItem("Copy Values")) {
@@ -161,7 +163,9 @@ bool InspectorWindow::_RenderComponent(Gameplay::IComponent::Sptr component)
 	if (isOpen) {
 
 		ImGui::Indent();
-		component->RenderImGui();
+		if (ImGuiHelper::DrawAndCheckEdited([&]() { component->RenderImGui(); })) {
+			component->MarkChanged();
+		}
 		ImGui::Unindent();
 	}
 
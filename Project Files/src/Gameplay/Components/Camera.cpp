@@ -77,11 +77,13 @@ namespace Gameplay {
 
 	void Camera::SetOrthoEnabled(bool value)
 	{
+		MarkChanged();
 		_isOrtho = true;
 		_isProjectionDirty = true;
 	}
 
 	void Camera::SetFovRadians(float value) {
+		MarkChanged();
 		_fovRadians = value;
 		_isProjectionDirty = true;
 	}
@@ -92,11 +94,12 @@ namespace Gameplay {
 	}
 
 	void Camera::SetOrthoVerticalScale(float value) {
+		MarkChanged();
 		_orthoVerticalScale = value;
 		_isProjectionDirty = true;
 	}
 
-	const glm::mat4& Camera::GetView() const {
+	glm::mat4 Camera::GetView() const {
 		return GetGameObject()->GetInverseTransform();
 	}
 
@@ -116,6 +119,7 @@ namespace Gameplay {
 	}
 
 	void Camera::SetClearColor(const glm::vec4& color) {
+		MarkChanged();
 		_clearColor = color;
 	}
 
@@ -131,12 +135,14 @@ namespace Gameplay {
 
 	void Camera::SetNearPlane(float value)
 	{
+		MarkChanged();
 		_nearPlane = value;
 		__CalculateProjection();
 	}
 
 	void Camera::SetFarPlane(float value)
 	{
+		MarkChanged();
 		_farPlane = value;
 		__CalculateProjection();
 	}
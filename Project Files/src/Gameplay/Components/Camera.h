@@ -12,6 +12,8 @@ namespace Gameplay {
 	{
 	public:
 		typedef std::shared_ptr<Camera> Sptr;
+		// Everything we hold is saved (or re-calculated), so we can be kept when restoring a snapshot
+		static constexpr bool RestoreInPlace = true;
 
 		inline static Sptr Create() {
 			return std::make_shared<Camera>();
@@ -75,7 +77,7 @@ namespace Gameplay {
 		/// <summary>
 		/// Gets the view matrix for this camera
 		/// </summary>
-		const glm::mat4& GetView() const;
+		glm::mat4 GetView() const;
 		/// <summary>
 		/// Gets the projection matrix for this camera
 		/// </summary>
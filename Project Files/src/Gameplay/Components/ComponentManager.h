@@ -3,6 +3,7 @@
 #include "IComponent.h"
 #include <typeindex>
 #include <optional>
+#include <algorithm>
 #include <Logging.h>
 
 namespace Gameplay {
@@ -16,8 +17,15 @@ namespace Gameplay {
 		typedef std::function<IComponent::Sptr(const nlohmann::json&)> LoadComponentFunc;
 		typedef std::function<IComponent::Sptr()> CreateComponentFunc;
 
+		// Game objects track which components they have with a 64 bit mask, so we can't register more types than this
+		static constexpr uint32_t MaxComponentTypes = 64;
+		// The type ID for types that have not been registered
+		static constexpr uint32_t InvalidTypeId = UINT32_MAX;
+
 		inline void Clear() {
 			_Components.clear();
+			_ComponentsByGuid.clear();
+			_poolsToCompact.clear();
 		}
 
 		/// <summary>
@@ -46,13 +54,48 @@ namespace Gameplay {
 					result->_weakSelfPtr = result;
 
 					// Add the component to the global pools
-					_Components[result->_realType].push_back(result);
+					_AddToPool(result.get());
 					return result;
 				}
 			}
 			return nullptr;
 		}
 
+		/// <summary>
+		/// Loads a component of an already resolved type (see FindType) from a JSON blob, giving it a new
+		/// GUID instead of the one stored in the blob. Used to make copies of components, ex: by prefabs
+		/// </summary>
+		/// <param name="type">The registered type of the component to load</param>
+		/// <param name="blob">The JSON blob to decode</param>
+		/// <param name="guid">The GUID for the new component</param>
+		/// <returns>The component as decoded from the JSON data, or nullptr if the type is not registered</returns>
+		inline IComponent::Sptr Instantiate(const std::type_index& type, const nlohmann::json& blob, const Guid& guid) {
+			auto it = _TypeLoadRegistry.find(type);
+			if (it == _TypeLoadRegistry.end() || !it->second) {
+				return nullptr;
+			}
+
+			IComponent::Sptr result = it->second(blob);
+			IComponent::LoadBaseJson(result, blob);
+			// Before adding to the pools, so that we're never registered under the original's GUID
+			result->OverrideGUID(guid);
+
+			result->_realType = type;
+			result->_weakSelfPtr = result;
+
+			_AddToPool(result.get());
+			return result;
+		}
+
+		/// <summary>
+		/// Gets the registered type with the given type name, or an empty value if the type is not registered
+		/// </summary>
+		/// <param name="typeName">The name of the type (taken from GetComponentTypeName of component)</param>
+		static std::optional<std::type_index> FindType(const std::string& typeName) {
+			auto it = _TypeNameMap.find(typeName);
+			return it != _TypeNameMap.end() ? it->second : std::nullopt;
+		}
+
 		/// <summary>
 		/// Creates a component with the given type name
 		/// If the type name does not correspond to a registered type, will
@@ -75,7 +118,7 @@ namespace Gameplay {
 					result->_realType = typeIndex.value();
 					result->_weakSelfPtr = result;
 					// Add the component to the global pools
-					_Components[result->_realType].push_back(result);
+					_AddToPool(result.get());
 					return result;
 				}
 			}
@@ -93,19 +136,12 @@ namespace Gameplay {
 			// Try and get the type index from the name
 			LOG_ASSERT(_TypeLoadRegistry[type] != nullptr, "You must register component types before creating them!");
 
-			// Get the load callback and make sure it exists
-			CreateComponentFunc callback = _TypeCreateRegistry[type];
-			if (callback) {
-				// Invoke the loader, also load additional component data
-				IComponent::Sptr result = callback();
-				// Make sure the component knows it's own type
-				result->_realType = type;
-				result->_weakSelfPtr = result;
+			IComponent::Sptr result = _CreateDetached(type);
+			if (result) {
 				// Add the component to the global pools
-				_Components[result->_realType].push_back(result);
-				return result;
+				_AddToPool(result.get());
 			}
-			return nullptr;
+			return result;
 		}
 
 		/// <summary>
@@ -132,19 +168,10 @@ namespace Gameplay {
 			typename ... TArgs, 
 			typename = typename std::enable_if<std::is_base_of<IComponent, ComponentType>::value>::type>
 		std::shared_ptr<ComponentType> Create(TArgs&& ... args) {
-			std::type_index type = std::type_index(typeid(ComponentType));
-			LOG_ASSERT(_TypeLoadRegistry[type] != nullptr, "You must register component types before creating them!");
-
-			// Create component, forwarding arguments
-			std::shared_ptr<ComponentType> component = std::make_shared<ComponentType>(std::forward<TArgs>(args)...);
-
-			// Make sure the component knows it's concrete type
-			component->_realType = type;
-			// Give the component a weak pointer to itself that it can upcast to a shared pointer when needed
-			component->_weakSelfPtr = component;
+			std::shared_ptr<ComponentType> component = _CreateDetached<ComponentType>(std::forward<TArgs>(args)...);
 
 			// Add to global component list for that type
-			_Components[type].push_back(component);
+			_AddToPool(component.get());
 
 			// Return the result
 			return component;
@@ -152,7 +179,7 @@ namespace Gameplay {
 
 		/// <summary>
 		/// Searches for a component with the given GUID, allowing components to cross reference each other
-		/// and survive scene serialization
+		/// and survive scene serialization. This is a hash lookup, and does not modify the pools
 		/// </summary>
 		/// <typeparam name="ComponentType">The type of component to get</typeparam>
 		/// <param name="id">The unique ID of the component to get</param>
@@ -165,50 +192,133 @@ namespace Gameplay {
 			std::type_index type = std::type_index(typeid(ComponentType));
 			LOG_ASSERT(_TypeLoadRegistry[type] != nullptr, "You must register component types before creating them!");
 
-			// Clear any dead weak pointers
-			auto removeIt = std::remove_if(_Components[type].begin(), _Components[type].end(), [](const std::weak_ptr<IComponent>& ptr) {
-				return ptr.expired();
-			});
-			_Components[type].erase(removeIt, _Components[type].end());
-
-			// Search the component store for a component that matches that ID
-			auto& it = std::find_if(_Components[type].begin(), _Components[type].end(), [&](const std::weak_ptr<IComponent>& ptr) {
-				return (ptr.lock())->GetGUID() == id;
-			});
-
-			// If the component was found, return it. Otherwise return nullptr
-			if (it != _Components[type].end()) {
-				// We need to lock the weak pointer to convert it to a shared ptr
-				return std::dynamic_pointer_cast<ComponentType>((*it).lock());
-			} else {
-				return nullptr;
+			// Look up the component, and make sure it's actually the type that was requested
+			auto it = _ComponentsByGuid.find(id);
+			if (it != _ComponentsByGuid.end() && it->second->_realType == type) {
+				// We know the concrete type matches, so a static cast is safe
+				return std::static_pointer_cast<ComponentType>(it->second->_weakSelfPtr.lock());
 			}
+			return nullptr;
 		}
 
 		/// <summary>
 		/// Iterates over all components of the given type and invokes a method with them
+		/// 
+		/// Components are stored densely per type, so this is a flat loop over raw pointers with
+		/// no weak pointer locking or dynamic casts. The callback should not hold on to the pointer
+		/// past the end of the call, use SelfRef() if a strong reference is needed
+		///
+		/// Components that are removed while any Each is running leave a hole in their pool instead
+		/// of having the last component swapped in, so nothing is skipped or visited twice. The pools
+		/// are compacted once the outermost Each returns
 		/// </summary>
 		/// <typeparam name="ComponentType">The type of component to iterate on</typeparam>
-		/// <param name="callback">The callback to invoke with the components</param>
-		/// <param name="includeDisabled">True to include disabled components, false if otherwise</param>
+		/// <param name="callback">The callback to invoke with the components, will receive a ComponentType*</param>
+		/// <param name="includeDisabled">True to include disabled components and components on inactive game objects, false if otherwise</param>
 		template <
 			typename ComponentType,
+			typename Func,
 			typename = typename std::enable_if<std::is_base_of<IComponent, ComponentType>::value>::type>
-		void Each(std::function<void(const std::shared_ptr<ComponentType>&)> callback, bool includeDisabled = false) {
+		void Each(Func&& callback, bool includeDisabled = false) {
 			// We can use typeid and type_index to get a unique ID for our types
 			std::type_index type = std::type_index(typeid(ComponentType));
 			LOG_ASSERT(_TypeLoadRegistry[type] != nullptr, "You must register component types before creating them!");
 
-			// Iterate over all the components in the store
-			for (auto& wptr : _Components[type]) {
-				// Lock the weak pointer to get a shared pointer (maybe)
-				std::shared_ptr<IComponent> sptr = wptr.lock();
-				// If the pointer is alive and matches our enabled criteria, invoke the callback
-				if (sptr && sptr->IsEnabled | includeDisabled) {
-					// Upcast to component type and invoke the callback
-					callback(std::dynamic_pointer_cast<ComponentType>(sptr));
+			// Grab the pool once, and re-check the size each iteration in case a callback
+			// adds components of this type
+			std::vector<IComponent*>& pool = _Components[type];
+			_iterationDepth++;
+			for (size_t ix = 0; ix < pool.size(); ix++) {
+				IComponent* component = pool[ix];
+				// Skip slots of components that were removed during this loop
+				if (component == nullptr) continue;
+				// If the component matches our enabled criteria, invoke the callback
+				if ((component->IsEnabled & component->_isObjectActive) | includeDisabled) {
+					// The pool only stores components of this exact type, so a static cast is safe
+					callback(static_cast<ComponentType*>(component));
 				}
 			}
+			_iterationDepth--;
+
+			if (_iterationDepth == 0 && !_poolsToCompact.empty()) {
+				_CompactPools();
+			}
+		}
+
+		/// <summary>
+		/// Gets the number of live components of the given type
+		/// </summary>
+		/// <typeparam name="ComponentType">The type of component to count</typeparam>
+		template <
+			typename ComponentType,
+			typename = typename std::enable_if<std::is_base_of<IComponent, ComponentType>::value>::type>
+		size_t Count() {
+			const std::vector<IComponent*>& pool = _Components[std::type_index(typeid(ComponentType))];
+			// Pools can have holes in them while Each is running
+			return _iterationDepth > 0 ? pool.size() - std::count(pool.begin(), pool.end(), nullptr) : pool.size();
+		}
+
+		/// <summary>
+		/// Gets the small integer ID assigned to a component type when it was registered, or
+		/// InvalidTypeId if the type has not been registered. IDs are dense and start at 0
+		/// </summary>
+		/// <typeparam name="ComponentType">The type of component to get the ID for</typeparam>
+		template <typename ComponentType>
+		static uint32_t GetTypeId() {
+			return _ComponentTypeId<ComponentType>;
+		}
+
+		/// <summary>
+		/// Gets the small integer ID assigned to a component type when it was registered, or
+		/// InvalidTypeId if the type has not been registered
+		/// </summary>
+		/// <param name="type">The type of component to get the ID for</param>
+		static uint32_t GetTypeId(const std::type_index& type) {
+			auto it = _TypeIdMap.find(type);
+			return it == _TypeIdMap.end() ? InvalidTypeId : it->second;
+		}
+
+		/// <summary>
+		/// Returns true if the component type with the given ID has opted into having Update
+		/// invoked from worker threads (see has_thread_safe_update)
+		/// </summary>
+		/// <param name="typeId">The type ID to check, from GetTypeId</param>
+		static bool IsThreadSafeUpdate(uint32_t typeId) {
+			return typeId < MaxComponentTypes && (_ThreadSafeUpdateMask >> typeId) & 1;
+		}
+
+		/// <summary>
+		/// Returns true if any registered component type has opted into thread safe updates
+		/// </summary>
+		static bool HasThreadSafeUpdateTypes() {
+			return _ThreadSafeUpdateMask != 0;
+		}
+
+		/// <summary>
+		/// Returns true if the component type with the given ID overrides Update (see overrides_update),
+		/// components that don't are never ticked
+		/// </summary>
+		/// <param name="typeId">The type ID to check, from GetTypeId</param>
+		static bool HasUpdate(uint32_t typeId) {
+			return typeId < MaxComponentTypes && (_UpdateMask >> typeId) & 1;
+		}
+
+		/// <summary>
+		/// Returns true if the component type with the given ID overrides any of the GUI rendering
+		/// methods (see overrides_gui)
+		/// </summary>
+		/// <param name="typeId">The type ID to check, from GetTypeId</param>
+		static bool HasGui(uint32_t typeId) {
+			return typeId < MaxComponentTypes && (_GuiMask >> typeId) & 1;
+		}
+
+		/// <summary>
+		/// Returns true if components of the type with the given ID can be kept when the scene is
+		/// restored from a snapshot (see has_restore_in_place)
+		/// </summary>
+		/// <param name="typeId">The type ID to check, from GetTypeId</param>
+		static bool CanRestoreInPlace(uint32_t typeId) {
+			return typeId < MaxComponentTypes && (_RestoreInPlaceMask >> typeId) & 1;
 		}
 
 		/// <summary>
@@ -231,6 +341,27 @@ namespace Gameplay {
 				_TypeLoadRegistry[type] = &ComponentManager::ParseTypeFromBlob<T>;
 				_TypeCreateRegistry[type] = &ComponentManager::_InternalCreate<T>;
 				_TypeNameMap[StringTools::SanitizeClassName(typeid(T).name())] = type;
+
+				// Hand out the next type ID
+				uint32_t typeId = static_cast<uint32_t>(_TypeIdMap.size());
+				LOG_ASSERT(typeId < MaxComponentTypes, "Too many component types have been registered!");
+				_TypeIdMap[type] = typeId;
+				_ComponentTypeId<T> = typeId;
+
+				if constexpr (has_thread_safe_update<T>::value) {
+					_ThreadSafeUpdateMask |= uint64_t(1) << typeId;
+				}
+				if constexpr (has_restore_in_place<T>::value) {
+					_RestoreInPlaceMask |= uint64_t(1) << typeId;
+				}
+				// Figure out which phases the type actually needs to be invoked for, so game
+				// objects can skip the empty virtual calls
+				if constexpr (overrides_update<T>::value) {
+					_UpdateMask |= uint64_t(1) << typeId;
+				}
+				if constexpr (overrides_gui<T>::value) {
+					_GuiMask |= uint64_t(1) << typeId;
+				}
 			}
 		}
 
@@ -238,12 +369,18 @@ namespace Gameplay {
 		/// Removes all components of all types from the registry, whether they are referenced elsewhere or not
 		/// </summary>
 		inline void FlushAll() {
-			_Components = std::unordered_map<std::type_index, std::vector<std::weak_ptr<IComponent>>>();
+			_Components = std::unordered_map<std::type_index, std::vector<IComponent*>>();
+			_ComponentsByGuid = std::unordered_map<Guid, IComponent*>();
+			_poolsToCompact.clear();
 		}
 
 	private:
 		// Give component friend access so it can call Remove
 		friend class IComponent;
+		// Game objects and scenes need to create components without adding them to the pools
+		// when structural changes are deferred during parallel updates
+		friend class GameObject;
+		friend class Scene;
 
 		// This maps a readable type name to it's type_index. We use optional in case we try and access
 		// an element that does not have a type (and unordered_map requires a default constructor, which
@@ -253,11 +390,30 @@ namespace Gameplay {
 		inline static std::unordered_map<std::type_index, LoadComponentFunc> _TypeLoadRegistry;
 		// Stores functions to load components from JSON, indexed on the type that they load
 		inline static std::unordered_map<std::type_index, CreateComponentFunc> _TypeCreateRegistry;
-
-		// Weak pointers let us store a reference to an object stored by a shared pointer, without
-		// actually increasing the reference count. Thus components will be destroyed at the correct
-		// time (when the only reference is the one stored here).
-		std::unordered_map<std::type_index, std::vector<std::weak_ptr<IComponent>>> _Components;  
+		// Maps registered types to their dense type IDs
+		inline static std::unordered_map<std::type_index, uint32_t> _TypeIdMap;
+		// Per-type copy of the type ID, so templated lookups don't need to touch the map
+		template <typename T>
+		inline static uint32_t _ComponentTypeId = InvalidTypeId;
+		// Bit N is set if the type with ID N has opted into thread safe updates
+		inline static uint64_t _ThreadSafeUpdateMask = 0;
+		// Bit N is set if the type with ID N can be kept when restoring a snapshot
+		inline static uint64_t _RestoreInPlaceMask = 0;
+		// Bit N is set if the type with ID N overrides Update, or any of the GUI methods
+		inline static uint64_t _UpdateMask = 0;
+		inline static uint64_t _GuiMask = 0;
+
+		// Dense per-type pools of the live components. Components are still owned by their game objects
+		// through shared pointers, so we only store raw pointers here. Each component remembers its slot
+		// in the pool, and removes itself from the pool in its destructor, so these never dangle
+		std::unordered_map<std::type_index, std::vector<IComponent*>> _Components;  
+		// Lets us find components by their GUID without searching the pools, kept in sync
+		// with the pools by _AddToPool and Remove
+		std::unordered_map<Guid, IComponent*> _ComponentsByGuid;
+		// The number of Each calls that are currently running, removals leave holes in the pools while this is non zero
+		size_t _iterationDepth = 0;
+		// Pools that have had holes left in them by removals during Each, and need to be compacted
+		std::vector<std::vector<IComponent*>*> _poolsToCompact;
 
 		template <typename T>
 		static IComponent::Sptr ParseTypeFromBlob(const nlohmann::json& blob) {
@@ -282,29 +438,109 @@ namespace Gameplay {
 			return component;
 		}
 
+		/// <summary>
+		/// Creates a new component without adding it to the pools, it must be passed to _AddToPool
+		/// before it will show up in Each or GetComponentByGUID
+		/// </summary>
+		template <
+			typename ComponentType,
+			typename ... TArgs>
+		std::shared_ptr<ComponentType> _CreateDetached(TArgs&& ... args) {
+			std::type_index type = std::type_index(typeid(ComponentType));
+			LOG_ASSERT(_TypeLoadRegistry[type] != nullptr, "You must register component types before creating them!");
+
+			// Create component, forwarding arguments
+			std::shared_ptr<ComponentType> component = std::make_shared<ComponentType>(std::forward<TArgs>(args)...);
+
+			// Make sure the component knows it's concrete type
+			component->_realType = type;
+			// Give the component a weak pointer to itself that it can upcast to a shared pointer when needed
+			component->_weakSelfPtr = component;
+
+			return component;
+		}
+
+		/// <summary>
+		/// Creates a new component of the given type without adding it to the pools
+		/// </summary>
+		inline IComponent::Sptr _CreateDetached(const std::type_index& type) {
+			// Get the create callback and make sure it exists, it will handle setting the type and self pointer
+			CreateComponentFunc callback = _TypeCreateRegistry[type];
+			return callback ? callback() : nullptr;
+		}
+
+		/// <summary>
+		/// Appends a component to the end of the pool for its type, lets it know its slot,
+		/// and adds it to the GUID lookup
+		/// </summary>
+		/// <param name="component">The component to add, should have its real type and GUID set</param>
+		inline void _AddToPool(IComponent* component) {
+			std::vector<IComponent*>& pool = _Components[component->_realType];
+			component->_typeId = GetTypeId(component->_realType);
+			component->_poolIndex = pool.size();
+			pool.push_back(component);
+			_ComponentsByGuid[component->GetGUID()] = component;
+		}
+
 		/// <summary>
 		/// Removes a given component from the global pools. To be used in the IComponent destructor
 		/// </summary>
-		/// <typeparam name="ComponentType">The type of component to destroy</typeparam>
 		/// <param name="component">A raw pointer to the component to remove (should be called from IComponent destructor)</param>
-		/// <returns>True if the element was removed, false if not</returns>
 		inline void Remove(const IComponent* component) {
 			if (_Components.size() == 0) return;
 
 			// Make sure the component's type was one that was registered
 			LOG_ASSERT(_TypeLoadRegistry[component->_realType] != nullptr, "You must register component types before creating them!");
 
-			
 			// Get a reference to the vector of components for easy access
-			std::vector<std::weak_ptr<IComponent>>& componentStore = _Components[component->_realType];
-
-			// Clear any dead weak pointers
-			auto it = std::remove_if(componentStore.begin(), componentStore.end(), [](const std::weak_ptr<IComponent>& ptr) {
-				return ptr.expired();
-				});
-			if (it != componentStore.end()) {
-				componentStore.erase(it);
+			auto it = _Components.find(component->_realType);
+			if (it == _Components.end()) return;
+			std::vector<IComponent*>& pool = it->second;
+
+			// The pool may have been flushed since the component was added, so make sure the
+			// slot still belongs to this component before we touch it
+			size_t index = component->_poolIndex;
+			if (index >= pool.size() || pool[index] != component) return;
+
+			if (_iterationDepth > 0) {
+				// Swapping the last element in could move it behind a running Each, so leave a hole
+				// that gets cleaned up once iteration is done
+				pool[index] = nullptr;
+				if (std::find(_poolsToCompact.begin(), _poolsToCompact.end(), &pool) == _poolsToCompact.end()) {
+					_poolsToCompact.push_back(&pool);
+				}
+			} else {
+				// Swap the last element into the vacated slot so the pool stays dense
+				IComponent* last = pool.back();
+				pool[index] = last;
+				last->_poolIndex = index;
+				pool.pop_back();
+			}
+
+			// Only drop the GUID entry if it's ours, in case another component has claimed the ID
+			auto guidIt = _ComponentsByGuid.find(component->GetGUID());
+			if (guidIt != _ComponentsByGuid.end() && guidIt->second == component) {
+				_ComponentsByGuid.erase(guidIt);
+			}
+		}
+
+		/// <summary>
+		/// Removes the holes left by components that were removed during Each, keeping the
+		/// order of the remaining components and updating their slots
+		/// </summary>
+		inline void _CompactPools() {
+			for (std::vector<IComponent*>* pool : _poolsToCompact) {
+				size_t count = 0;
+				for (size_t ix = 0; ix < pool->size(); ix++) {
+					IComponent* component = (*pool)[ix];
+					if (component != nullptr) {
+						component->_poolIndex = count;
+						(*pool)[count++] = component;
+					}
+				}
+				pool->resize(count);
 			}
+			_poolsToCompact.clear();
 		}
 	};
 }
\ No newline at end of file
@@ -14,10 +14,21 @@
 
 void EnemyController::Awake()
 {
+	// The "Bullet" pool is shared by every enemy, so it's registered once by the scene's setup
+	if (!GetGameObject()->GetScene()->HasObjectPool("Bullet")) {
+		LOG_WARN("No \"Bullet\" object pool has been registered, enemies will not be able to shoot");
+	}
 
+	// Fire as soon as we start playing, OnTimer takes care of the cooldown after that
+	SetTimer(0.0f);
 }
 
 void EnemyController::RenderImGui() {
+	const Gameplay::Scene::ObjectPoolStats* stats = GetGameObject()->GetScene()->GetObjectPoolStats("Bullet");
+	if (stats != nullptr) {
+		ImGui::Text("Bullets active: %u, pooled: %u", stats->Active, stats->Available);
+		ImGui::Text("Bullets acquired: %u, re-used: %u (%.1f%%)", stats->Acquired, stats->Reused, stats->HitRate() * 100.0f);
+	}
 }
 
 nlohmann::json EnemyController::ToJson() const {
@@ -43,36 +54,6 @@ void EnemyController::Update(float deltaTime) {
 	newPos.y = _playerRef->GetPosition().y;
 	GetGameObject()->SetPostion(newPos);
 
-	if (shotTimer > 0) {
-		shotTimer -= deltaTime;
-	}
-	else {
-		shotTimer = shotCooldown;
-
-		Gameplay::GameObject::Sptr bullet = GetGameObject()->GetScene()->CreateGameObject("Bullet");
-		{
-			// Set position in the scene
-			bullet->SetPostion(GetGameObject()->GetPosition());
-			bullet->SetRotation({ 0, 0, 0 });
-			bullet->SetScale({ 0.5f, 0.5f, 0.5f });
-
-			// Create and attach a renderer for the monkey
-			RenderComponent::Sptr renderer = bullet->Add<RenderComponent>();
-			renderer->SetMesh(bulletMesh);
-			renderer->SetMaterial(bulletMat);
-
-			// Projectile!
-			Projectile::Sptr projectile = bullet->Add<Projectile>();
-			
-			Gameplay::Physics::TriggerVolume::Sptr volume = bullet->Add<Gameplay::Physics::TriggerVolume>();
-			Gameplay::Physics::BoxCollider::Sptr collider = Gameplay::Physics::BoxCollider::Create(glm::vec3(0.5f, 0.5f, 0.5f));
-			collider->SetPosition(glm::vec3(0.0f, 0.0f, 0.0f));
-			volume->AddCollider(collider);
-
-			bullet->Add<TriggerVolumeEnterBehaviour>();
-		}
-	}
-
 	// Win Condition
 	if (glm::distance(newPos, _playerRef->GetPosition()) < 2.5f) {
 		LOG_INFO("Player Wins!");	
@@ -81,4 +62,11 @@ void EnemyController::Update(float deltaTime) {
 		t.SetTimeScale(0.0f);
 	}
 
+}
+
+void EnemyController::OnTimer() {
+	SetTimer(shotCooldown);
+
+	// Grab a bullet from the pool (registered by the scene's setup), spawning it at our position
+	GetGameObject()->GetScene()->AcquirePooledObject("Bullet", GetGameObject()->GetPosition());
 }
\ No newline at end of file
@@ -19,6 +19,7 @@ public:
 
 	virtual void Awake() override;
 	virtual void Update(float deltaTime) override;
+	virtual void OnTimer() override;
 
 public:
 	virtual void RenderImGui() override;
@@ -27,16 +28,10 @@ public:
 	static EnemyController::Sptr FromJson(const nlohmann::json& blob);
 
 	inline void SetPlayerRef(Gameplay::GameObject::Sptr object) { _playerRef = object; }
-	inline void SetBulletMesh(Gameplay::MeshResource::Sptr mesh) { bulletMesh = mesh; }
-	inline void SetBulletMaterial(Gameplay::Material::Sptr mat) { bulletMat = mat; }
 
 protected:
 
 	Gameplay::GameObject::Sptr _playerRef;
 	Gameplay::Physics::RigidBody::Sptr _body;
-	float shotTimer = 0.0f;
 	float shotCooldown = 5.0f;
-
-	Gameplay::Material::Sptr bulletMat;
-	Gameplay::MeshResource::Sptr bulletMesh;
 };
\ No newline at end of file
@@ -8,6 +8,17 @@ namespace Gameplay {
 		return _context;
 	}
 
+	void IComponent::MarkChanged() {
+		_BumpStateVersion();
+		if (_context != nullptr) {
+			_context->MarkChanged();
+		}
+	}
+
+	void IComponent::_BumpStateVersion() {
+		_stateVersion = _nextStateVersion++;
+	}
+
 	std::weak_ptr<IComponent>& IComponent::SelfRef() {
 		return _weakSelfPtr;
 	}
@@ -28,10 +39,78 @@ namespace Gameplay {
 		IResource(),
 		IsEnabled(true),
 		_realType(typeid(IComponent)),
-		_context(nullptr)
-	{ }
+		_context(nullptr),
+		_poolIndex(SIZE_MAX),
+		_typeId(ComponentManager::InvalidTypeId),
+		_isObjectActive(true),
+		_stateVersion(_nextStateVersion++),
+		_updateTimer(TimerWheel::Timer()),
+		_callbackTimer(TimerWheel::Timer()),
+		_updateInterval(0.0f),
+		_sleepDuration(0.0f),
+		_timerDelay(-1.0f),
+		_isTimerRequested(false),
+		_isScheduleDirty(false),
+		_isSleeping(false),
+		_isScheduled(false),
+		_lastUpdateTime(0.0)
+	{
+		_updateTimer.Component = this;
+		_callbackTimer.Component = this;
+	}
 
 	IComponent::~IComponent() {
-		_context->GetScene()->Components().Remove(this);
+		Scene* scene = _context->GetScene();
+		scene->_CancelSchedule(this);
+		scene->Components().Remove(this);
+	}
+
+	void IComponent::SetUpdateRate(float updatesPerSecond) {
+		_updateInterval = updatesPerSecond > 0.0f ? 1.0f / updatesPerSecond : 0.0f;
+		_isScheduleDirty = true;
+		_OnScheduleChanged();
+	}
+
+	float IComponent::GetUpdateRate() const {
+		return _updateInterval > 0.0f ? 1.0f / _updateInterval : 0.0f;
+	}
+
+	void IComponent::SleepFor(float seconds) {
+		_isSleeping = true;
+		_sleepDuration = glm::max(seconds, 0.0f);
+		_isScheduleDirty = true;
+		_OnScheduleChanged();
+	}
+
+	void IComponent::Wake() {
+		if (_isSleeping) {
+			// We still go through the scheduler, so that Update gets the time we were asleep for
+			_sleepDuration = 0.0f;
+			_isScheduleDirty = true;
+			_OnScheduleChanged();
+		}
+	}
+
+	bool IComponent::IsSleeping() const {
+		return _isSleeping;
+	}
+
+	void IComponent::SetTimer(float seconds) {
+		_timerDelay = glm::max(seconds, 0.0f);
+		_isTimerRequested = true;
+		_OnScheduleChanged();
+	}
+
+	void IComponent::CancelTimer() {
+		_timerDelay = -1.0f;
+		_isTimerRequested = true;
+		_OnScheduleChanged();
+	}
+
+	void IComponent::_OnScheduleChanged() {
+		// If we haven't been attached yet, our game object will pass this on once we are
+		if (_context != nullptr && _context->GetScene() != nullptr) {
+			_context->GetScene()->_OnScheduleChanged(this);
+		}
 	}
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include <memory>
+#include <atomic>
 #include "json.hpp"
 #include <imgui.h>
 #include <GLM/glm.hpp>
@@ -8,6 +9,7 @@
 #include "Utils/ResourceManager/ResourceManager.h"
 #include "Utils/ResourceManager/IResource.h"
 #include "Utils/TypeHelpers.h"
+#include "Gameplay/TimerWheel.h"
 
 namespace Gameplay {
 	// We pre-declare GameObject to avoid circular dependencies in the headers
@@ -27,6 +29,23 @@ namespace Gameplay {
 	/// static std::shared_ptr<Type> FromJson(const nlohmann::json&);
 	/// 
 	/// where Type is the Type of component
+	/// 
+	/// Components whose Update only touches their own state and their own game object's
+	/// local transform can opt into being updated from worker threads by declaring:
+	/// 
+	/// static constexpr bool ThreadSafeUpdate = true;
+	/// 
+	/// Components that save all of the state they change while playing (or reset it in OnRestored)
+	/// can be kept when the scene is restored from a snapshot, rather than being re-created, by declaring:
+	/// 
+	/// static constexpr bool RestoreInPlace = true;
+	/// 
+	/// Such components must call MarkChanged whenever code outside of RenderImGui changes their saved
+	/// state, since the restore only re-creates components whose state has changed since the snapshot
+	/// 
+	/// Components that don't need to update every frame can lower their update rate, or go
+	/// to sleep, via SetUpdateRate and SleepFor. These are driven by the scene's timer wheel
+	/// (and always run on the main thread), so idle components cost nothing per frame
 	/// </summary>
 	class IComponent : public IResource {
 	public:
@@ -100,6 +119,64 @@ namespace Gameplay {
 		/// <param name="deltaTime">The time since the last frame, in seconds</param>
 		virtual void Update(float deltaTime) {};
 
+		/// <summary>
+		/// Invoked when the game object this component is attached to is activated or deactivated,
+		/// for instance when it is taken from or returned to an object pool
+		/// </summary>
+		/// <param name="isActive">True if the object has just been activated, false if it has been deactivated</param>
+		virtual void OnActiveChanged(bool isActive) {};
+
+		/// <summary>
+		/// Invoked on the main thread when a timer started with SetTimer expires, while playing.
+		/// Timers that expire while the component is disabled or inactive are dropped
+		/// </summary>
+		virtual void OnTimer() {};
+		/// <summary>
+		/// Invoked on components that declare RestoreInPlace when the scene has been restored from
+		/// a snapshot (see Scene::RestoreSnapshot) and the component has been kept. Components should
+		/// reset any runtime state that they do not save here (ex: velocities)
+		/// </summary>
+		virtual void OnRestored() {};
+
+		/// <summary>
+		/// Sets how many times per second Update should be invoked, the delta time passed to Update
+		/// will be the time since this component was last updated. Zero (the default) updates the
+		/// component every frame
+		/// </summary>
+		/// <param name="updatesPerSecond">The update rate in Hz, or 0 to update every frame</param>
+		void SetUpdateRate(float updatesPerSecond);
+		/// <summary>
+		/// Gets the update rate in Hz, or 0 if this component updates every frame
+		/// </summary>
+		float GetUpdateRate() const;
+
+		/// <summary>
+		/// Stops invoking Update until the given number of seconds have passed. When the component
+		/// wakes up, Update is invoked with the total time slept, and the component goes back to its
+		/// usual update rate
+		/// </summary>
+		/// <param name="seconds">The time to sleep for, in seconds</param>
+		void SleepFor(float seconds);
+		/// <summary>
+		/// Wakes up a sleeping component early, it will be updated on the next frame
+		/// </summary>
+		void Wake();
+		/// <summary>
+		/// Gets whether this component is waiting to be woken up
+		/// </summary>
+		bool IsSleeping() const;
+
+		/// <summary>
+		/// Starts a timer that will invoke OnTimer after the given number of seconds, replacing the
+		/// timer if it is already running. Useful for cooldowns, instead of counting down in Update
+		/// </summary>
+		/// <param name="seconds">The time until the timer expires, in seconds</param>
+		void SetTimer(float seconds);
+		/// <summary>
+		/// Stops the timer started with SetTimer, if it is running
+		/// </summary>
+		void CancelTimer();
+
 		/// <summary>
 		/// All components should override this to allow us to render component
 		/// info in ImGui for easy editing
@@ -119,6 +196,13 @@ namespace Gameplay {
 		/// </summary>
 		GameObject* GetGameObject() const;
 
+		/// <summary>
+		/// Flags the gameobject this component is attached to as changed, so that it is included in
+		/// the next delta save and re-created by the next snapshot restore. Call this after changing
+		/// the component's fields from code
+		/// </summary>
+		void MarkChanged();
+
 		/// <summary>
 		/// Checks whether this component's gameobject has a component of the given type
 		/// </summary>
@@ -156,12 +240,58 @@ namespace Gameplay {
 	protected:
 		IComponent();
 
+		/// <summary>
+		/// Marks our state as changed for snapshots (see Scene::RestoreSnapshot), without flagging
+		/// our game object for the next delta save
+		/// </summary>
+		void _BumpStateVersion();
+
 	private:
 		friend class ComponentManager;
 		friend class GameObject;
+		friend class Scene;
 
 		std::type_index _realType;
 		GameObject* _context;
+		// Our slot in the component manager's dense pool for our type
+		size_t _poolIndex;
+		// The ID the component manager gave our type when it was registered
+		uint32_t _typeId;
+		// Mirrors our game object's active state, so the component manager can skip us without looking at the object
+		bool _isObjectActive;
+		// Changes every time our state is marked as changed, values are unique across all components
+		uint64_t _stateVersion;
+		inline static std::atomic<uint64_t> _nextStateVersion { 1 };
+
+		// Scheduling state, applied by the scene in Scene::_ApplySchedule. While _isScheduled is set
+		// our game object leaves us out of its update lists, and _updateTimer drives our updates instead
+		TimerWheel::Timer _updateTimer;
+		TimerWheel::Timer _callbackTimer;
+		// Seconds between updates, or 0 to update every frame
+		float  _updateInterval;
+		// How long to sleep for, only meaningful while _isSleeping is set
+		float  _sleepDuration;
+		// Set when SetTimer or CancelTimer have been called but not yet applied, a negative
+		// delay cancels the timer
+		float  _timerDelay;
+		bool   _isTimerRequested;
+		// Set when the update rate or sleep state has changed but not yet been applied
+		bool   _isScheduleDirty;
+		bool   _isSleeping;
+		bool   _isScheduled;
+		// The scene's timer wheel time when we were last updated by the scheduler
+		double _lastUpdateTime;
+
+		/// <summary>
+		/// Lets the scene know that our schedule has changed, if we are attached to an object
+		/// </summary>
+		void _OnScheduleChanged();
+		/// <summary>
+		/// Returns true if the scheduler needs to know about us when we are attached to an object
+		/// </summary>
+		inline bool _HasScheduleRequests() const {
+			return _isScheduleDirty || _isTimerRequested;
+		}
 
 		// By storing a weak pointer to ourselves, we can pass a pointer to this
 		// for things like bullet user pointers
@@ -179,6 +309,58 @@ namespace Gameplay {
 	constexpr bool is_valid_component() {
 		return std::is_base_of<IComponent, T>::value && test_json<T, const nlohmann::json&>::value;
 	}
+
+	/// <summary>
+	/// Value is true if the given component type declares static constexpr bool ThreadSafeUpdate = true
+	/// </summary>
+	/// <typeparam name="T">The type to check</typeparam>
+	template <typename T, typename = void>
+	struct has_thread_safe_update : std::false_type {};
+	template <typename T>
+	struct has_thread_safe_update<T, std::void_t<decltype(T::ThreadSafeUpdate)>> : std::bool_constant<T::ThreadSafeUpdate> {};
+
+	/// <summary>
+	/// Value is true if the given component type declares static constexpr bool RestoreInPlace = true
+	/// </summary>
+	/// <typeparam name="T">The type to check</typeparam>
+	template <typename T, typename = void>
+	struct has_restore_in_place : std::false_type {};
+	template <typename T>
+	struct has_restore_in_place<T, std::void_t<decltype(T::RestoreInPlace)>> : std::bool_constant<T::RestoreInPlace> {};
+
+	/// <summary>
+	/// Type is the class that declares a member function pointer of the given type, or void if the
+	/// member function does not have the expected signature (for instance if it hides our method
+	/// with an overload, rather than overriding it)
+	/// </summary>
+	template <typename Method, typename Signature>
+	struct method_owner { typedef void type; };
+	template <typename Owner, typename Signature>
+	struct method_owner<Signature Owner::*, Signature> { typedef Owner type; };
+
+	/// <summary>
+	/// Returns true if the given member function pointer type is an override of one of IComponent's methods
+	/// </summary>
+	template <typename Method, typename Signature>
+	constexpr bool is_component_override() {
+		typedef typename method_owner<Method, Signature>::type Owner;
+		return !std::is_void<Owner>::value && !std::is_same<Owner, IComponent>::value;
+	}
+
+	/// <summary>
+	/// Value is true if the given component type (or one of its bases) overrides Update
+	/// </summary>
+	template <typename T>
+	struct overrides_update : std::bool_constant<is_component_override<decltype(&T::Update), void(float)>()> {};
+
+	/// <summary>
+	/// Value is true if the given component type (or one of its bases) overrides StartGUI, RenderGUI or FinishGUI
+	/// </summary>
+	template <typename T>
+	struct overrides_gui : std::bool_constant<
+		is_component_override<decltype(&T::StartGUI), void()>() ||
+		is_component_override<decltype(&T::RenderGUI), void()>() ||
+		is_component_override<decltype(&T::FinishGUI), void()>()> {};
 }
 
 // Defines the ComponentTypeName interface to match those used elsewhere by other systems
@@ -21,6 +21,7 @@ const glm::vec3& Light::GetColor() const {
 }
 
 void Light::SetColor(const glm::vec3& value){
+	MarkChanged();
 	_color = value;
 }
 
@@ -29,6 +30,7 @@ const glm::vec3& Light::GetDirection() const {
 }
 
 void Light::SetDirection(const glm::vec3& value) {
+	MarkChanged();
 	_direction = value;
 }
 
@@ -37,6 +39,7 @@ const glm::vec3& Light::GetParams() const {
 }
 
 void Light::SetParams(const glm::vec3& value) {
+	MarkChanged();
 	_params = value;
 }
 
@@ -45,6 +48,7 @@ float Light::GetIntensity() const {
 }
 
 void Light::SetIntensity(float value) {
+	MarkChanged();
 	_intensity = value;
 }
 
@@ -53,6 +57,7 @@ float Light::GetRadius() const {
 }
 
 void Light::SetRadius(float value) {
+	MarkChanged();
 	_radius = value;
 }
 
@@ -61,6 +66,7 @@ LightType Light::GetType() const {
 }
 
 void Light::SetType(LightType value) {
+	MarkChanged();
 	_type = value;
 }
 
@@ -16,6 +16,8 @@ ENUM(LightType, int,
 class Light : public Gameplay::IComponent {
 public:
 	typedef std::shared_ptr<Light> Sptr;
+	// Everything we hold is saved, so we can be kept when restoring a snapshot
+	static constexpr bool RestoreInPlace = true;
 
 	std::weak_ptr<Gameplay::IComponent> Panel;
 
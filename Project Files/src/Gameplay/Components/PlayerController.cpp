@@ -54,15 +54,11 @@ void PlayerController::Update(float deltaTime) {
 	}
 	
 	GetGameObject()->SetPostion(newPos);
+}
 
-	if (damageReceivedTimer > 0) {
-		damageReceivedTimer -= deltaTime;
-	}
-
-	if (damageReceivedTimer < 0) {
-		GetGameObject()->Get<RenderComponent>()->GetMaterial()->GetShader()->SetUniform("u_Effect.Enabled", false);
-		damageReceivedTimer = 0;
-	}
+void PlayerController::OnTimer() {
+	// Our damage flash has run its course
+	GetGameObject()->Get<RenderComponent>()->GetMaterial()->GetShader()->SetUniform("u_Effect.Enabled", false);
 }
 
 void PlayerController::DealDamage() {
@@ -76,6 +72,6 @@ void PlayerController::DealDamage() {
 	}
 	else {
 		GetGameObject()->Get<RenderComponent>()->GetMaterial()->GetShader()->SetUniform("u_Effect.Enabled", true);
-		damageReceivedTimer = 1.0f;
+		SetTimer(1.0f);
 	}
 }
\ No newline at end of file
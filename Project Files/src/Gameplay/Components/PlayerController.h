@@ -16,6 +16,7 @@ public:
 
 	virtual void Awake() override;
 	virtual void Update(float deltaTime) override;
+	virtual void OnTimer() override;
 
 public:
 	virtual void RenderImGui() override;
@@ -32,5 +33,4 @@ protected:
 	Gameplay::Physics::RigidBody::Sptr _body;
 
 	Gameplay::Material::Sptr _matRef;
-	float damageReceivedTimer = 0.0f;
 };
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "Gameplay/GameObject.h"
 #include "Gameplay/Scene.h"
 #include "Utils/ImGuiHelper.h"
+#include "Utils/JsonGlmHelpers.h"
 #include "Gameplay/InputEngine.h"
 
 void Projectile::Awake()
@@ -11,22 +12,26 @@ void Projectile::Awake()
 }
 
 void Projectile::RenderImGui() {
+	LABEL_LEFT(ImGui::DragFloat, "Lifetime", &Lifetime, 0.1f, 0.0f);
 }
 
 nlohmann::json Projectile::ToJson() const {
 	return {
-
+		{ "lifetime", Lifetime }
 	};
 }
 
 Projectile::Projectile() :
-	IComponent()
+	IComponent(),
+	Lifetime(30.0f),
+	_age(0.0f)
 { }
 
 Projectile::~Projectile() = default;
 
 Projectile::Sptr Projectile::FromJson(const nlohmann::json & blob) {
 	Projectile::Sptr result = std::make_shared<Projectile>();
+	result->Lifetime = JsonGet(blob, "lifetime", result->Lifetime);
 	return result;
 }
 
@@ -34,4 +39,17 @@ void Projectile::Update(float deltaTime)
 {
 	glm::vec3 newPos = GetGameObject()->GetPosition() + glm::vec3(-deltaTime, 0.0f, 0.0f);
 	GetGameObject()->SetPostion(newPos);
+
+	// Anything that has flown this long has missed, hand it back so it can be fired again
+	_age += deltaTime;
+	if (_age >= Lifetime) {
+		GetGameObject()->GetScene()->ReleasePooledObject(GetGameObject()->SelfRef());
+	}
+}
+
+void Projectile::OnActiveChanged(bool isActive) {
+	// Pooled projectiles get re-used, so start the clock again
+	if (isActive) {
+		_age = 0.0f;
+	}
 }
\ No newline at end of file
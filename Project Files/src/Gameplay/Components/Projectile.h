@@ -9,12 +9,15 @@
 class Projectile : public Gameplay::IComponent {
 public:
 	typedef std::shared_ptr<Projectile> Sptr;
+	// We only ever touch our own object's position
+	static constexpr bool ThreadSafeUpdate = true;
 
 	Projectile();
 	virtual ~Projectile();
 
 	virtual void Awake() override;
 	virtual void Update(float deltaTime) override;
+	virtual void OnActiveChanged(bool isActive) override;
 
 public:
 	virtual void RenderImGui() override;
@@ -22,7 +25,11 @@ public:
 	virtual nlohmann::json ToJson() const override;
 	static Projectile::Sptr FromJson(const nlohmann::json& blob);
 
+	// How long the projectile flies for before it is released, in seconds
+	float Lifetime;
+
 protected:
 	
 	Gameplay::Physics::RigidBody::Sptr _body;
+	float _age;
 };
\ No newline at end of file
@@ -17,6 +17,7 @@ RenderComponent::RenderComponent() :
 { }
 
 RenderComponent* RenderComponent::SetMesh(const Gameplay::MeshResource::Sptr& mesh) {
+	MarkChanged();
 	_mesh = mesh;
 	return this;
 }
@@ -30,6 +31,7 @@ VertexArrayObject::Sptr RenderComponent::GetMesh() const {
 }
 
 RenderComponent* RenderComponent::SetMaterial(const Gameplay::Material::Sptr& mat) {
+	MarkChanged();
 	_material = mat;
 	return this;
 }
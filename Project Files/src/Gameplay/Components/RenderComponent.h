@@ -12,6 +12,8 @@
 class RenderComponent : public Gameplay::IComponent {
 public:
 	typedef std::shared_ptr<RenderComponent> Sptr;
+	// Everything we hold is saved, so we can be kept when restoring a snapshot
+	static constexpr bool RestoreInPlace = true;
 
 	RenderComponent();
 	RenderComponent(const Gameplay::MeshResource::Sptr& mesh, const Gameplay::Material::Sptr& material);
@@ -7,6 +7,10 @@
 class RotatingBehaviour : public Gameplay::IComponent {
 public:
 	typedef std::shared_ptr<RotatingBehaviour> Sptr;
+	// We only ever touch our own object's rotation
+	static constexpr bool ThreadSafeUpdate = true;
+	// We only change our object's transform, which the snapshot restores
+	static constexpr bool RestoreInPlace = true;
 
 	RotatingBehaviour() = default;
 	glm::vec3 RotationSpeed;
@@ -22,6 +22,7 @@ ShadowCamera::ShadowCamera() :
 ShadowCamera::~ShadowCamera() = default;
 
 void ShadowCamera::SetColor(const glm::vec4& value) {
+	MarkChanged();
 	_color = value;
 }
 
@@ -30,6 +31,7 @@ const glm::vec4& ShadowCamera::GetColor() const {
 }
 
 void ShadowCamera::SetBufferResolution(const glm::ivec2& value) {
+	MarkChanged();
 	LOG_ASSERT(value.x * value.y > 0, "Buffer size must be > 0");
 	_bufferResolution = value;
 	if (_depthBuffer != nullptr) {
@@ -42,6 +44,7 @@ const glm::ivec2& ShadowCamera::GetBufferResolution() const {
 }
 
 void ShadowCamera::SetProjection(const glm::mat4& value) {
+	MarkChanged();
 	_projectionMatrix = value;
 }
 
@@ -55,6 +58,7 @@ glm::mat4 ShadowCamera::GetViewProjection() const
 }
 
 void ShadowCamera::SetProjectionMask(const Texture2D::Sptr& image) {
+	MarkChanged();
 	_projectionMask = image;
 
 	// Update our render flags
@@ -19,6 +19,8 @@ ENUM_FLAGS(ShadowFlags, uint32_t,
 class ShadowCamera final : public Gameplay::IComponent {
 public:
 	MAKE_PTRS(ShadowCamera);
+	// Everything we hold is saved, and keeping us saves re-creating our depth buffer when restoring a snapshot
+	static constexpr bool RestoreInPlace = true;
 
 	/// <summary>
 	/// Stores some bit flags for toggling shadow functionality in the shader
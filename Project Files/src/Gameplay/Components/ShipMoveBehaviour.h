@@ -9,6 +9,8 @@
 class ShipMoveBehaviour : public Gameplay::IComponent {
 public:
 	typedef std::shared_ptr<ShipMoveBehaviour> Sptr;
+	// We only ever touch our own object's position and rotation
+	static constexpr bool ThreadSafeUpdate = true;
 
 	glm::vec3 Center;
 	float     Angle;
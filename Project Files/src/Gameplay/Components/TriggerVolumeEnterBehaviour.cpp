@@ -19,8 +19,8 @@ void TriggerVolumeEnterBehaviour::OnTriggerVolumeEntered(const std::shared_ptr<G
 
 	body->GetComponent<PlayerController>()->DealDamage();
 
-	// Destroy the projectile
-	GetGameObject()->GetScene()->RemoveGameObject(GetGameObject()->SelfRef());
+	// Return the projectile to its pool (or destroy it if it wasn't pooled)
+	GetGameObject()->GetScene()->ReleasePooledObject(GetGameObject()->SelfRef());
 }
 
 void TriggerVolumeEnterBehaviour::OnTriggerVolumeLeaving(const std::shared_ptr<Gameplay::Physics::RigidBody>& body) {
@@ -19,61 +19,49 @@ namespace Gameplay {
 		Name("Unknown"),
 		HideInHierarchy(false),
 		_components(std::vector<IComponent::Sptr>()),
+		_componentMask(0),
+		_componentSlots(std::vector<ComponentSlot>()),
+		_updateComponents(std::vector<IComponent*>()),
+		_threadSafeUpdateComponents(std::vector<IComponent*>()),
+		_guiComponents(std::vector<IComponent*>()),
+		_areComponentListsDirty(false),
 		_scene(nullptr),
+		_isActive(true),
+		_isPendingRemoval(false),
+		_indexOrder(0),
+		_unsavedCheckpoints(AllCheckpoints),
+		_newSinceCheckpoints(AllCheckpoints),
+		_objectPool(""),
 		_position(ZERO),
 		_rotation(glm::quat(glm::vec3(0.0f))),
 		_scale(ONE),
-		_localTransform(MAT4_IDENTITY),
-		_inverseLocalTransform(MAT4_IDENTITY),
+		_transformIndex(TransformHierarchy::InvalidNode),
 		_isLocalTransformDirty(true),
-		_worldTransform(MAT4_IDENTITY),
-		_inverseWorldTransform(MAT4_IDENTITY),
-		_isWorldTransformDirty(true),
+		_detachedTransform(MAT4_IDENTITY),
+		_detachedInverseTransform(MAT4_IDENTITY),
 		_parent(WeakRef()),
 		_children(std::vector<WeakRef>())
 	{ }
 
-	void GameObject::_RecalcLocalTransform() const
-	{
+	void GameObject::_MarkTransformDirty() {
+		_unsavedCheckpoints = AllCheckpoints;
+
+		// Only the first change needs to be passed along, the flag is cleared once the hierarchy catches up
 		if (_isLocalTransformDirty) {
-			_localTransform = glm::translate(MAT4_IDENTITY, _position) * glm::mat4_cast(_rotation) * glm::scale(MAT4_IDENTITY, _scale);
-			_inverseLocalTransform = glm::inverse(_localTransform);
-			_isLocalTransformDirty = false;
-			_isWorldTransformDirty = true;
-
-			// Dirty all the child objects world transforms
-			for (const auto& childPtr : _children) {
-				GameObject::Sptr childSptr = childPtr;
-				if (childSptr != nullptr) {
-					childSptr->_isWorldTransformDirty = true;
-				}
-			}
+			return;
 		}
-	}
-
-	void GameObject::_RecalcWorldTransform() const {
-		// Start by determining our local transform if required
-		_RecalcLocalTransform();
-
-		// If our world transform has been marked as dirty, we need to recalculate it!
-		if (_isWorldTransformDirty) {
-			GameObject::Sptr parent = _parent;
-
-			// If out parent exists, we apply our local transformation relative to the parent's world transformation
-			if (parent != nullptr) {
-				_worldTransform = parent->GetTransform() * _localTransform;
-				_inverseWorldTransform = glm::inverse(_worldTransform);
-			}
+		_isLocalTransformDirty = true;
 
-			// If our parent is null, we can simply use the local transform as the world transform
-			else {
-				_worldTransform = _localTransform;
-				_inverseWorldTransform = _inverseLocalTransform;
-			}
-			_isWorldTransformDirty = false;
+		if (_transformIndex != TransformHierarchy::InvalidNode) {
+			_scene->_OnTransformChanged(this);
 		}
 	}
 
+	const glm::mat4& GameObject::_GetDetachedTransform() const {
+		TransformHierarchy::ComposeTransform(_position, _rotation, _scale, _detachedTransform);
+		return _detachedTransform;
+	}
+
 	void GameObject::_PurgeDeletedChildren() {
 		auto it = std::remove_if(_children.begin(), _children.end(), [](WeakRef child) { 
 			return child == nullptr; 
@@ -113,7 +101,7 @@ namespace Gameplay {
 
 	void GameObject::SetPostion(const glm::vec3& position) {
 		_position = position;
-		_isLocalTransformDirty = true;
+		_MarkTransformDirty();
 	}
 
 	const glm::vec3& GameObject::GetPosition() const {
@@ -126,7 +114,7 @@ namespace Gameplay {
 
 	void GameObject::SetRotation(const glm::quat& value) {
 		_rotation = value;
-		_isLocalTransformDirty = true;
+		_MarkTransformDirty();
 	}
 
 	const glm::quat& GameObject::GetRotation() const {
@@ -135,7 +123,7 @@ namespace Gameplay {
 
 	void GameObject::SetRotation(const glm::vec3& eulerAngles) {
 		_rotation = glm::quat(glm::radians(eulerAngles));
-		_isLocalTransformDirty = true;
+		_MarkTransformDirty();
 	}
 
 	glm::vec3 GameObject::GetRotationEuler() const {
@@ -144,47 +132,62 @@ namespace Gameplay {
 
 	void GameObject::SetScale(const glm::vec3& value) {
 		_scale = value;
-		_isLocalTransformDirty = true;
+		_MarkTransformDirty();
 	}
 
 	const glm::vec3& GameObject::GetScale() const {
 		return _scale;
 	}
 
-	const glm::mat4& GameObject::GetTransform() const {
-		_RecalcWorldTransform();
-		return _worldTransform;
+	glm::mat4 GameObject::GetTransform() const {
+		if (_transformIndex == TransformHierarchy::InvalidNode) {
+			return _GetDetachedTransform();
+		}
+		return _scene->_transforms.GetWorld(_transformIndex);
 	}
 
-	const glm::mat4& GameObject::GetInverseTransform() const {
-		_RecalcWorldTransform();
-		return _inverseWorldTransform;
+	glm::mat4 GameObject::GetInverseTransform() const {
+		if (_transformIndex == TransformHierarchy::InvalidNode) {
+			_detachedInverseTransform = glm::inverse(_GetDetachedTransform());
+			return _detachedInverseTransform;
+		}
+		return _scene->_transforms.GetInverseWorld(_transformIndex);
 	}
 
-	const glm::mat4& GameObject::GetLocalTransform() const
+	glm::mat4 GameObject::GetLocalTransform() const
 	{
-		_RecalcLocalTransform();
-		return _localTransform;
+		if (_transformIndex == TransformHierarchy::InvalidNode) {
+			return _GetDetachedTransform();
+		}
+		return _scene->_transforms.GetLocal(_transformIndex);
 	}
 
-	const glm::mat4& GameObject::GetInverseLocalTransform() const {
-		_RecalcLocalTransform();
-		return _inverseLocalTransform;
+	glm::mat4 GameObject::GetInverseLocalTransform() const {
+		if (_transformIndex == TransformHierarchy::InvalidNode) {
+			_detachedInverseTransform = glm::inverse(_GetDetachedTransform());
+			return _detachedInverseTransform;
+		}
+		return _scene->_transforms.GetInverseLocal(_transformIndex);
 	}
 
 	void GameObject::RenderGUI() {
+		if (!_isActive) {
+			return;
+		}
+
 		// Prune children
 		auto it = std::remove_if(_children.begin(), _children.end(), [](const WeakRef& child) { return !child.IsAlive(); });
 		if (it != _children.end()) {
 			_children.erase(it);
 		}
 
-		for (auto& component : _components) {
+		_RebuildComponentLists();
+		for (IComponent* component : _guiComponents) {
 			if (component->IsEnabled) {
 				component->StartGUI();
 			}
 		}
-		for (auto& component : _components) {
+		for (IComponent* component : _guiComponents) {
 			if (component->IsEnabled) {
 				component->RenderGUI();
 			}
@@ -192,7 +195,7 @@ namespace Gameplay {
 		for (auto& child : _children) {
 			child->RenderGUI();
 		}
-		for (auto& component : _components) {
+		for (IComponent* component : _guiComponents) {
 			if (component->IsEnabled) {
 				component->FinishGUI();
 			}
@@ -203,6 +206,31 @@ namespace Gameplay {
 		return _scene;
 	}
 
+	void GameObject::SetActive(bool isActive) {
+		if (_isActive == isActive) {
+			return;
+		}
+		_isActive = isActive;
+		_unsavedCheckpoints = AllCheckpoints;
+
+		for (auto& component : _components) {
+			component->_isObjectActive = isActive;
+			component->OnActiveChanged(isActive);
+		}
+	}
+
+	bool GameObject::IsActive() const {
+		return _isActive;
+	}
+
+	void GameObject::MarkChanged() {
+		_unsavedCheckpoints = AllCheckpoints;
+	}
+
+	bool GameObject::HasUnsavedChanges() const {
+		return (_unsavedCheckpoints & Scene::_CheckpointBit(Scene::Checkpoint::Save)) != 0;
+	}
+
 	void GameObject::Awake() {
 		for (auto& component : _components) {
 			component->Awake();
@@ -210,58 +238,149 @@ namespace Gameplay {
 	}
 
 	void GameObject::Update(float dt) {
-		for (auto& component : _components) {
+		if (!_isActive) {
+			return;
+		}
+
+		// Components that are added or rescheduled during the loop only flag the list as dirty, so it stays
+		// the same until we're done with it. New components get their first update next frame
+		_RebuildComponentLists();
+		for (IComponent* component : _updateComponents) {
 			if (component->IsEnabled) {
 				component->Update(dt);
 			}
 		}
+		_RebuildComponentLists();
 
-		_RecalcLocalTransform();
-		_RecalcWorldTransform();
 		_PurgeDeletedChildren();
 	}
 
-	bool GameObject::Has(const std::type_index& type) {
-		// Iterate over all the pointers in the components list
-		for (const auto& ptr : _components) {
-			// If the pointer type matches T, we return true
-			if (std::type_index(typeid(*ptr.get())) == type) {
-				return true;
+	void GameObject::UpdateThreadSafe(float dt) {
+		if (!_isActive) {
+			return;
+		}
+
+		// Structural changes are deferred during the parallel phase, so nothing can dirty the lists in here
+		_RebuildComponentLists();
+		for (IComponent* component : _threadSafeUpdateComponents) {
+			if (component->IsEnabled) {
+				component->Update(dt);
 			}
 		}
-		return false;
+	}
+
+	bool GameObject::Has(const std::type_index& type) {
+		return _HasTypeId(ComponentManager::GetTypeId(type));
 	}
 
 	std::shared_ptr<IComponent> GameObject::Get(const std::type_index& type)
 	{
-		// Iterate over all the pointers in the binding list
-		for (const auto& ptr : _components) {
-			// If the pointer type matches T, we return that behaviour, making sure to cast it back to the requested type
-			if (std::type_index(typeid(*ptr.get())) == type) {
-				return ptr;
+		uint32_t typeId = ComponentManager::GetTypeId(type);
+		if (!_HasTypeId(typeId)) {
+			return nullptr;
+		}
+		return _components[_componentSlots[_SlotIndex(typeId)]];
+	}
+
+	void GameObject::_RebuildComponentSlots() {
+		// Every change to the set of components comes through here
+		_unsavedCheckpoints = AllCheckpoints;
+
+		LOG_ASSERT(_components.size() <= ComponentManager::MaxComponentTypes, "Game object has more components than there are component types");
+
+		_componentMask = 0;
+		size_t numSlots = 0;
+		for (const auto& component : _components) {
+			// Components only get a type ID once they're in a pool, and shifting by an ID past the end of the mask is undefined
+			uint32_t typeId = component->_typeId;
+			LOG_ASSERT(typeId < ComponentManager::MaxComponentTypes, "Component of type {} has no valid type ID, it will not be found by Get or Has", component->ComponentTypeName());
+			if (typeId < ComponentManager::MaxComponentTypes) {
+				_componentMask |= uint64_t(1) << typeId;
+				numSlots++;
+			}
+		}
+
+		// Now that the mask is known, we can drop each component's index into its slot
+		_componentSlots.resize(numSlots);
+		for (size_t ix = 0; ix < _components.size(); ix++) {
+			uint32_t typeId = _components[ix]->_typeId;
+			if (typeId < ComponentManager::MaxComponentTypes) {
+				_componentSlots[_SlotIndex(typeId)] = static_cast<ComponentSlot>(ix);
+			}
+		}
+
+		// The per-phase lists may be in use, let them be rebuilt when it's safe
+		_areComponentListsDirty = true;
+	}
+
+	void GameObject::_RebuildComponentLists() {
+		if (!_areComponentListsDirty) {
+			return;
+		}
+		_areComponentListsDirty = false;
+
+		// Sort out which components actually need to be ticked, components on a timer are updated by
+		// the scene's scheduler instead
+		_updateComponents.clear();
+		_threadSafeUpdateComponents.clear();
+		_guiComponents.clear();
+		for (const auto& component : _components) {
+			uint32_t typeId = component->_typeId;
+			if (ComponentManager::HasUpdate(typeId) && !component->_isScheduled) {
+				if (ComponentManager::IsThreadSafeUpdate(typeId)) {
+					_threadSafeUpdateComponents.push_back(component.get());
+				} else {
+					_updateComponents.push_back(component.get());
+				}
+			}
+			if (ComponentManager::HasGui(typeId)) {
+				_guiComponents.push_back(component.get());
 			}
 		}
-		return nullptr;
 	}
 
 	std::shared_ptr<IComponent> GameObject::Add(const std::type_index& type)
 	{
 		LOG_ASSERT(!Has(type), "Cannot add 2 instances of a component type to a game object");
 
+		// During the scene's parallel update, let the scene attach the component afterwards
+		if (_scene->IsInParallelUpdate()) {
+			std::shared_ptr<IComponent> component = _scene->_components._CreateDetached(type);
+			component->_context = this;
+			return _scene->_DeferAddComponent(component);
+		}
+
 		// Make a new component, forwarding the arguments
 		std::shared_ptr<IComponent> component = _scene->_components.Create(type);
 		// Let the component know we are the parent
 		component->_context = this;
 
 		// Append it to the binding component's storage, and invoke the OnLoad
+		_AttachComponent(component);
+
+		return component;
+	}
+
+	void GameObject::_AttachComponent(const IComponent::Sptr& component) {
+		component->_isObjectActive = _isActive;
 		_components.push_back(component);
+		_RebuildComponentSlots();
 		component->OnLoad();
 
+		// Pass on any update rate or timers that were requested before we were attached
+		if (component->_HasScheduleRequests()) {
+			_scene->_OnScheduleChanged(component.get());
+		}
+
 		if (_scene->GetIsAwake()) {
 			component->Awake();
 		}
+	}
 
-		return component;
+	void GameObject::_RemoveComponentAt(size_t index) {
+		_scene->_CancelSchedule(_components[index].get());
+		_components.erase(_components.begin() + index);
+		_RebuildComponentSlots();
 	}
 
 	void GameObject::AddChild(const GameObject::Sptr& child) {
@@ -279,7 +398,10 @@ namespace Gameplay {
 			// applies to the child
 			_children.push_back(child);
 			child->_parent = _selfRef.lock();
-			child->_isWorldTransformDirty = true;
+			child->_unsavedCheckpoints = AllCheckpoints;
+			if (_transformIndex != TransformHierarchy::InvalidNode && child->_transformIndex != TransformHierarchy::InvalidNode) {
+				_scene->_transforms.SetParent(child->_transformIndex, _transformIndex);
+			}
 		} else {
 			LOG_WARN("Attempting to add same child twice, ignoring: {}", child->Name);
 		}
@@ -292,7 +414,11 @@ namespace Gameplay {
 		if (it != _children.end()) { 
 			// Clear the object's parent and remove from our list of children
 			child->_parent.Reset();
+			child->_unsavedCheckpoints = AllCheckpoints;
 			_children.erase(it);
+			if (child->_transformIndex != TransformHierarchy::InvalidNode) {
+				_scene->_transforms.SetParent(child->_transformIndex, TransformHierarchy::InvalidNode);
+			}
 			return true;
 		} else {
 			return false;
@@ -354,7 +480,9 @@ namespace Gameplay {
 			}
 
 			// Render position label
-			_isLocalTransformDirty |= LABEL_LEFT(ImGui::DragFloat3, "Position", &_position.x, 0.01f);
+			if (LABEL_LEFT(ImGui::DragFloat3, "Position", &_position.x, 0.01f)) {
+				_MarkTransformDirty();
+			}
 			
 			// Get the ImGui storage state so we can avoid gimbal locking issues by storing euler angles in the editor
 			glm::vec3 euler = GetRotationEuler();
@@ -380,7 +508,9 @@ namespace Gameplay {
 			}
 			
 			// Draw the scale
-			_isLocalTransformDirty |= LABEL_LEFT(ImGui::DragFloat3, "Scale   ", &_scale.x, 0.01f, 0.0f);
+			if (LABEL_LEFT(ImGui::DragFloat3, "Scale   ", &_scale.x, 0.01f, 0.0f)) {
+				_MarkTransformDirty();
+			}
 
 			ImGui::Separator();
 			ImGui::TextUnformatted("Components");
@@ -391,10 +521,12 @@ namespace Gameplay {
 				std::shared_ptr<IComponent> component = _components[ix];
 				if (ImGui::CollapsingHeader(component->ComponentTypeName().c_str())) {
 					ImGui::PushID(component.get()); 
-					component->RenderImGui();
+					if (ImGuiHelper::DrawAndCheckEdited([&]() { component->RenderImGui(); })) {
+						component->MarkChanged();
+					}
 					// Render a delete button for the component
 					if (ImGuiHelper::WarningButton("Delete")) {
-						_components.erase(_components.begin() + ix);
+						_RemoveComponentAt(ix);
 						ix--;
 					}
 					ImGui::PopID();
@@ -438,10 +570,6 @@ namespace Gameplay {
 			ImGui::Unindent();
 		}
 		ImGui::PopID(); // Pop the ImGui ID scope for the object
-
-		// For if we're not in play mode
-		_RecalcLocalTransform();
-		_RecalcWorldTransform();
 	}
 
 	std::shared_ptr<GameObject> GameObject::SelfRef() {
@@ -463,8 +591,8 @@ namespace Gameplay {
 		result->_rotation = (data["rotation"]);
 		result->_scale    = (data["scale"]);
 		result->HideInHierarchy = JsonGet(data, "hide_in_inspector", false);
+		result->_isActive = JsonGet(data, "active", true);
 		result->_isLocalTransformDirty = true;
-		result->_isWorldTransformDirty = true;
 
 		// Since our components are stored based on the type name, we iterate
 		// on the keys and values from the components object
@@ -473,18 +601,94 @@ namespace Gameplay {
 			// We need to reference the component registry to load our components
 			// based on the type name (note that all component types need to be
 			// registered at the start of the application)
-			IComponent::Sptr component = scene->Components().Load(typeName, value);
-			component->_context = result.get();
+			result->_LoadComponent(typeName, value);
+		}
 
-			// Add component to object and allow it to perform self initialization
-			result->_components.push_back(component);
-			component->OnLoad();
+		return result;
+	}
+
+	GameObject::Sptr GameObject::FromBinary(Scene* scene, const SceneBinary::Reader& reader, const SceneBinary::ObjectRecord& record)
+	{
+		GameObject::Sptr result(new GameObject());
+		result->_scene = scene;
+
+		result->Name = std::string(reader.GetName(record));
+		result->_guid = SceneBinary::ReadGuid(record.Guid);
+		result->_parent = WeakRef(SceneBinary::ReadGuid(record.Parent), nullptr);
+		result->_position = glm::vec3(record.Position[0], record.Position[1], record.Position[2]);
+		result->_rotation = glm::quat(record.Rotation[3], record.Rotation[0], record.Rotation[1], record.Rotation[2]);
+		result->_scale    = glm::vec3(record.Scale[0], record.Scale[1], record.Scale[2]);
+		result->HideInHierarchy = (record.Flags & SceneBinary::HideInHierarchy) != 0;
+		result->_isActive = (record.Flags & SceneBinary::Active) != 0;
+		result->_isLocalTransformDirty = true;
+
+		// Components are the only part of the object that still go through JSON, but each one is
+		// decoded from its own small blob
+		std::vector<SceneBinary::ComponentBlob> components;
+		if (!reader.GetComponents(record, components)) {
+			LOG_WARN("Component data for object \"{}\" is corrupted, skipping components", result->Name);
+			components.clear();
+		}
+		for (const SceneBinary::ComponentBlob& blob : components) {
+			nlohmann::json data;
+			if (blob.Decode(data, result->_guid)) {
+				result->_LoadComponent(std::string(blob.TypeName), data);
+			}
 		}
 
 		return result;
 	}
 
+	void GameObject::ToBinary(SceneBinary::Writer& writer) const {
+		GameObject::Sptr parent = _parent;
+		uint32_t flags = 0;
+		flags |= HideInHierarchy ? SceneBinary::HideInHierarchy : 0;
+		flags |= _isActive ? SceneBinary::Active : 0;
+
+		writer.BeginObject(Name, _guid, parent == nullptr ? Guid() : parent->_guid, _position, _rotation, _scale, flags);
+		for (auto& component : _components) {
+			nlohmann::json blob = component->ToJson();
+			IComponent::SaveBaseJson(component, blob);
+			writer.AddComponent(component->ComponentTypeName(), blob);
+		}
+	}
+
+	void GameObject::_LoadComponent(const std::string& typeName, const nlohmann::json& blob) {
+		IComponent::Sptr component = _scene->Components().Load(typeName, blob);
+		if (component == nullptr) {
+			LOG_WARN("Unknown component type \"{}\" on object \"{}\", skipping", typeName, Name);
+			return;
+		}
+		_AddLoadedComponent(component);
+	}
+
+	void GameObject::_AddLoadedComponent(const IComponent::Sptr& component) {
+		component->_context = this;
+		component->_isObjectActive = _isActive;
+
+		// Add component to object and allow it to perform self initialization
+		_components.push_back(component);
+		_RebuildComponentSlots();
+		component->OnLoad();
+
+		if (component->_HasScheduleRequests()) {
+			_scene->_OnScheduleChanged(component.get());
+		}
+	}
+
 	nlohmann::json GameObject::ToJson() const {
+		nlohmann::json result = _ToJsonWithoutChildren();
+		result["children"] = std::vector<nlohmann::json>();
+		for (auto& child : _children) {
+			GameObject::Sptr childPtr = child;
+			if (childPtr != nullptr) {
+				result["children"].push_back(childPtr->ToJson());
+			}
+		}
+		return result;
+	}
+
+	nlohmann::json GameObject::_ToJsonWithoutChildren() const {
 		GameObject::Sptr parent = _parent;
 		nlohmann::json result = {
 			{ "name", Name },
@@ -493,20 +697,14 @@ namespace Gameplay {
 			{ "rotation", _rotation },
 			{ "scale",    _scale },
 			{ "parent",   parent == nullptr ? "null" : parent->_guid.str() },
-			{ "hide_in_inspector", HideInHierarchy }
+			{ "hide_in_inspector", HideInHierarchy },
+			{ "active", _isActive }
 		};
 		result["components"] = nlohmann::json();
 		for (auto& component : _components) {
 			result["components"][component->ComponentTypeName()] = component->ToJson();
 			IComponent::SaveBaseJson(component, result["components"][component->ComponentTypeName()]);
 		}
-		result["children"] = std::vector<nlohmann::json>();
-		for (auto& child : _children) {
-			GameObject::Sptr childPtr = child;
-			if (childPtr != nullptr) {
-				result["children"].push_back(childPtr->ToJson());
-			}
-		}
 		return result;
 	}
 
@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <limits>
 
 // Utils
 #include "Utils/GUID.hpp"
@@ -11,6 +12,8 @@
 // Others
 #include "Gameplay/Components/IComponent.h"
 #include "Gameplay/Components/ComponentManager.h"
+#include "Gameplay/TransformHierarchy.h"
+#include "Gameplay/SceneBinary.h"
 #include "Utils/ResourceManager/IResource.h"
 
 class InspectorWindow;
@@ -215,16 +218,18 @@ namespace Gameplay {
 		/// <summary>
 		/// Gets or recalculates and gets the object's world transform
 		/// This matrix transforms points from local space to world space
+		/// 
+		/// Transforms are returned by value, since the scene's transform storage moves when objects are added
 		/// </summary>
-		const glm::mat4& GetTransform() const;
+		glm::mat4 GetTransform() const;
 		/// <summary>
 		/// Gets or recalculates the inverse of this object's world transform
 		/// This matrix transforms points from world space to local space
 		/// </summary>
-		const glm::mat4& GetInverseTransform() const;
+		glm::mat4 GetInverseTransform() const;
 
-		const glm::mat4& GetLocalTransform() const;
-		const glm::mat4& GetInverseLocalTransform() const;
+		glm::mat4 GetLocalTransform() const;
+		glm::mat4 GetInverseLocalTransform() const;
 
 		/// <summary>
 		/// Allows components to render GUI elements to the screen
@@ -236,16 +241,47 @@ namespace Gameplay {
 		/// </summary>
 		Scene* GetScene() const;
 
+		/// <summary>
+		/// Activates or deactivates this object. Inactive objects are not updated, and their components
+		/// are skipped by ComponentManager::Each, so they are not rendered or simulated. Note that this
+		/// does not affect child objects
+		/// </summary>
+		/// <param name="isActive">True to activate the object, false to deactivate it</param>
+		void SetActive(bool isActive);
+		/// <summary>
+		/// Gets whether this object is active, see SetActive
+		/// </summary>
+		bool IsActive() const;
+
+		/// <summary>
+		/// Flags this object as changed since the scene's checkpoints, so that it is included in
+		/// the next delta save (see Scene::SaveDelta). Transform, active state, parent and component
+		/// changes, renames, as well as edits in the editor, are picked up automatically. Call this after
+		/// changing HideInHierarchy or a component's fields from code
+		/// </summary>
+		void MarkChanged();
+		/// <summary>
+		/// Returns true if this object has changed since the scene was last saved
+		/// </summary>
+		bool HasUnsavedChanges() const;
+
 		/// <summary>
 		/// Notify all enabled components in this gameObject that the scene has been loaded
 		/// </summary>
 		void Awake();
 
 		/// <summary>
-		/// Calls update on all enabled components in this object
+		/// Calls update on all enabled components in this object that have not opted
+		/// into thread safe updates
 		/// </summary>
 		/// <param name="deltaTime">The time since the last frame, in seconds</param>
 		void Update(float dt);
+		/// <summary>
+		/// Calls update on all enabled components in this object that have opted into
+		/// thread safe updates. The scene invokes this from worker threads
+		/// </summary>
+		/// <param name="deltaTime">The time since the last frame, in seconds</param>
+		void UpdateThreadSafe(float dt);
 
 		/// <summary>
 		/// Checks whether this gameobject has a component of the given type
@@ -253,14 +289,7 @@ namespace Gameplay {
 		/// <typeparam name="T">The type of component to search for</typeparam>
 		template <typename T, typename = typename std::enable_if<std::is_base_of<IComponent, T>::value>::type>
 		bool Has() {
-			// Iterate over all the pointers in the components list
-			for (const auto& ptr : _components) {
-				// If the pointer type matches T, we return true
-				if (std::type_index(typeid(*ptr.get())) == std::type_index(typeid(T))) {
-					return true;
-				}
-			}
-			return false;
+			return _HasTypeId(ComponentManager::GetTypeId<T>());
 		}
 
 		bool Has(const std::type_index& type);
@@ -271,14 +300,12 @@ namespace Gameplay {
 		/// <typeparam name="T">The type of component to search for</typeparam>
 		template <typename T, typename = typename std::enable_if<std::is_base_of<IComponent, T>::value>::type>
 		std::shared_ptr<T> Get() {
-			// Iterate over all the pointers in the binding list
-			for (const auto& ptr : _components) {
-				// If the pointer type matches T, we return that behaviour, making sure to cast it back to the requested type
-				if (std::type_index(typeid(*ptr.get())) == std::type_index(typeid(T))) {
-					return std::dynamic_pointer_cast<T>(ptr);
-				}
+			uint32_t typeId = ComponentManager::GetTypeId<T>();
+			if (!_HasTypeId(typeId)) {
+				return nullptr;
 			}
-			return nullptr;
+			// The slot only ever holds a component of exactly this type, so a static cast is safe
+			return std::static_pointer_cast<T>(_components[_componentSlots[_SlotIndex(typeId)]]);
 		}
 
 		std::shared_ptr<IComponent> Get(const std::type_index& type);
@@ -294,18 +321,21 @@ namespace Gameplay {
 			static_assert(is_valid_component<T>(), "Type is not a valid component type!");
 			LOG_ASSERT(!Has<T>(), "Cannot add 2 instances of a component type to a game object");
 
+			// During the scene's parallel update the component can't be attached yet, the scene
+			// will attach it (and invoke OnLoad) once all the worker threads are done
+			if (_scene->IsInParallelUpdate()) {
+				std::shared_ptr<T> component = _scene->Components()._CreateDetached<T>(std::forward<TArgs>(args)...);
+				component->_context = this;
+				return std::static_pointer_cast<T>(_scene->_DeferAddComponent(component));
+			}
+
 			// Make a new component, forwarding the arguments
 			std::shared_ptr<T> component = _scene->Components().Create<T>(std::forward<TArgs>(args)...);
 			// Let the component know we are the parent
 			component->_context = this;
 
 			// Append it to the binding component's storage, and invoke the OnLoad
-			_components.push_back(component);
-			component->OnLoad();
-
-			if (_scene->GetIsAwake()) {
-				component->Awake();
-			}
+			_AttachComponent(component);
 
 			return component;
 		}
@@ -333,11 +363,21 @@ namespace Gameplay {
 		/// Converts this object into it's JSON representation for storage
 		/// </summary>
 		nlohmann::json ToJson() const;
+		/// <summary>
+		/// Loads a game object from an object record in a binary scene
+		/// </summary>
+		static GameObject::Sptr FromBinary(Scene* scene, const SceneBinary::Reader& reader, const SceneBinary::ObjectRecord& record);
+		/// <summary>
+		/// Appends this object (but not its children) to a binary scene
+		/// </summary>
+		void ToBinary(SceneBinary::Writer& writer) const;
 
 	private:
 		friend class Scene;
+		friend class Prefab;
 		friend class InspectorWindow;
 		friend class HierarchyWindow;
+		friend class TransformHierarchy;
 
 		// Rotation of the object as a quaternion
 		glm::quat _rotation;
@@ -346,14 +386,13 @@ namespace Gameplay {
 		// The scale of the object
 		glm::vec3 _scale;
 
-		// The object's world transform
-		mutable glm::mat4 _localTransform;
-		mutable glm::mat4 _inverseLocalTransform;
-		mutable bool _isLocalTransformDirty;
-
-		mutable glm::mat4 _worldTransform;
-		mutable glm::mat4 _inverseWorldTransform;
-		mutable bool _isWorldTransformDirty;
+		// Our node in the scene's transform hierarchy, or InvalidNode if we haven't been added to the scene yet
+		uint32_t _transformIndex;
+		// Set when the position, rotation or scale has changed and the hierarchy has yet to pick it up
+		bool _isLocalTransformDirty;
+		// Used for GetTransform and friends when we don't have a node in the hierarchy
+		mutable glm::mat4 _detachedTransform;
+		mutable glm::mat4 _detachedInverseTransform;
 
 		// For the hierarchy
 		WeakRef _parent;
@@ -361,8 +400,45 @@ namespace Gameplay {
 
 		// The components that this game object has attached to it
 		std::vector<IComponent::Sptr> _components;
+		// Bit N is set when we have a component with type ID N (see ComponentManager::GetTypeId)
+		uint64_t _componentMask;
+		// Index of a component in _components. An object holds at most one component of each type, so
+		// this only needs to count up to the number of component types
+		typedef uint8_t ComponentSlot;
+		static_assert(ComponentManager::MaxComponentTypes - 1 <= std::numeric_limits<ComponentSlot>::max(), "ComponentSlot is too small to index every component type");
+		// One entry per set bit in _componentMask, in type ID order, holding the index of that
+		// component in _components. The slot for a type is the number of set bits below its ID
+		std::vector<ComponentSlot> _componentSlots;
+		// The components that need to be invoked for each phase, in the same order as _components.
+		// Components whose type does not override the phase's methods are left out entirely, so
+		// we don't pay for empty virtual calls (see ComponentManager::HasUpdate and HasGui)
+		std::vector<IComponent*> _updateComponents;
+		std::vector<IComponent*> _threadSafeUpdateComponents;
+		std::vector<IComponent*> _guiComponents;
+		// Set when the lists above are out of date. They're only rebuilt before or after we loop over them,
+		// so that components added from inside Update or RenderGUI can't shift the list under the loop
+		bool _areComponentListsDirty;
 		std::weak_ptr<GameObject> _selfRef;
 
+		// The name that the scene's name lookup has us under, when it no longer matches Name we have been
+		// renamed (see Scene::_SyncObjectNames)
+		std::string _indexedName;
+		// When we were added to the name lookup, so that FindObjectByName can pick the oldest object
+		uint64_t    _indexOrder;
+
+		bool _isActive;
+		// Set by Scene::RemoveGameObject, the object will be removed at the next flush
+		bool _isPendingRemoval;
+		// One bit per scene checkpoint (see Scene::Checkpoint), set when anything that gets saved has changed
+		// since that checkpoint
+		uint8_t _unsavedCheckpoints;
+		// One bit per scene checkpoint, set when we have been created since that checkpoint, so removing us
+		// again isn't a change
+		uint8_t _newSinceCheckpoints;
+		static constexpr uint8_t AllCheckpoints = 0xFF;
+		// The name of the scene object pool we belong to, or empty if we were not created by a pool
+		std::string _objectPool;
+
 		// Pointer to the scene, we use raw pointers since 
 		// this will always be set by the scene on creation
 		// or load, we don't need to worry about ref counting
@@ -373,11 +449,67 @@ namespace Gameplay {
 		/// </summary>
 		GameObject();
 
-		// Recalculates the transform matrix for the object when required
-		void _RecalcLocalTransform() const;
-		void _RecalcWorldTransform() const;
+		/// <summary>
+		/// Lets the scene's transform hierarchy know that our position, rotation or scale has changed,
+		/// should be called after any changes to _position, _rotation or _scale
+		/// </summary>
+		void _MarkTransformDirty();
+		/// <summary>
+		/// Calculates our local transform for when we don't have a node in the hierarchy
+		/// </summary>
+		const glm::mat4& _GetDetachedTransform() const;
 
 		void _PurgeDeletedChildren();
+
+		/// <summary>
+		/// Appends a component (that has already been added to the scene's component pools) to
+		/// this object, and invokes OnLoad and Awake as needed
+		/// </summary>
+		void _AttachComponent(const IComponent::Sptr& component);
+		/// <summary>
+		/// Removes the component at the given index in _components, cancelling any of its pending
+		/// updates or timers so that they can't fire on a component that's no longer attached
+		/// </summary>
+		/// <param name="index">The index of the component to remove</param>
+		void _RemoveComponentAt(size_t index);
+		/// <summary>
+		/// Loads a component from its JSON and appends it to this object while loading, without
+		/// invoking Awake
+		/// </summary>
+		void _LoadComponent(const std::string& typeName, const nlohmann::json& blob);
+		/// <summary>
+		/// Appends a component that has just been loaded (and added to the scene's component pools) to
+		/// this object while loading, without invoking Awake
+		/// </summary>
+		void _AddLoadedComponent(const IComponent::Sptr& component);
+		/// <summary>
+		/// Converts this object into its JSON representation, without the nested copies of its
+		/// children (objects are linked to their parents by GUID, so the children are not needed to load)
+		/// </summary>
+		nlohmann::json _ToJsonWithoutChildren() const;
+
+		/// <summary>
+		/// Re-creates the component mask and slots from _components, and flags the per-phase component
+		/// lists to be rebuilt. Must be called whenever components are added or removed
+		/// </summary>
+		void _RebuildComponentSlots();
+		/// <summary>
+		/// Re-creates the per-phase component lists from _components if they are flagged as dirty
+		/// </summary>
+		void _RebuildComponentLists();
+
+		inline bool _HasTypeId(uint32_t typeId) const {
+			return typeId < ComponentManager::MaxComponentTypes && (_componentMask >> typeId) & 1;
+		}
+
+		inline uint32_t _SlotIndex(uint32_t typeId) const {
+			// Count the set bits below our type's bit
+			uint64_t bits = _componentMask & ((uint64_t(1) << typeId) - 1);
+			bits = bits - ((bits >> 1) & 0x5555555555555555ull);
+			bits = (bits & 0x3333333333333333ull) + ((bits >> 2) & 0x3333333333333333ull);
+			bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+			return static_cast<uint32_t>((bits * 0x0101010101010101ull) >> 56);
+		}
 	};
 
 }
\ No newline at end of file
@@ -85,6 +85,7 @@ namespace Gameplay {
 		/// Converts this material into it's JSON representation for storage
 		/// </summary>
 		nlohmann::json ToJson() const;
+		virtual bool IsReloadable() const override { return true; }
 
 	protected:
 		/// <summary>
@@ -2,8 +2,11 @@
 #include <filesystem>
 
 #include "Utils/ObjLoader.h"
+#include "Utils/FileHelpers.h"
 
 namespace Gameplay {
+	PreloadCache<MeshBuilder<MeshResource::VertexType>> MeshResource::_preloadedMeshes;
+
 	MeshResource::MeshResource() :
 		IResource(),
 		Filename(""),
@@ -19,7 +22,11 @@ namespace Gameplay {
 		Mesh(nullptr),
 		BulletTriMesh(nullptr)
 	{
-		Mesh = ObjLoader::LoadFromFile(filename);
+		Mesh = _LoadFile(filename);
+	}
+
+	std::string MeshResource::GetSourceKey(const std::string& filename) {
+		return FileHelpers::NormalizePath(filename);
 	}
 
 	MeshResource::~MeshResource() = default;
@@ -44,7 +51,7 @@ namespace Gameplay {
 		MeshResource::Sptr result = std::make_shared<MeshResource>();
 		if (blob.contains("params") && blob["params"].is_array()) {
 			std::vector<nlohmann::json> meshbuilderParams = blob["params"].get<std::vector<nlohmann::json>>();
-			MeshBuilder<VertexPosNormTexColTangents> mesh;
+			MeshBuilder<VertexType> mesh;
 			for (int ix = 0; ix < meshbuilderParams.size(); ix++) {
 				MeshBuilderParam p = MeshBuilderParam::FromJson(meshbuilderParams[ix]);
 				result->MeshBuilderParams.push_back(p);
@@ -54,20 +61,24 @@ namespace Gameplay {
 			result->Mesh = mesh.Bake();
 		} else {
 			result->Filename = JsonGet<std::string>(blob, "filename", "null");
-			if (result->Filename != "null" && std::filesystem::exists(result->Filename)) {
-				#ifdef OPTIMIZED_OBJ_LOADER
-				result->Mesh = OptimizedObjLoader::LoadFromFile(result->Filename);
-				#else
-				result->Mesh = ObjLoader::LoadFromFile(result->Filename);
-				#endif
-
+			if (result->Filename != "null" && FileHelpers::Exists(result->Filename)) {
+				result->Mesh = _LoadFile(result->Filename);
 			}
 		}
 		return result;
 	}
 
+	size_t MeshResource::GetGpuMemoryUsage() const {
+		return Mesh != nullptr ? Mesh->GetBufferMemoryUsage() : 0;
+	}
+
+	bool MeshResource::IsReloadable() const {
+		// Meshes built at runtime without builder params (ex: from code) can't be recreated
+		return !MeshBuilderParams.empty() || (!Filename.empty() && Filename != "null");
+	}
+
 	void MeshResource::GenerateMesh() {
-		MeshBuilder<VertexPosNormTexColTangents> mesh;
+		MeshBuilder<VertexType> mesh;
 		for (auto& param : MeshBuilderParams) {
 			MeshFactory::AddParameterized(mesh, param);
 		}
@@ -78,4 +89,42 @@ namespace Gameplay {
 	void MeshResource::AddParam(const MeshBuilderParam & param) {
 		MeshBuilderParams.push_back(param);
 	}
+
+	void MeshResource::PreloadFile(const std::string& filename) {
+		#ifndef OPTIMIZED_OBJ_LOADER
+		// The optimized loader reads pre-converted binary files, which are already cheap enough to load
+		try {
+			_preloadedMeshes.Store(filename, std::make_unique<MeshBuilder<VertexType>>(ObjLoader::LoadMeshFromFile<VertexType>(filename)));
+		}
+		catch (const std::runtime_error& e) {
+			LOG_WARN("Failed to preload mesh \"{}\": {}", filename, e.what());
+		}
+		#endif
+	}
+
+	void MeshResource::Preload(const nlohmann::json& blob) {
+		// Generated meshes are cheap, and need the mesh factory on the main thread anyways
+		if (!blob.contains("params") && blob.contains("filename") && blob["filename"].is_string()) {
+			std::string filename = blob["filename"].get<std::string>();
+			if (filename != "null" && FileHelpers::Exists(filename)) {
+				PreloadFile(filename);
+			}
+		}
+	}
+
+	void MeshResource::ClearPreloadedFiles() {
+		_preloadedMeshes.Clear();
+	}
+
+	VertexArrayObject::Sptr MeshResource::_LoadFile(const std::string& filename) {
+		#ifdef OPTIMIZED_OBJ_LOADER
+		return OptimizedObjLoader::LoadFromFile(filename);
+		#else
+		std::unique_ptr<MeshBuilder<VertexType>> mesh = _preloadedMeshes.Take(filename);
+		if (mesh != nullptr) {
+			return mesh->Bake();
+		}
+		return ObjLoader::LoadFromFile<VertexType>(filename);
+		#endif
+	}
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "Utils/ResourceManager/IResource.h"
 #include "Graphics/VertexArrayObject.h"
 #include "Utils/MeshFactory.h"
+#include "Utils/PreloadCache.h"
 
 // bullet triangle mesh pre-declaration
 class btTriangleMesh;
@@ -15,6 +16,11 @@ namespace Gameplay {
 	class MeshResource : public IResource {
 	public:
 		typedef std::shared_ptr<MeshResource> Sptr;
+		/// <summary>
+		/// The vertex type that mesh resources are built with. Packed, so that each vertex takes up 32 bytes
+		/// on the GPU instead of 72
+		/// </summary>
+		typedef VertexPosNormTexColTangentsPacked VertexType;
 
 		// Default constructor
 		MeshResource();
@@ -24,6 +30,11 @@ namespace Gameplay {
 		/// <param name="filename"></param>
 		MeshResource(const std::string& filename);
 
+		/// <summary>
+		/// Gets the key that ResourceManager::CreateAsset uses to share meshes loaded from the same file
+		/// </summary>
+		static std::string GetSourceKey(const std::string& filename);
+
 		virtual ~MeshResource();
 
 		/// <summary>
@@ -65,5 +76,31 @@ namespace Gameplay {
 
 		virtual nlohmann::json ToJson() const override;
 		static MeshResource::Sptr FromJson(const nlohmann::json& blob);
+		virtual size_t GetGpuMemoryUsage() const override;
+		virtual bool IsReloadable() const override;
+
+		/// <summary>
+		/// Parses a mesh file into memory without touching OpenGL, so this is safe to call from a
+		/// worker thread. The next mesh resource that is loaded from the same file will only need
+		/// to upload the mesh instead of parsing the file again
+		/// </summary>
+		/// <param name="filename">The path of the mesh file to parse</param>
+		static void PreloadFile(const std::string& filename);
+		/// <summary>
+		/// Parses the mesh file for a mesh resource's manifest entry, if it has one. See PreloadFile
+		/// </summary>
+		static void Preload(const nlohmann::json& blob);
+		/// <summary>
+		/// Frees any preloaded meshes that were never used by a mesh resource
+		/// </summary>
+		static void ClearPreloadedFiles();
+
+	protected:
+		static PreloadCache<MeshBuilder<VertexType>> _preloadedMeshes;
+
+		/// <summary>
+		/// Creates the VAO for a mesh file, using the preloaded mesh if there is one
+		/// </summary>
+		static VertexArrayObject::Sptr _LoadFile(const std::string& filename);
 	};
 }
\ No newline at end of file
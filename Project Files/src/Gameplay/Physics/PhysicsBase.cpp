@@ -116,11 +116,13 @@ int PhysicsBase::_editorSelectedColliderType = 0;
 
 
 	void PhysicsBase::SetCollisionGroup(int value) {
+		MarkChanged();
 		_collisionGroup = 1 << value;
 		_isGroupMaskDirty = true;
 	}
 
 	void PhysicsBase::SetCollisionGroupMulti(int value) {
+		MarkChanged();
 		_collisionGroup   = value;
 		_isGroupMaskDirty = true;
 	}
@@ -130,6 +132,7 @@ int PhysicsBase::_editorSelectedColliderType = 0;
 	}
 
 	void PhysicsBase::SetCollisionMask(int value) {
+		MarkChanged();
 		_collisionMask = value;
 		_isGroupMaskDirty = true;
 	}
@@ -139,6 +142,7 @@ int PhysicsBase::_editorSelectedColliderType = 0;
 	}
 
 	ICollider::Sptr PhysicsBase::AddCollider(const ICollider::Sptr& collider) {
+		MarkChanged();
 		if (_scene != nullptr) {
 			collider->Awake(GetGameObject());
 		}
@@ -148,6 +152,7 @@ int PhysicsBase::_editorSelectedColliderType = 0;
 	}
 
 	void PhysicsBase::RemoveCollider(const ICollider::Sptr& collider) {
+		MarkChanged();
 		auto& it = std::find(_colliders.begin(), _colliders.end(), collider);
 		if (it != _colliders.end()) {
 			if (collider->GetShape() != nullptr) {
@@ -201,6 +206,11 @@ int PhysicsBase::_editorSelectedColliderType = 0;
 			}
 		}
 
+		// Colliders are saved with us, so a rebuilt shape means our state has changed
+		if (wasDirty) {
+			_BumpStateVersion();
+		}
+
 		return wasDirty;
 	}
 
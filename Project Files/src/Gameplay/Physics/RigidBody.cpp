@@ -43,6 +43,7 @@ namespace Gameplay::Physics {
 	}
 
 	void RigidBody::SetMass(float value) {
+		MarkChanged();
 		if (_type != RigidBodyType::Static) {
 			_isMassDirty = value != _mass;
 			_mass = value;
@@ -54,6 +55,7 @@ namespace Gameplay::Physics {
 	}
 
 	void RigidBody::SetLinearDamping(float value) {
+		MarkChanged();
 		_linearDamping = value;
 		_isDampingDirty = true;
 	}
@@ -63,6 +65,7 @@ namespace Gameplay::Physics {
 	}
 
 	void RigidBody::SetAngularDamping(float value) {
+		MarkChanged();
 		_angularDamping = value;
 		_isDampingDirty = true;
 	}
@@ -125,6 +128,7 @@ namespace Gameplay::Physics {
 	}
 
 	void RigidBody::SetType(RigidBodyType type) {
+		MarkChanged();
 		_type = type;
 		if (_body != nullptr) {
 			// Remove any static or kinematic flags for the object
@@ -244,6 +248,62 @@ namespace Gameplay::Physics {
 		// Copy over group and mask info
 		_body->getBroadphaseProxy()->m_collisionFilterGroup = _collisionGroup;
 		_body->getBroadphaseProxy()->m_collisionFilterMask  = _collisionMask;
+
+		// Inactive objects stay out of the world until they are activated
+		if (!context->IsActive()) {
+			_scene->GetPhysicsWorld()->removeRigidBody(_body);
+		}
+	}
+
+	void RigidBody::OnActiveChanged(bool isActive) {
+		// If we haven't been awoken yet, there's no body to add or remove
+		if (_body == nullptr) {
+			return;
+		}
+
+		if (isActive) {
+			_scene->GetPhysicsWorld()->addRigidBody(_body);
+			_body->getBroadphaseProxy()->m_collisionFilterGroup = _collisionGroup;
+			_body->getBroadphaseProxy()->m_collisionFilterMask  = _collisionMask;
+
+			// Start again from wherever the object was placed while inactive, with no leftover motion
+			btTransform transform;
+			_CopyGameobjectTransformTo(transform);
+			_body->setWorldTransform(transform);
+			_motionState->setWorldTransform(transform);
+			_body->setLinearVelocity(btVector3(0.0f, 0.0f, 0.0f));
+			_body->setAngularVelocity(btVector3(0.0f, 0.0f, 0.0f));
+			_body->clearForces();
+			_body->activate(true);
+		} else {
+			_scene->GetPhysicsWorld()->removeRigidBody(_body);
+		}
+	}
+
+	void RigidBody::OnRestored() {
+		// Our config was saved, but anything we picked up while playing was not
+		_linearVelocity = btVector3(0.0f, 0.0f, 0.0f);
+		_angularVelocity = btVector3(0.0f, 0.0f, 0.0f);
+		_linearVelocityDirty = false;
+		_angularVelocityDirty = false;
+
+		if (_body == nullptr) {
+			return;
+		}
+
+		// Put the body back where the object has been restored to, with no leftover motion
+		btTransform transform;
+		_CopyGameobjectTransformTo(transform);
+		_body->setWorldTransform(transform);
+		_body->setInterpolationWorldTransform(transform);
+		_motionState->setWorldTransform(transform);
+		_body->setLinearVelocity(btVector3(0.0f, 0.0f, 0.0f));
+		_body->setAngularVelocity(btVector3(0.0f, 0.0f, 0.0f));
+		_body->clearForces();
+		if (GetGameObject()->IsActive()) {
+			_scene->GetPhysicsWorld()->updateSingleAabb(_body);
+			_body->activate(true);
+		}
 	}
 
 	void RigidBody::RenderImGui()
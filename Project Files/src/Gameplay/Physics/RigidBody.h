@@ -31,6 +31,8 @@ namespace Gameplay::Physics {
 	class RigidBody : public PhysicsBase {
 	public:
 		typedef std::shared_ptr<RigidBody> Sptr;
+		// Keeping our body when restoring a snapshot saves re-creating it in Bullet, see OnRestored
+		static constexpr bool RestoreInPlace = true;
 
 		RigidBody(RigidBodyType type = RigidBodyType::Static);
 		virtual ~RigidBody();
@@ -167,6 +169,8 @@ namespace Gameplay::Physics {
 
 		// Inherited from IComponent
 		virtual void Awake() override;
+		virtual void OnActiveChanged(bool isActive) override;
+		virtual void OnRestored() override;
 		virtual void RenderImGui() override;
 		virtual nlohmann::json ToJson() const override;
 		static RigidBody::Sptr FromJson(const nlohmann::json& data);
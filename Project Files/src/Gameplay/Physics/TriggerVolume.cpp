@@ -173,6 +173,43 @@ namespace Gameplay::Physics {
 		// Copy over group and mask info
 		_ghost->getBroadphaseHandle()->m_collisionFilterGroup = _collisionGroup;
 		_ghost->getBroadphaseHandle()->m_collisionFilterMask  = _collisionMask;
+
+		// Inactive objects stay out of the world until they are activated
+		if (!context->IsActive()) {
+			_scene->GetPhysicsWorld()->removeCollisionObject(_ghost);
+		}
+	}
+
+	void TriggerVolume::OnActiveChanged(bool isActive) {
+		// If we haven't been awoken yet, there's no ghost to add or remove
+		if (_ghost == nullptr) {
+			return;
+		}
+
+		if (isActive) {
+			_scene->GetPhysicsWorld()->addCollisionObject(_ghost);
+			_ghost->getBroadphaseHandle()->m_collisionFilterGroup = _collisionGroup;
+			_ghost->getBroadphaseHandle()->m_collisionFilterMask  = _collisionMask;
+
+			btTransform transform;
+			_CopyGameobjectTransformTo(transform);
+			_ghost->setWorldTransform(transform);
+		} else {
+			_scene->GetPhysicsWorld()->removeCollisionObject(_ghost);
+			// Forget what we were touching, so nothing leaks into the object's next life
+			_currentCollisions.clear();
+		}
+	}
+
+	void TriggerVolume::OnRestored() {
+		// Anything that was inside of us while playing may not be anymore
+		_currentCollisions.clear();
+
+		if (_ghost != nullptr) {
+			btTransform transform;
+			_CopyGameobjectTransformTo(transform);
+			_ghost->setWorldTransform(transform);
+		}
 	}
 
 	void TriggerVolume::RenderImGui() {
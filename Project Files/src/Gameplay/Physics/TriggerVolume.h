@@ -23,6 +23,8 @@ namespace Gameplay::Physics {
 		typedef std::function<void(const std::shared_ptr<RigidBody>& obj)> TriggerCallback;
 
 		typedef std::shared_ptr<TriggerVolume> Sptr;
+		// Keeping our ghost object when restoring a snapshot saves re-creating it in Bullet, see OnRestored
+		static constexpr bool RestoreInPlace = true;
 		virtual ~TriggerVolume();
 		TriggerVolume();
 
@@ -45,6 +47,8 @@ namespace Gameplay::Physics {
 		// Inherited from IComponent
 
 		virtual void Awake() override;
+		virtual void OnActiveChanged(bool isActive) override;
+		virtual void OnRestored() override;
 		virtual void RenderImGui() override;
 		virtual nlohmann::json ToJson() const override;
 		static TriggerVolume::Sptr FromJson(const nlohmann::json& data);
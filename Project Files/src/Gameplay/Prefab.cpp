@@ -0,0 +1,217 @@
+#include "Gameplay/Prefab.h"
+#include <unordered_map>
+#include <functional>
+
+#include "Logging.h"
+#include "Utils/JsonGlmHelpers.h"
+#include "Gameplay/Scene.h"
+#include "Gameplay/Components/ComponentManager.h"
+
+namespace Gameplay {
+	Prefab::Prefab() :
+		IResource(),
+		Name("Unknown"),
+		_objects(std::vector<ObjectTemplate>()),
+		_components(std::vector<ComponentTemplate>()),
+		_guids(std::vector<Guid>())
+	{ }
+
+	Prefab::Sptr Prefab::Create(const GameObject::Sptr& root) {
+		Prefab::Sptr result = std::make_shared<Prefab>();
+		result->Name = root->Name;
+		// This is the only time we go through JSON, since it's the only way to get at a component's data
+		result->_AddObject(root->ToJson(), -1);
+		result->_ResolveReferences();
+		return result;
+	}
+
+	GameObject::Sptr Prefab::Instantiate(Scene* scene, const GameObject::Sptr& parent) const {
+		LOG_ASSERT(!scene->IsInParallelUpdate(), "Prefabs can only be instantiated from the main thread!");
+		if (_objects.empty()) {
+			return nullptr;
+		}
+
+		// Every object and component in the copy gets a new identity, in the same layout as _guids
+		std::vector<Guid> guids(_guids.size());
+		for (Guid& guid : guids) {
+			guid = Guid::New();
+		}
+
+		std::vector<GameObject::Sptr> objects(_objects.size());
+		for (size_t ix = 0; ix < _objects.size(); ix++) {
+			const ObjectTemplate& data = _objects[ix];
+
+			GameObject::Sptr object(new GameObject());
+			object->_scene = scene;
+			object->Name = data.Name;
+			object->OverrideGUID(guids[ix]);
+			object->_position = data.Position;
+			object->_rotation = data.Rotation;
+			object->_scale    = data.Scale;
+			object->HideInHierarchy = data.HideInHierarchy;
+			object->_isActive = data.IsActive;
+			object->_isLocalTransformDirty = true;
+			scene->_AddLoadedObject(object);
+
+			for (uint32_t componentIx = data.FirstComponent; componentIx < data.FirstComponent + data.NumComponents; componentIx++) {
+				const ComponentTemplate& component = _components[componentIx];
+
+				// Only components that refer to other parts of the prefab need their own copy of the data
+				const nlohmann::json* blob = &component.Blob;
+				nlohmann::json patched;
+				if (!component.References.empty()) {
+					patched = component.Blob;
+					for (const auto& [pointer, guidIx] : component.References) {
+						patched[pointer] = guids[guidIx].str();
+					}
+					blob = &patched;
+				}
+
+				IComponent::Sptr result = scene->Components().Instantiate(component.Type, *blob, guids[_objects.size() + componentIx]);
+				if (result != nullptr) {
+					object->_AddLoadedComponent(result);
+				}
+			}
+
+			// Parents always come first, so they're already in the scene
+			if (data.Parent >= 0) {
+				objects[data.Parent]->AddChild(object);
+			} else if (parent != nullptr) {
+				parent->AddChild(object);
+			}
+
+			objects[ix] = std::move(object);
+		}
+
+		// Same as adding components at runtime, components can find each other now that everything exists
+		if (scene->GetIsAwake()) {
+			for (const auto& object : objects) {
+				object->Awake();
+			}
+		}
+
+		return objects[0];
+	}
+
+	Prefab::Sptr Prefab::FromJson(const nlohmann::json& data) {
+		Prefab::Sptr result = std::make_shared<Prefab>();
+		result->Name = JsonGet<std::string>(data, "name", "Unknown");
+		if (data.contains("root") && data["root"].is_object()) {
+			result->_AddObject(data["root"], -1);
+			result->_ResolveReferences();
+		} else {
+			LOG_WARN("Prefab \"{}\" has no root object", result->Name);
+		}
+		return result;
+	}
+
+	nlohmann::json Prefab::ToJson() const {
+		nlohmann::json result = {
+			{ "name", Name }
+		};
+		if (!_objects.empty()) {
+			result["root"] = _ObjectToJson(0);
+		}
+		return result;
+	}
+
+	void Prefab::_AddObject(const nlohmann::json& data, int32_t parent) {
+		int32_t index = static_cast<int32_t>(_objects.size());
+
+		ObjectTemplate object;
+		object.Name            = JsonGet<std::string>(data, "name", "Unknown");
+		object.Position        = data["position"];
+		object.Rotation        = data["rotation"];
+		object.Scale           = data["scale"];
+		object.IsActive        = JsonGet(data, "active", true);
+		object.HideInHierarchy = JsonGet(data, "hide_in_inspector", false);
+		object.Parent          = parent;
+		object.FirstComponent  = static_cast<uint32_t>(_components.size());
+		object.NumComponents   = 0;
+
+		// Object GUIDs come first in _guids, component GUIDs are added after them in _ResolveReferences
+		_guids.push_back(Guid(data["guid"]));
+
+		if (data.contains("components") && data["components"].is_object()) {
+			for (auto& [typeName, blob] : data["components"].items()) {
+				std::optional<std::type_index> type = ComponentManager::FindType(typeName);
+				if (!type.has_value()) {
+					LOG_WARN("Unknown component type \"{}\" on object \"{}\" in prefab \"{}\", skipping", typeName, object.Name, Name);
+					continue;
+				}
+				_components.push_back({ type.value(), typeName, blob, {} });
+				object.NumComponents++;
+			}
+		}
+		_objects.push_back(object);
+
+		if (data.contains("children") && data["children"].is_array()) {
+			for (const auto& child : data["children"]) {
+				_AddObject(child, index);
+			}
+		}
+	}
+
+	void Prefab::_ResolveReferences() {
+		for (const auto& component : _components) {
+			_guids.push_back(Guid(component.Blob["guid"]));
+		}
+
+		std::unordered_map<std::string, uint32_t> indices;
+		for (uint32_t ix = 0; ix < _guids.size(); ix++) {
+			indices[_guids[ix].str()] = ix;
+		}
+
+		// Anything in a component's data that looks like the GUID of something in the prefab is a reference
+		// to it. The component's own GUID is skipped, since Instantiate gives it a new one when it's loaded
+		for (auto& component : _components) {
+			component.References.clear();
+			std::function<void(const nlohmann::json&, const nlohmann::json::json_pointer&)> search =
+				[&](const nlohmann::json& value, const nlohmann::json::json_pointer& pointer) {
+				if (value.is_string()) {
+					auto it = indices.find(value.get<std::string>());
+					if (it != indices.end() && pointer != nlohmann::json::json_pointer("/guid")) {
+						component.References.push_back({ pointer, it->second });
+					}
+				} else if (value.is_object()) {
+					for (auto& [key, item] : value.items()) {
+						search(item, pointer / key);
+					}
+				} else if (value.is_array()) {
+					for (size_t ix = 0; ix < value.size(); ix++) {
+						search(value[ix], pointer / ix);
+					}
+				}
+			};
+			search(component.Blob, nlohmann::json::json_pointer());
+		}
+	}
+
+	nlohmann::json Prefab::_ObjectToJson(size_t index) const {
+		const ObjectTemplate& data = _objects[index];
+		nlohmann::json result = {
+			{ "name", data.Name },
+			{ "guid", _guids[index].str() },
+			{ "position", data.Position },
+			{ "rotation", data.Rotation },
+			{ "scale", data.Scale },
+			{ "parent", data.Parent >= 0 ? _guids[data.Parent].str() : "null" },
+			{ "hide_in_inspector", data.HideInHierarchy },
+			{ "active", data.IsActive }
+		};
+
+		result["components"] = nlohmann::json::object();
+		for (uint32_t ix = data.FirstComponent; ix < data.FirstComponent + data.NumComponents; ix++) {
+			result["components"][_components[ix].TypeName] = _components[ix].Blob;
+		}
+
+		// Children always come after their parent
+		result["children"] = std::vector<nlohmann::json>();
+		for (size_t ix = index + 1; ix < _objects.size(); ix++) {
+			if (_objects[ix].Parent == static_cast<int32_t>(index)) {
+				result["children"].push_back(_ObjectToJson(ix));
+			}
+		}
+		return result;
+	}
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <typeindex>
+
+#include "json.hpp"
+#include "GLM/glm.hpp"
+#include "GLM/gtc/quaternion.hpp"
+#include "Utils/ResourceManager/IResource.h"
+#include "Gameplay/GameObject.h"
+
+namespace Gameplay {
+	class Scene;
+
+	/// <summary>
+	/// A template for a game object and all of its children, that can be stamped out into a scene
+	/// any number of times with Instantiate
+	///
+	/// The template is parsed and resolved once, when the prefab is created. Component types are
+	/// looked up ahead of time, and any place in a component's data that refers to another object
+	/// or component in the prefab is found up front, so that each copy can be pointed at its own
+	/// objects rather than the template's. Instantiating never parses JSON text or walks the
+	/// template looking for references
+	/// </summary>
+	class Prefab : public IResource {
+	public:
+		typedef std::shared_ptr<Prefab> Sptr;
+
+		/// <summary>
+		/// A human readable name for the prefab
+		/// </summary>
+		std::string Name;
+
+		Prefab();
+		virtual ~Prefab() = default;
+
+		/// <summary>
+		/// Creates a prefab from an object in a scene, along with all of its children. The prefab is a
+		/// copy, later changes to the object do not affect it
+		/// </summary>
+		/// <param name="root">The object to make a prefab of</param>
+		static Prefab::Sptr Create(const GameObject::Sptr& root);
+
+		/// <summary>
+		/// Creates a copy of the prefab's objects in the given scene. Every object and component in the
+		/// copy gets a new GUID, and references between objects in the prefab are pointed at the copies.
+		/// Must be called from the main thread
+		/// </summary>
+		/// <param name="scene">The scene to create the objects in</param>
+		/// <param name="parent">The object to parent the copy to, or nullptr to add it at the top level</param>
+		/// <returns>The copy of the prefab's root object</returns>
+		GameObject::Sptr Instantiate(Scene* scene, const GameObject::Sptr& parent = nullptr) const;
+
+		/// <summary>
+		/// Gets the number of objects created by each call to Instantiate
+		/// </summary>
+		size_t NumObjects() const { return _objects.size(); }
+
+		/// <summary>
+		/// Loads a prefab from a JSON blob, the objects are stored in the same format as scene files
+		/// </summary>
+		static Prefab::Sptr FromJson(const nlohmann::json& data);
+		/// <summary>
+		/// Converts this prefab into it's JSON representation for storage
+		/// </summary>
+		virtual nlohmann::json ToJson() const override;
+
+	protected:
+		struct ComponentTemplate {
+			// Resolved when the prefab is loaded, so that instantiating doesn't need to look up type names
+			std::type_index Type;
+			std::string     TypeName;
+			// The component's data, including the base IComponent fields
+			nlohmann::json  Blob;
+			// Places in the blob that hold the GUID of something in the prefab, and the index of that
+			// thing in _guids. Blobs with references are copied and patched for each instance
+			std::vector<std::pair<nlohmann::json::json_pointer, uint32_t>> References;
+		};
+
+		struct ObjectTemplate {
+			std::string Name;
+			glm::vec3   Position;
+			glm::quat   Rotation;
+			glm::vec3   Scale;
+			bool        IsActive;
+			bool        HideInHierarchy;
+			// Index of the parent in _objects, parents always come before their children. -1 for the root
+			int32_t     Parent;
+			// The range of this object's components in _components
+			uint32_t    FirstComponent;
+			uint32_t    NumComponents;
+		};
+
+		// Objects are stored in depth first order, starting with the root
+		std::vector<ObjectTemplate>    _objects;
+		std::vector<ComponentTemplate> _components;
+		// The template's GUIDs, one per object followed by one per component
+		std::vector<Guid>              _guids;
+
+		/// <summary>
+		/// Adds an object in the scene JSON format (with nested children) to the template, along with its children
+		/// </summary>
+		void _AddObject(const nlohmann::json& data, int32_t parent);
+		/// <summary>
+		/// Finds the references to objects and components within the prefab in all of the component blobs
+		/// </summary>
+		void _ResolveReferences();
+		/// <summary>
+		/// Converts the object at the given index back into the scene JSON format, with nested children
+		/// </summary>
+		nlohmann::json _ObjectToJson(size_t index) const;
+	};
+}
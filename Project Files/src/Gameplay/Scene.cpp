@@ -3,14 +3,19 @@
 #include <GLFW/glfw3.h>
 #include <locale>
 #include <codecvt>
+#include <unordered_set>
+#include <filesystem>
+#include <cstring>
 
 #include "Utils/FileHelpers.h"
 #include "Utils/GlmBulletConversions.h"
+#include "Utils/JobSystem.h"
 
 #include "Gameplay/Physics/RigidBody.h"
 #include "Gameplay/Physics/TriggerVolume.h"
 #include "Gameplay/MeshResource.h"
 #include "Gameplay/Material.h"
+#include "Gameplay/SceneDelta.h"
 
 #include "Graphics/DebugDraw.h"
 #include "Graphics/Textures/TextureCube.h"
@@ -20,12 +25,15 @@
 namespace Gameplay {
 	Scene::Scene() :
 		_objects(std::vector<GameObject::Sptr>()),
-		_deletionQueue(std::vector<std::weak_ptr<GameObject>>()),
+		_hasPendingDeletions(false),
+		_nextIndexOrder(0),
 		IsPlaying(false),
 		IsDestroyed(false),
 		MainCamera(nullptr),
 		DefaultMaterial(nullptr),
 		_isAwake(false),
+		_isInParallelUpdate(false),
+		_isInPhysicsStep(false),
 		_filePath(""),
 		_skyboxShader(nullptr),
 		_skyboxMesh(nullptr),
@@ -47,6 +55,11 @@ namespace Gameplay {
 		_skyboxShader = nullptr;
 		_skyboxMesh = nullptr;
 		_skyboxTexture = nullptr;
+		_objectsByGuid.clear();
+		_objectsByName.clear();
+		_transforms.Clear();
+		_scheduler.Clear();
+		_objectPools.clear();
 		_objects.clear();
 		_components.Clear();
 		_CleanupPhysics();
@@ -99,29 +112,170 @@ namespace Gameplay {
 		result->Name = name;
 		result->_scene = this;
 		result->_selfRef = result;
+
+		// Worker threads can't touch the object list, the object will be added when the parallel phase ends
+		if (_isInParallelUpdate) {
+			std::lock_guard<std::mutex> lock(_deferredMutex);
+			_deferredObjects.push_back(result);
+			return result;
+		}
+
 		_objects.push_back(result);
+		_IndexObject(result.get());
 		return result;
 	}
 
 	void Scene::RemoveGameObject(const GameObject::Sptr& object) {
-		_deletionQueue.push_back(object);
+		std::unique_lock<std::mutex> lock(_deferredMutex, std::defer_lock);
+		if (_isInParallelUpdate) {
+			lock.lock();
+		}
+		_QueueDeletion(object);
+	}
+
+	void Scene::_QueueDeletion(const GameObject::Sptr& object) {
+		// The same object may be removed more than once, or along with its parent
+		if (object == nullptr || object->_isPendingRemoval) {
+			return;
+		}
+		object->_isPendingRemoval = true;
+		_hasPendingDeletions = true;
+
 		for (const auto& child : object->_children) {
-			RemoveGameObject(child);
+			_QueueDeletion(child);
 		}
 	}
 
-	GameObject::Sptr Scene::FindObjectByName(const std::string name) const {
-		auto it = std::find_if(_objects.begin(), _objects.end(), [&](const GameObject::Sptr& obj) {
-			return obj->Name == name;
+	void Scene::RegisterObjectPool(const std::string& name, const PrefabBuilder& builder) {
+		_objectPools[name].Builder = builder;
+	}
+
+	bool Scene::HasObjectPool(const std::string& name) const {
+		return _objectPools.find(name) != _objectPools.end();
+	}
+
+	GameObject::Sptr Scene::AcquirePooledObject(const std::string& name, const glm::vec3& position, const glm::quat& rotation) {
+		LOG_ASSERT(!_isInParallelUpdate, "Cannot acquire pooled objects during the parallel update");
+
+		auto it = _objectPools.find(name);
+		if (it == _objectPools.end()) {
+			LOG_WARN("No object pool named \"{}\" has been registered", name);
+			return nullptr;
+		}
+		ObjectPool& pool = it->second;
+
+		GameObject::Sptr result;
+		if (!pool.Available.empty()) {
+			result = pool.Available.back();
+			pool.Available.pop_back();
+			pool.Stats.Available--;
+			pool.Stats.Reused++;
+			// Activating adds our bodies back to the physics world, so they need to be where we're spawning first
+			result->SetPostion(position);
+			result->SetRotation(rotation);
+			result->SetActive(true);
+		} else {
+			result = CreateGameObject(name);
+			result->_objectPool = name;
+			result->SetPostion(position);
+			result->SetRotation(rotation);
+			pool.Builder(result);
+		}
+
+		pool.Stats.Acquired++;
+		pool.Stats.Active++;
+		return result;
+	}
+
+	void Scene::ReleasePooledObject(const GameObject::Sptr& object) {
+		// Deactivating touches the physics world, so worker threads need to leave it for later
+		if (_isInParallelUpdate) {
+			std::lock_guard<std::mutex> lock(_deferredMutex);
+			_deferredReleases.push_back(object);
+			return;
+		}
+		// Physics callbacks are invoked while bodies are iterating over their contacts, removing a body
+		// from the world under them would leave them reading freed pairs
+		if (_isInPhysicsStep) {
+			_deferredReleases.push_back(object);
+			return;
+		}
+		_ReleasePooledObject(object);
+	}
+
+	void Scene::_ReleasePooledObject(const GameObject::Sptr& object) {
+		auto it = _objectPools.find(object->_objectPool);
+		if (object->_objectPool.empty() || it == _objectPools.end()) {
+			RemoveGameObject(object);
+			return;
+		}
+
+		// Already sitting in the pool, releasing again would let it be handed out twice
+		if (!object->_isActive) {
+			return;
+		}
+
+		object->SetActive(false);
+
+		ObjectPool& pool = it->second;
+		pool.Available.push_back(object);
+		pool.Stats.Released++;
+		pool.Stats.Active--;
+		pool.Stats.Available++;
+	}
+
+	void Scene::_ApplyDeferredReleases() {
+		// Releasing can run OnActiveChanged callbacks that release more objects, so take the list first
+		std::vector<GameObject::Sptr> releases;
+		releases.swap(_deferredReleases);
+		for (const auto& object : releases) {
+			_ReleasePooledObject(object);
+		}
+	}
+
+	void Scene::_DetachFromPool(GameObject* object) {
+		auto it = _objectPools.find(object->_objectPool);
+		if (it == _objectPools.end()) {
+			return;
+		}
+		ObjectPool& pool = it->second;
+
+		auto available = std::find_if(pool.Available.begin(), pool.Available.end(), [object](const GameObject::Sptr& item) {
+			return item.get() == object;
 		});
-		return it == _objects.end() ? nullptr : *it;
+		if (available != pool.Available.end()) {
+			pool.Available.erase(available);
+			pool.Stats.Available--;
+		} else {
+			pool.Stats.Active--;
+		}
+		object->_objectPool.clear();
+	}
+
+	const Scene::ObjectPoolStats* Scene::GetObjectPoolStats(const std::string& name) const {
+		auto it = _objectPools.find(name);
+		return it != _objectPools.end() ? &it->second.Stats : nullptr;
+	}
+
+	GameObject::Sptr Scene::FindObjectByName(const std::string name) const {
+		// Several objects can share a name, in which case we want the one that was added first. Objects
+		// that have been renamed since the last _SyncObjectNames are still listed under their old name
+		GameObject* result = nullptr;
+		auto range = _objectsByName.equal_range(name);
+		for (auto it = range.first; it != range.second; it++) {
+			if (it->second->Name != name) {
+				continue;
+			}
+			if (result == nullptr || it->second->_indexOrder < result->_indexOrder) {
+				result = it->second;
+			}
+		}
+		return result != nullptr ? result->SelfRef() : nullptr;
 	}
 
 	GameObject::Sptr Scene::FindObjectByGUID(Guid id) const {
-		auto it = std::find_if(_objects.begin(), _objects.end(), [&](const GameObject::Sptr& obj) {
-			return obj->_guid == id;
-		});
-		return it == _objects.end() ? nullptr : *it;
+		auto it = _objectsByGuid.find(id);
+		return it == _objectsByGuid.end() ? nullptr : it->second->SelfRef();
 	}
 
 	void Scene::SetAmbientLight(const glm::vec3& value) {
@@ -157,10 +311,11 @@ namespace Gameplay {
 	}
 
 	void Scene::DoPhysics(float dt) {
-		_components.Each<Gameplay::Physics::RigidBody>([=](const std::shared_ptr<Gameplay::Physics::RigidBody>& body) {
+		_isInPhysicsStep = true;
+		_components.Each<Gameplay::Physics::RigidBody>([=](Gameplay::Physics::RigidBody* body) {
 			body->PhysicsPreStep(dt);
 		});
-		_components.Each<Gameplay::Physics::TriggerVolume>([=](const std::shared_ptr<Gameplay::Physics::TriggerVolume>& body) {
+		_components.Each<Gameplay::Physics::TriggerVolume>([=](Gameplay::Physics::TriggerVolume* body) {
 			body->PhysicsPreStep(dt);
 		});
 
@@ -168,13 +323,17 @@ namespace Gameplay {
 
 			_physicsWorld->stepSimulation(dt, 1);
 
-			_components.Each<Gameplay::Physics::RigidBody>([=](const std::shared_ptr<Gameplay::Physics::RigidBody>& body) {
+			_components.Each<Gameplay::Physics::RigidBody>([=](Gameplay::Physics::RigidBody* body) {
 				body->PhysicsPostStep(dt);
 			});
-			_components.Each<Gameplay::Physics::TriggerVolume>([=](const std::shared_ptr<Gameplay::Physics::TriggerVolume>& body) {
+			_components.Each<Gameplay::Physics::TriggerVolume>([=](Gameplay::Physics::TriggerVolume* body) {
 				body->PhysicsPostStep(dt);
 			});
 		}
+		_isInPhysicsStep = false;
+
+		// Now that nothing is walking the physics world's contacts, objects can be pulled out of it
+		_ApplyDeferredReleases();
 	}
 
 	void Scene::DrawPhysicsDebug() {
@@ -186,12 +345,184 @@ namespace Gameplay {
 
 	void Scene::Update(float dt) {
 		_FlushDeleteQueue();
+		_SyncObjectNames();
 		if (IsPlaying) {
+			// Update components that have opted in across all threads, anything that would change the
+			// structure of the scene is deferred until they are all done
+			if (ComponentManager::HasThreadSafeUpdateTypes()) {
+				_deferredTransformChanges.resize(JobSystem::WorkerCount() + 1);
+				_isInParallelUpdate = true;
+				JobSystem::ParallelFor(_objects.size(), [&](size_t begin, size_t end) {
+					for (size_t ix = begin; ix < end; ix++) {
+						_objects[ix]->UpdateThreadSafe(dt);
+					}
+				});
+				_isInParallelUpdate = false;
+				_ApplyDeferredChanges();
+			}
+
+			// Everything else is updated in order on the main thread
 			for (int i = 0; i < _objects.size(); i++) {
 				_objects[i]->Update(dt);
 			}
+
+			// Finally anything that is on a timer
+			_RunScheduledUpdates(dt);
 		}
 		_FlushDeleteQueue();
+
+		// Catch up on everything that has moved this frame, this runs outside of play mode as well so the editor stays in sync
+		_transforms.Update();
+	}
+
+	IComponent::Sptr Scene::_DeferAddComponent(const IComponent::Sptr& component) {
+		std::lock_guard<std::mutex> lock(_deferredMutex);
+		// GameObject::Has can't see components that are still waiting to be attached, so check for them here
+		for (const auto& pending : _deferredComponents) {
+			if (pending->_context == component->_context && pending->_realType == component->_realType) {
+				LOG_ASSERT(false, "Cannot add 2 instances of a component type to a game object");
+				return pending;
+			}
+		}
+		_deferredComponents.push_back(component);
+		return component;
+	}
+
+	void Scene::_ApplyDeferredChanges() {
+		// Objects first, so that components added to new objects have somewhere to go
+		for (const auto& object : _deferredObjects) {
+			_objects.push_back(object);
+			_IndexObject(object.get());
+		}
+		// Parenting new objects had to wait until they had a node
+		for (const auto& object : _deferredObjects) {
+			GameObject::Sptr parent = object->GetParent();
+			if (parent != nullptr && parent->_transformIndex != TransformHierarchy::InvalidNode) {
+				_transforms.SetParent(object->_transformIndex, parent->_transformIndex);
+			}
+		}
+		_deferredObjects.clear();
+
+		for (auto& changes : _deferredTransformChanges) {
+			for (GameObject* object : changes) {
+				if (object->_transformIndex != TransformHierarchy::InvalidNode) {
+					_transforms.MarkDirty(object->_transformIndex);
+				}
+			}
+			changes.clear();
+		}
+
+		_ApplyDeferredReleases();
+
+		// Components are attached in the order they were added on each thread
+		for (const auto& component : _deferredComponents) {
+			_components._AddToPool(component.get());
+			component->GetGameObject()->_AttachComponent(component);
+		}
+		_deferredComponents.clear();
+
+		// Last so that components attached above already belong to an object
+		for (IComponent* component : _deferredScheduleChanges) {
+			_ApplySchedule(component);
+		}
+		_deferredScheduleChanges.clear();
+	}
+
+	void Scene::_OnTransformChanged(GameObject* object) {
+		// Worker threads can't touch the hierarchy, the change will be picked up once the parallel phase ends.
+		// Each thread has its own list, so this doesn't serialize the workers
+		if (_isInParallelUpdate) {
+			_deferredTransformChanges[JobSystem::ThreadIndex()].push_back(object);
+			return;
+		}
+		_transforms.MarkDirty(object->_transformIndex);
+	}
+
+	void Scene::_OnScheduleChanged(IComponent* component) {
+		if (_isInParallelUpdate) {
+			std::lock_guard<std::mutex> lock(_deferredMutex);
+			_deferredScheduleChanges.push_back(component);
+			return;
+		}
+		_ApplySchedule(component);
+	}
+
+	void Scene::_ApplySchedule(IComponent* component) {
+		double now = _scheduler.GetTime();
+
+		if (component->_isTimerRequested) {
+			component->_isTimerRequested = false;
+			if (component->_timerDelay >= 0.0f) {
+				_scheduler.Schedule(&component->_callbackTimer, now + component->_timerDelay);
+			} else {
+				_scheduler.Cancel(&component->_callbackTimer);
+			}
+		}
+
+		// Only re-calculate our next update if something has changed, or we've just been updated,
+		// otherwise setting a timer while asleep would push back our wake up
+		if (!component->_isScheduleDirty && component->_updateTimer.IsScheduled()) {
+			return;
+		}
+		component->_isScheduleDirty = false;
+
+		bool wasScheduled = component->_isScheduled;
+		if (!wasScheduled) {
+			// We're coming off of the per-frame updates, so our last update was this frame
+			component->_lastUpdateTime = now;
+		}
+
+		// Components that don't override Update have nothing for the scheduler to do
+		bool hasUpdate = ComponentManager::HasUpdate(component->_typeId);
+		if (hasUpdate && component->_isSleeping) {
+			_scheduler.Schedule(&component->_updateTimer, now + component->_sleepDuration);
+		} else if (hasUpdate && component->_updateInterval > 0.0f) {
+			_scheduler.Schedule(&component->_updateTimer, component->_lastUpdateTime + component->_updateInterval);
+		} else {
+			_scheduler.Cancel(&component->_updateTimer);
+		}
+		component->_isScheduled = component->_updateTimer.IsScheduled();
+
+		// Move the component in or out of the object's update lists. This can be called from inside the
+		// object's Update or from a scheduled update, so the lists are only flagged here and get rebuilt
+		// once nothing is looping over them
+		if (component->_isScheduled != wasScheduled) {
+			component->GetGameObject()->_areComponentListsDirty = true;
+		}
+	}
+
+	void Scene::_CancelSchedule(IComponent* component) {
+		_scheduler.Cancel(&component->_updateTimer);
+		_scheduler.Cancel(&component->_callbackTimer);
+	}
+
+	void Scene::_RunScheduledUpdates(float dt) {
+		_scheduler.Advance(dt);
+		double now = _scheduler.GetTime();
+
+		while (TimerWheel::Timer* timer = _scheduler.PopExpired()) {
+			IComponent* component = timer->Component;
+			bool isRunning = component->IsEnabled && component->_isObjectActive;
+
+			if (timer == &component->_callbackTimer) {
+				if (isRunning) {
+					component->OnTimer();
+				}
+				continue;
+			}
+
+			float elapsed = static_cast<float>(now - component->_lastUpdateTime);
+			component->_lastUpdateTime = now;
+			component->_isSleeping = false;
+			if (isRunning) {
+				component->Update(elapsed);
+			}
+
+			// Unless Update re-scheduled us (ex: by going back to sleep), work out when we're next due
+			if (!component->_updateTimer.IsScheduled()) {
+				_ApplySchedule(component);
+			}
+		}
 	}
 
 	void Scene::RenderGUI()
@@ -210,92 +541,469 @@ namespace Gameplay {
 
 	Scene::Sptr Scene::FromJson(const nlohmann::json& data)
 	{
-
-		Scene::Sptr result = std::make_shared<Scene>();
-		result->MainCamera = nullptr;
-		result->_objects.clear();
-		result->DefaultMaterial = ResourceManager::Get<Material>(Guid(data["default_material"]));
-
-		if (data.contains("ambient")) {
-			result->SetAmbientLight((data["ambient"]));
-		}
-
-		if (data.contains("skybox") && data["skybox"].is_object()) {
-			nlohmann::json& blob = data["skybox"].get<nlohmann::json>();
-			result->_skyboxMesh = ResourceManager::Get<MeshResource>(Guid(blob["mesh"]));
-			result->SetSkyboxShader(ResourceManager::Get<ShaderProgram>(Guid(blob["shader"])));
-			result->SetSkyboxTexture(ResourceManager::Get<TextureCube>(Guid(blob["texture"])));
-			result->SetSkyboxRotation(glm::mat3_cast((glm::quat)(blob["orientation"])));
-		}
+		Scene::Sptr result = _CreateForLoading();
+		result->_LoadSettings(data);
 
 		// Make sure the scene has objects, then load them all in!
 		LOG_ASSERT(data["objects"].is_array(), "Objects not present in scene!");
 		for (auto& object : data["objects"]) {
-			GameObject::Sptr obj = GameObject::FromJson(result.get(), object);
-			obj->_scene = result.get();
-			obj->_parent.SceneContext = result.get();
-			obj->_selfRef = obj;
-			result->_objects.push_back(obj);
+			result->_AddLoadedObject(GameObject::FromJson(result.get(), object));
 		}
+		result->_FinishLoading(Guid(data["main_camera"]));
+	
+		return result;
+	}
 
-		// Re-build the parent hierarchy 
-		for (const auto& object : result->_objects) {
-			if (object->GetParent() != nullptr) {
-				object->GetParent()->AddChild(object);
-			}
+	Scene::Sptr Scene::FromBinary(const uint8_t* data, size_t size)
+	{
+		SceneBinary::Reader reader(data, size);
+		if (!reader.IsValid()) {
+			LOG_ERROR("Data is not a valid version {} binary scene", SceneBinary::Version);
+			return nullptr;
 		}
 
-		// Create and load camera config
-		result->MainCamera = result->_components.GetComponentByGUID<Camera>(Guid(data["main_camera"]));
-	
+		Scene::Sptr result = _CreateForLoading();
+		result->_LoadSettings(reader.GetHeader());
+
+		result->_objects.reserve(reader.NumObjects());
+		for (uint32_t ix = 0; ix < reader.NumObjects(); ix++) {
+			result->_AddLoadedObject(GameObject::FromBinary(result.get(), reader, reader.GetRecord(ix)));
+		}
+		result->_FinishLoading(SceneBinary::ReadGuid(reader.GetHeader().MainCamera));
+
 		return result;
 	}
 
 	nlohmann::json Scene::ToJson() const
 	{
 		nlohmann::json blob;
-		// Save the default shader (really need a material class)
-		blob["default_material"] = DefaultMaterial ? DefaultMaterial->GetGUID().str() : "null";
-
-		blob["ambient"] = GetAmbientLight();
-
-		blob["skybox"] = nlohmann::json();
-		blob["skybox"]["mesh"] = _skyboxMesh ? _skyboxMesh->GetGUID().str() : "null";
-		blob["skybox"]["shader"] = _skyboxShader ? _skyboxShader->GetGUID().str() : "null";
-		blob["skybox"]["texture"] = _skyboxTexture ? _skyboxTexture->GetGUID().str() : "null";
-		blob["skybox"]["orientation"] = (glm::quat)_skyboxRotation;
+		_SaveSettings(blob);
 
 		// Save renderables
 		std::vector<nlohmann::json> objects;
-		objects.resize(_objects.size());
+		objects.reserve(_objects.size());
 		for (int ix = 0; ix < _objects.size(); ix++) {
-			objects[ix] = _objects[ix]->ToJson();
+			// Pooled objects are spawned at runtime, and will be re-built by their pools
+			if (!_objects[ix]->_objectPool.empty()) {
+				continue;
+			}
+			objects.push_back(_objects[ix]->ToJson());
 		}
 		blob["objects"] = objects;
 
-		// Save camera info
-		blob["main_camera"] = MainCamera != nullptr ? MainCamera->GetGUID().str() : "null";
+		return blob;
+	}
+
+	nlohmann::json Scene::ToDeltaJson(Checkpoint checkpoint) const
+	{
+		uint8_t bit = _CheckpointBit(checkpoint);
+		nlohmann::json blob;
+		blob["delta_version"] = SceneDelta::Version;
+		blob["settings"] = nlohmann::json::object();
+		_SaveSettings(blob["settings"]);
+
+		// Objects are stored flat, since their children may not have changed
+		std::vector<nlohmann::json> objects;
+		for (const auto& object : _objects) {
+			if (object->_objectPool.empty() && (object->_unsavedCheckpoints & bit) != 0) {
+				objects.push_back(object->_ToJsonWithoutChildren());
+			}
+		}
+		blob["objects"] = objects;
+
+		std::vector<std::string> removed;
+		const std::vector<Guid>& removedGuids = _removedSinceCheckpoint[(size_t)checkpoint];
+		removed.reserve(removedGuids.size());
+		for (const Guid& guid : removedGuids) {
+			removed.push_back(guid.str());
+		}
+		blob["removed"] = removed;
 
 		return blob;
 	}
 
+	void Scene::SaveDelta(const std::string& path, Checkpoint checkpoint) {
+		FileHelpers::WriteContentsToFile(path, ToDeltaJson(checkpoint).dump(1, '\t'));
+		MarkCheckpoint(checkpoint);
+		LOG_INFO("Saved scene delta to \"{}\"", path);
+	}
+
+	void Scene::MarkCheckpoint(Checkpoint checkpoint) {
+		uint8_t bit = _CheckpointBit(checkpoint);
+		for (const auto& object : _objects) {
+			object->_unsavedCheckpoints &= ~bit;
+			object->_newSinceCheckpoints &= ~bit;
+		}
+		_removedSinceCheckpoint[(size_t)checkpoint].clear();
+	}
+
+	void Scene::MarkAllChanged(Checkpoint checkpoint) {
+		uint8_t bit = _CheckpointBit(checkpoint);
+		for (const auto& object : _objects) {
+			object->_unsavedCheckpoints |= bit;
+		}
+	}
+
+	bool Scene::HasUnsavedChanges(Checkpoint checkpoint) const {
+		if (!_removedSinceCheckpoint[(size_t)checkpoint].empty()) {
+			return true;
+		}
+		uint8_t bit = _CheckpointBit(checkpoint);
+		for (const auto& object : _objects) {
+			if (object->_objectPool.empty() && (object->_unsavedCheckpoints & bit) != 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	std::vector<uint8_t> Scene::ToBinary() const
+	{
+		SceneBinary::Writer writer;
+		SceneBinary::Header& header = writer.SceneHeader;
+
+		SceneBinary::WriteGuid(DefaultMaterial ? DefaultMaterial->GetGUID() : Guid(), header.DefaultMaterial);
+		SceneBinary::WriteGuid(MainCamera != nullptr ? MainCamera->GetGUID() : Guid(), header.MainCamera);
+		memcpy(header.AmbientLight, &_ambientLight.x, sizeof(float) * 3);
+
+		header.Flags |= SceneBinary::HasSkybox;
+		SceneBinary::WriteGuid(_skyboxMesh ? _skyboxMesh->GetGUID() : Guid(), header.SkyboxMesh);
+		SceneBinary::WriteGuid(_skyboxShader ? _skyboxShader->GetGUID() : Guid(), header.SkyboxShader);
+		SceneBinary::WriteGuid(_skyboxTexture ? _skyboxTexture->GetGUID() : Guid(), header.SkyboxTexture);
+		glm::quat orientation = (glm::quat)_skyboxRotation;
+		header.SkyboxOrientation[0] = orientation.x;
+		header.SkyboxOrientation[1] = orientation.y;
+		header.SkyboxOrientation[2] = orientation.z;
+		header.SkyboxOrientation[3] = orientation.w;
+
+		for (const auto& object : _objects) {
+			// Pooled objects are spawned at runtime, and will be re-built by their pools
+			if (!object->_objectPool.empty()) {
+				continue;
+			}
+			object->ToBinary(writer);
+		}
+
+		return writer.Finish();
+	}
+
 	void Scene::Save(const std::string& path) {
 		_filePath = path;
 		// Save data to file
-		FileHelpers::WriteContentsToFile(path, ToJson().dump(1, '\t'));
+		if (std::filesystem::path(path).extension() == SceneBinary::Extension) {
+			std::vector<uint8_t> data = ToBinary();
+			FileHelpers::WriteBinaryToFile(path, data.data(), data.size());
+		} else {
+			FileHelpers::WriteContentsToFile(path, ToJson().dump(1, '\t'));
+		}
+		MarkCheckpoint();
 		LOG_INFO("Saved scene to \"{}\"", path);
 	}
 
 	Scene::Sptr Scene::Load(const std::string& path)
 	{
 		LOG_INFO("Loading scene from \"{}\"", path);
-		std::string content = FileHelpers::ReadFile(path);
-		nlohmann::json blob = nlohmann::json::parse(content);
-		Scene::Sptr result = FromJson(blob);
-		result->_filePath = path;
+		FileData::Sptr file = FileHelpers::OpenFile(path);
+		if (file == nullptr) {
+			return nullptr;
+		}
+
+		Scene::Sptr result;
+		if (SceneBinary::IsBinaryScene(file->Data(), file->Size())) {
+			result = FromBinary(file->Data(), file->Size());
+		} else {
+			// Parse straight out of the mapping, rather than copying the file into a string first
+			result = FromJson(nlohmann::json::parse(file->Data(), file->Data() + file->Size()));
+		}
+
+		if (result != nullptr) {
+			result->_filePath = path;
+		}
+		return result;
+	}
+
+	Scene::Snapshot Scene::TakeSnapshot() const {
+		Snapshot result;
+		result.Data = ToBinary();
+		for (const auto& object : _objects) {
+			if (object->_objectPool.empty() && (object->_unsavedCheckpoints != 0 || object->_newSinceCheckpoints != 0)) {
+				result.Tracking.push_back({ object->_guid, object->_unsavedCheckpoints, object->_newSinceCheckpoints });
+			}
+			if (object->_objectPool.empty()) {
+				for (const auto& component : object->_components) {
+					result.ComponentStates[component->GetGUID()] = { component->_stateVersion, component->IsEnabled };
+				}
+			}
+		}
+		result.Removed = _removedSinceCheckpoint;
+		return result;
+	}
+
+	bool Scene::RestoreSnapshot(const Snapshot& snapshot) {
+		SceneBinary::Reader reader(snapshot.Data.data(), snapshot.Data.size());
+		if (!reader.IsValid()) {
+			LOG_ERROR("Scene snapshot is corrupted, cannot restore");
+			return false;
+		}
+
+		// Anything that isn't in the snapshot was spawned since it was taken
+		std::unordered_set<Guid> snapshotObjects;
+		snapshotObjects.reserve(reader.NumObjects());
+		for (uint32_t ix = 0; ix < reader.NumObjects(); ix++) {
+			snapshotObjects.insert(SceneBinary::ReadGuid(reader.GetRecord(ix).Guid));
+		}
+		for (const auto& object : _objects) {
+			if (!object->_objectPool.empty() || snapshotObjects.count(object->_guid) == 0) {
+				_QueueDeletion(object);
+			}
+		}
+		_FlushDeleteQueue();
+
+		std::vector<GameObject::Sptr> objects;
+		objects.reserve(reader.NumObjects());
+		// Objects that had been removed, and have been re-created from the snapshot
+		std::vector<GameObject::Sptr> created;
+		std::vector<bool> isCreated(reader.NumObjects(), false);
+		// Components that have been kept, and components that have been re-created on objects that were kept
+		std::vector<IComponent::Sptr> kept;
+		std::vector<IComponent::Sptr> loaded;
+		std::vector<SceneBinary::ComponentBlob> blobs;
+
+		for (uint32_t ix = 0; ix < reader.NumObjects(); ix++) {
+			const SceneBinary::ObjectRecord& record = reader.GetRecord(ix);
+			auto it = _objectsByGuid.find(SceneBinary::ReadGuid(record.Guid));
+			if (it == _objectsByGuid.end()) {
+				GameObject::Sptr object = GameObject::FromBinary(this, reader, record);
+				_AddLoadedObject(object);
+				objects.push_back(object);
+				created.push_back(object);
+				isCreated[ix] = true;
+				continue;
+			}
+
+			GameObject::Sptr object = it->second->SelfRef();
+			objects.push_back(object);
+
+			object->Name = std::string(reader.GetName(record));
+			object->HideInHierarchy = (record.Flags & SceneBinary::HideInHierarchy) != 0;
+			// Before the components, so that re-created components pick up the right state
+			object->SetActive((record.Flags & SceneBinary::Active) != 0);
+
+			glm::vec3 position = glm::vec3(record.Position[0], record.Position[1], record.Position[2]);
+			glm::quat rotation = glm::quat(record.Rotation[3], record.Rotation[0], record.Rotation[1], record.Rotation[2]);
+			glm::vec3 scale    = glm::vec3(record.Scale[0], record.Scale[1], record.Scale[2]);
+			if (object->_position != position) {
+				object->SetPostion(position);
+			}
+			if (object->_rotation != rotation) {
+				object->SetRotation(rotation);
+			}
+			if (object->_scale != scale) {
+				object->SetScale(scale);
+			}
+
+			if (!reader.GetComponents(record, blobs)) {
+				LOG_WARN("Component data for object \"{}\" is corrupted in the snapshot, keeping current components", object->Name);
+				continue;
+			}
+
+			// Objects can only have one component of each type, so we can match components on their type names
+			std::vector<IComponent::Sptr> components(blobs.size());
+			std::vector<IComponent::Sptr> previous = std::move(object->_components);
+			object->_components.clear();
+			for (size_t blobIx = 0; blobIx < blobs.size(); blobIx++) {
+				const SceneBinary::ComponentBlob& blob = blobs[blobIx];
+				auto match = std::find_if(previous.begin(), previous.end(), [&](const IComponent::Sptr& component) {
+					return component != nullptr && component->ComponentTypeName() == blob.TypeName;
+				});
+				if (match == previous.end() || !ComponentManager::CanRestoreInPlace((*match)->_typeId)) {
+					continue;
+				}
+
+				// State versions are unique, so if ours hasn't moved we're still in the state the blob was saved from
+				auto state = snapshot.ComponentStates.find((*match)->GetGUID());
+				if (state != snapshot.ComponentStates.end() && state->second.Version == (*match)->_stateVersion && state->second.IsEnabled == (*match)->IsEnabled) {
+					components[blobIx] = std::move(*match);
+					kept.push_back(components[blobIx]);
+				}
+			}
+
+			// Anything we aren't keeping has to leave the pools before it's replaced, since the replacement has the same GUID
+			for (const auto& component : previous) {
+				if (component != nullptr) {
+					_CancelSchedule(component.get());
+					_components.Remove(component.get());
+				}
+			}
+			previous.clear();
+
+			for (size_t blobIx = 0; blobIx < blobs.size(); blobIx++) {
+				if (components[blobIx] == nullptr) {
+					nlohmann::json data;
+					if (!blobs[blobIx].Decode(data, object->_guid)) {
+						continue;
+					}
+					size_t count = object->_components.size();
+					object->_LoadComponent(std::string(blobs[blobIx].TypeName), data);
+					if (object->_components.size() > count) {
+						components[blobIx] = object->_components.back();
+						loaded.push_back(components[blobIx]);
+					}
+				}
+			}
+
+			// Keep the components in the order they were saved in
+			object->_components.clear();
+			for (auto& component : components) {
+				if (component != nullptr) {
+					object->_components.push_back(std::move(component));
+				}
+			}
+			object->_RebuildComponentSlots();
+		}
+
+		// Only objects from the snapshot are left, put them back in the order they were saved in
+		_objects = std::move(objects);
+		_RebuildNameIndex();
+
+		// Now that everything exists, sort out the hierarchy
+		for (uint32_t ix = 0; ix < reader.NumObjects(); ix++) {
+			const GameObject::Sptr& object = _objects[ix];
+			GameObject::Sptr parent = FindObjectByGUID(SceneBinary::ReadGuid(reader.GetRecord(ix).Parent));
+			if (isCreated[ix]) {
+				// Like when loading, the object knows its parent but the parent doesn't know about it yet
+				if (parent != nullptr) {
+					parent->AddChild(object);
+				}
+			} else if (object->GetParent() != parent) {
+				if (parent != nullptr) {
+					parent->AddChild(object);
+				} else {
+					object->GetParent()->RemoveChild(object);
+				}
+			}
+		}
+
+		_LoadSettings(reader.GetHeader());
+		MainCamera = _components.GetComponentByGUID<Camera>(SceneBinary::ReadGuid(reader.GetHeader().MainCamera));
+
+		// Components may look at world transforms, so make sure they're up to date first
+		_transforms.Update();
+		for (const auto& component : kept) {
+			// Timers that were running while playing belong to the state we're throwing away
+			component->CancelTimer();
+			if (component->IsSleeping()) {
+				component->Wake();
+			}
+			component->OnRestored();
+		}
+		if (_isAwake) {
+			for (const auto& object : created) {
+				object->Awake();
+			}
+			for (const auto& component : loaded) {
+				component->Awake();
+			}
+		}
+
+		// Restoring counts as changing everything, so put the change tracking back as it was
+		for (const auto& object : _objects) {
+			object->_unsavedCheckpoints = 0;
+			object->_newSinceCheckpoints = 0;
+		}
+		for (const Snapshot::ObjectTracking& tracking : snapshot.Tracking) {
+			auto it = _objectsByGuid.find(tracking.Object);
+			if (it != _objectsByGuid.end()) {
+				it->second->_unsavedCheckpoints = tracking.UnsavedCheckpoints;
+				it->second->_newSinceCheckpoints = tracking.NewSinceCheckpoints;
+			}
+		}
+		_removedSinceCheckpoint = snapshot.Removed;
+
+		return true;
+	}
+
+	Scene::Sptr Scene::_CreateForLoading() {
+		Scene::Sptr result = std::make_shared<Scene>();
+		// Everything (including the camera) will come from the file
+		result->MainCamera = nullptr;
+		result->_objects.clear();
+		result->_objectsByGuid.clear();
+		result->_objectsByName.clear();
+		result->_transforms.Clear();
 		return result;
 	}
 
+	void Scene::_LoadSettings(const nlohmann::json& data) {
+		DefaultMaterial = ResourceManager::Get<Material>(Guid(data["default_material"]));
+
+		if (data.contains("ambient")) {
+			SetAmbientLight((data["ambient"]));
+		}
+
+		if (data.contains("skybox") && data["skybox"].is_object()) {
+			nlohmann::json blob = data["skybox"];
+			_skyboxMesh = ResourceManager::Get<MeshResource>(Guid(blob["mesh"]));
+			SetSkyboxShader(ResourceManager::Get<ShaderProgram>(Guid(blob["shader"])));
+			SetSkyboxTexture(ResourceManager::Get<TextureCube>(Guid(blob["texture"])));
+			SetSkyboxRotation(glm::mat3_cast((glm::quat)(blob["orientation"])));
+		}
+	}
+
+	void Scene::_SaveSettings(nlohmann::json& blob) const {
+		// Save the default shader (really need a material class)
+		blob["default_material"] = DefaultMaterial ? DefaultMaterial->GetGUID().str() : "null";
+
+		blob["ambient"] = GetAmbientLight();
+
+		blob["skybox"] = nlohmann::json();
+		blob["skybox"]["mesh"] = _skyboxMesh ? _skyboxMesh->GetGUID().str() : "null";
+		blob["skybox"]["shader"] = _skyboxShader ? _skyboxShader->GetGUID().str() : "null";
+		blob["skybox"]["texture"] = _skyboxTexture ? _skyboxTexture->GetGUID().str() : "null";
+		blob["skybox"]["orientation"] = (glm::quat)_skyboxRotation;
+
+		// Save camera info
+		blob["main_camera"] = MainCamera != nullptr ? MainCamera->GetGUID().str() : "null";
+	}
+
+	void Scene::_LoadSettings(const SceneBinary::Header& header) {
+		DefaultMaterial = ResourceManager::Get<Material>(SceneBinary::ReadGuid(header.DefaultMaterial));
+		SetAmbientLight(glm::vec3(header.AmbientLight[0], header.AmbientLight[1], header.AmbientLight[2]));
+
+		if (header.Flags & SceneBinary::HasSkybox) {
+			_skyboxMesh = ResourceManager::Get<MeshResource>(SceneBinary::ReadGuid(header.SkyboxMesh));
+			SetSkyboxShader(ResourceManager::Get<ShaderProgram>(SceneBinary::ReadGuid(header.SkyboxShader)));
+			SetSkyboxTexture(ResourceManager::Get<TextureCube>(SceneBinary::ReadGuid(header.SkyboxTexture)));
+			const float* orientation = header.SkyboxOrientation;
+			SetSkyboxRotation(glm::mat3_cast(glm::quat(orientation[3], orientation[0], orientation[1], orientation[2])));
+		}
+	}
+
+	void Scene::_AddLoadedObject(const GameObject::Sptr& object) {
+		object->_scene = this;
+		object->_parent.SceneContext = this;
+		object->_selfRef = object;
+		_objects.push_back(object);
+		_IndexObject(object.get());
+	}
+
+	void Scene::_FinishLoading(const Guid& mainCamera) {
+		// Re-build the parent hierarchy 
+		for (const auto& object : _objects) {
+			if (object->GetParent() != nullptr) {
+				object->GetParent()->AddChild(object);
+			}
+		}
+
+		// Create and load camera config
+		MainCamera = _components.GetComponentByGUID<Camera>(mainCamera);
+
+		// Everything we just loaded matches the file
+		for (size_t ix = 0; ix < NumCheckpoints; ix++) {
+			MarkCheckpoint((Checkpoint)ix);
+		}
+	}
+
 	int Scene::NumObjects() const {
 		return static_cast<int>(_objects.size());
 	}
@@ -335,14 +1043,115 @@ namespace Gameplay {
 
 
 	void Scene::_FlushDeleteQueue() {
-		for (auto& weakPtr : _deletionQueue) {
-			if (weakPtr.expired()) continue;
-			auto& it = std::find(_objects.begin(), _objects.end(), weakPtr.lock());
-			if (it != _objects.end()) {
-				_objects.erase(it);
+		if (!_hasPendingDeletions) {
+			return;
+		}
+		_hasPendingDeletions = false;
+
+		// Slide everything we're keeping to the front in one pass, so the order of _objects is preserved
+		std::vector<GameObject::Sptr> removed;
+		size_t kept = 0;
+		for (size_t ix = 0; ix < _objects.size(); ix++) {
+			if (_objects[ix]->_isPendingRemoval) {
+				removed.push_back(std::move(_objects[ix]));
+			} else {
+				if (kept != ix) {
+					_objects[kept] = std::move(_objects[ix]);
+				}
+				kept++;
+			}
+		}
+		_objects.resize(kept);
+
+		if (removed.empty()) {
+			return;
+		}
+
+		_UnindexObjects(removed);
+		for (const auto& object : removed) {
+			// Pull the components out of the pools and the scheduler now, rather than waiting for them to be
+			// destroyed, as someone else may still be holding on to the object
+			for (const auto& component : object->_components) {
+				_CancelSchedule(component.get());
+				_components.Remove(component.get());
+			}
+			if (!object->_objectPool.empty()) {
+				_DetachFromPool(object.get());
+			} else {
+				// Objects created since a checkpoint were never saved there, so there's nothing to remove
+				for (size_t ix = 0; ix < NumCheckpoints; ix++) {
+					if ((object->_newSinceCheckpoints & _CheckpointBit((Checkpoint)ix)) == 0) {
+						_removedSinceCheckpoint[ix].push_back(object->_guid);
+					}
+				}
+			}
+		}
+
+		// Anything that isn't referenced elsewhere is destroyed here, once nothing points to it anymore
+		removed.clear();
+	}
+
+	void Scene::_IndexObject(GameObject* object) {
+		object->_transformIndex = _transforms.Add(object);
+		_objectsByGuid[object->_guid] = object;
+		object->_indexedName = object->Name;
+		object->_indexOrder = _nextIndexOrder++;
+		_objectsByName.emplace(object->_indexedName, object);
+	}
+
+	void Scene::_UnindexObjects(const std::vector<GameObject::Sptr>& objects) {
+		// Names are often shared by lots of objects (like bullets), so each name bucket is cleaned up
+		// once rather than once per object
+		std::unordered_set<std::string> names;
+		for (const auto& object : objects) {
+			auto guidIt = _objectsByGuid.find(object->_guid);
+			if (guidIt != _objectsByGuid.end() && guidIt->second == object.get()) {
+				_objectsByGuid.erase(guidIt);
+			}
+
+			if (object->_transformIndex != TransformHierarchy::InvalidNode) {
+				_transforms.Remove(object->_transformIndex);
+				object->_transformIndex = TransformHierarchy::InvalidNode;
+			}
+
+			names.insert(object->_indexedName);
+		}
+
+		for (const auto& name : names) {
+			auto range = _objectsByName.equal_range(name);
+			for (auto it = range.first; it != range.second;) {
+				it = it->second->_isPendingRemoval ? _objectsByName.erase(it) : std::next(it);
+			}
+		}
+	}
+
+	void Scene::_SyncObjectNames() {
+		for (const auto& object : _objects) {
+			if (object->Name == object->_indexedName) {
+				continue;
 			}
+			// Only the entries with the old name need to be checked, so this doesn't depend on the size of the scene
+			auto range = _objectsByName.equal_range(object->_indexedName);
+			for (auto it = range.first; it != range.second; it++) {
+				if (it->second == object.get()) {
+					_objectsByName.erase(it);
+					break;
+				}
+			}
+			object->_indexedName = object->Name;
+			_objectsByName.emplace(object->_indexedName, object.get());
+			object->_unsavedCheckpoints = GameObject::AllCheckpoints;
+		}
+	}
+
+	void Scene::_RebuildNameIndex() {
+		_objectsByName.clear();
+		_nextIndexOrder = 0;
+		for (const auto& obj : _objects) {
+			obj->_indexedName = obj->Name;
+			obj->_indexOrder = _nextIndexOrder++;
+			_objectsByName.emplace(obj->_indexedName, obj.get());
 		}
-		_deletionQueue.clear();
 	}
 
 	void Scene::DrawAllGameObjectGUIs()
@@ -1,9 +1,14 @@
 #pragma once
+#include <mutex>
+#include <array>
+#include <functional>
 #include <btBulletDynamicsCommon.h>
 #include "BulletCollision/CollisionDispatch/btGhostObject.h"
 
 #include "Gameplay/Components/Camera.h"
 #include "Gameplay/GameObject.h"
+#include "Gameplay/TransformHierarchy.h"
+#include "Gameplay/TimerWheel.h"
 
 #include "Physics/BulletDebugDraw.h"
 
@@ -34,6 +39,64 @@ namespace Gameplay {
 	class Scene {
 	public:
 		typedef std::shared_ptr<Scene> Sptr;
+		// Sets up a freshly created pooled object, adding its components and configuring them
+		typedef std::function<void(const GameObject::Sptr& object)> PrefabBuilder;
+
+		/// <summary>
+		/// Counters for an object pool, see AcquirePooledObject
+		/// </summary>
+		struct ObjectPoolStats {
+			// Total number of objects that have been acquired from the pool
+			uint32_t Acquired  = 0;
+			// How many of those acquires re-used a released object instead of building a new one
+			uint32_t Reused    = 0;
+			// Total number of objects that have been released back to the pool
+			uint32_t Released  = 0;
+			// Objects that are currently acquired and in use
+			uint32_t Active    = 0;
+			// Inactive objects waiting in the pool to be re-used
+			uint32_t Available = 0;
+
+			/// <summary>
+			/// Gets the fraction of acquires that were served by re-using an object, between 0 and 1
+			/// </summary>
+			float HitRate() const { return Acquired > 0 ? Reused / (float)Acquired : 0.0f; }
+		};
+
+		/// <summary>
+		/// Changes are tracked against more than one checkpoint, so that autosaving doesn't make the
+		/// scene look like it has been saved
+		/// </summary>
+		enum class Checkpoint : uint8_t {
+			Save     = 0, // The scene's file, moved by Save and by loading
+			Autosave = 1  // The editor's autosave
+		};
+		static constexpr size_t NumCheckpoints = 2;
+
+		/// <summary>
+		/// A copy of the scene's state held in memory, see TakeSnapshot
+		/// </summary>
+		struct Snapshot {
+			// The state version and enabled flag of a component when the snapshot was taken
+			struct ComponentState {
+				uint64_t Version;
+				bool     IsEnabled;
+			};
+
+			// The scene in the binary scene format (see SceneBinary)
+			std::vector<uint8_t> Data;
+			// Lets the restore keep components that haven't changed without looking at their data
+			std::unordered_map<Guid, ComponentState> ComponentStates;
+			// Change tracking at the time of the snapshot, so that restoring doesn't lose unsaved edits.
+			// The flags hold one bit per checkpoint, like the ones in GameObject
+			struct ObjectTracking {
+				Guid    Object;
+				uint8_t UnsavedCheckpoints;
+				uint8_t NewSinceCheckpoints;
+			};
+			std::vector<ObjectTracking> Tracking;
+			std::array<std::vector<Guid>, NumCheckpoints> Removed;
+		};
 		
 		// The camera for our scene
 		Camera::Sptr               MainCamera;
@@ -69,6 +132,13 @@ namespace Gameplay {
 		 */
 		bool GetIsAwake() const { return _isAwake; }
 
+		/**
+		 * Gets whether the scene is currently updating thread safe components on worker threads. While
+		 * this is true, CreateGameObject, GameObject::Add, RemoveGameObject and ReleasePooledObject are
+		 * deferred until the parallel phase is done
+		 */
+		bool IsInParallelUpdate() const { return _isInParallelUpdate; }
+
 		/// <summary>
 		/// Creates a game object with the given name
 		/// CreateGameObject is the only way to create game objects
@@ -83,17 +153,56 @@ namespace Gameplay {
 		/// <param name="object">The gameobject to delete</param>
 		void RemoveGameObject(const GameObject::Sptr& object);
 
+		/// <summary>
+		/// Registers a pool of re-usable objects. Objects in the pool are built once using the builder,
+		/// and are deactivated instead of destroyed when they are released. If the pool already exists,
+		/// its builder is replaced and any objects it has already built are kept
+		/// </summary>
+		/// <param name="name">The name of the pool, also used as the name for the objects it creates</param>
+		/// <param name="builder">Adds and configures the components for a new object in the pool</param>
+		void RegisterObjectPool(const std::string& name, const PrefabBuilder& builder);
+		/// <summary>
+		/// Gets whether an object pool with the given name has been registered
+		/// </summary>
+		bool HasObjectPool(const std::string& name) const;
+		/// <summary>
+		/// Takes an object from the given pool, moves it to the spawn transform and then activates it, building
+		/// a new one if the pool is empty. The object is moved first so that its physics bodies are added to the
+		/// world where it spawns. Re-used objects keep their previous scale and component state, so callers
+		/// should set up anything else that varies between uses. Must not be called during the parallel update
+		/// </summary>
+		/// <param name="name">The name of the pool to take an object from</param>
+		/// <param name="position">The position to spawn the object at</param>
+		/// <param name="rotation">The rotation to spawn the object with</param>
+		/// <returns>The active object, or nullptr if the pool does not exist</returns>
+		GameObject::Sptr AcquirePooledObject(const std::string& name, const glm::vec3& position, const glm::quat& rotation = glm::quat(glm::vec3(0.0f)));
+		/// <summary>
+		/// Deactivates an object and returns it to the pool it came from. Objects that did not come
+		/// from a pool are removed from the scene instead, as if by RemoveGameObject
+		///
+		/// Deactivating an object removes its bodies from the physics world, so objects released from
+		/// physics callbacks (ex: trigger enter events) are released once DoPhysics is done
+		/// </summary>
+		/// <param name="object">The object to release</param>
+		void ReleasePooledObject(const GameObject::Sptr& object);
+		/// <summary>
+		/// Gets the counters for an object pool, or nullptr if the pool does not exist
+		/// </summary>
+		const ObjectPoolStats* GetObjectPoolStats(const std::string& name) const;
+
 		/// <summary>
 		/// Searches all objects in the scene and returns the first
 		/// one who's name matches the one given, or nullptr if no object
 		/// is found
+		/// 
+		/// Uses a name index, objects that are renamed by setting their
+		/// Name are moved in the index at the start of the next Update
 		/// </summary>
 		/// <param name="name">The name of the object to find</param>
 		GameObject::Sptr FindObjectByName(const std::string name) const;
 		/// <summary>
-		/// Searches all render objects in the scene and returns the first
-		/// one who's guid matches the one given, or nullptr if no object
-		/// is found
+		/// Looks up the object with the given guid in constant time, or
+		/// returns nullptr if no object is found
 		/// </summary>
 		/// <param name="id">The guid of the object to find</param>
 		GameObject::Sptr FindObjectByGUID(Guid id) const;
@@ -112,6 +221,11 @@ namespace Gameplay {
 		/// Gets the file path that this scene was saved to or loaded from
 		/// </summary>
 		const std::string& GetFilePath() const { return _filePath; }
+		/// <summary>
+		/// Sets the file path that this scene belongs to, for scenes that were not loaded from their
+		/// own file (ex: when recovering an autosave)
+		/// </summary>
+		void SetFilePath(const std::string& path) { _filePath = path; }
 
 		/// <summary>
 		/// Calls awake on all objects in the scene,
@@ -136,6 +250,12 @@ namespace Gameplay {
 		/// Performs updates on all enabled components and gameobjects in the
 		/// scene
 		/// 
+		/// Components that have opted into thread safe updates are updated first
+		/// across all worker threads, then everything else is updated serially
+		/// in object order. Components with a reduced update rate, that are
+		/// sleeping, or that have a timer running are handled last, by the
+		/// scheduler
+		/// 
 		/// Only invokes events if IsPlaying is true
 		/// </summary>
 		/// <param name="dt">The time in seconds since the last frame</param>
@@ -154,6 +274,12 @@ namespace Gameplay {
 
 		void DrawSkybox();
 
+		/// <summary>
+		/// Gets the number of components that are updated by the scheduler instead of every frame
+		/// (see IComponent::SetUpdateRate and IComponent::SleepFor), plus any running component timers
+		/// </summary>
+		size_t NumScheduledTimers() const { return _scheduler.Size(); }
+
 		/// <summary>
 		/// Gets the scene's Bullet physics world
 		/// </summary>
@@ -167,22 +293,77 @@ namespace Gameplay {
 		/// Converts this object into it's JSON representation for storage
 		/// </summary>
 		nlohmann::json ToJson() const;
+		/// <summary>
+		/// Loads a scene from the binary scene format (see SceneBinary), the data is read in place
+		/// so it can come straight from a memory mapped file
+		/// </summary>
+		/// <returns>The loaded scene, or nullptr if the data is not a valid binary scene</returns>
+		static Scene::Sptr FromBinary(const uint8_t* data, size_t size);
+		/// <summary>
+		/// Converts this scene into the binary scene format
+		/// </summary>
+		std::vector<uint8_t> ToBinary() const;
 
 		ComponentManager& Components() { return _components; }
 		const ComponentManager& Components() const { return _components; }
 
 		/// <summary>
-		/// Saves this scene to an output JSON file
+		/// Saves this scene to an output file, paths ending in SceneBinary::Extension are saved in
+		/// the binary format, and everything else is saved as JSON
 		/// </summary>
 		/// <param name="path">The path of the file to write to</param>
 		void Save(const std::string& path);
 		/// <summary>
-		/// Loads a scene from an input JSON file
+		/// Converts everything that has changed since a checkpoint into a scene delta (see SceneDelta),
+		/// this is much smaller than the full scene when only a few objects have been edited
+		/// </summary>
+		/// <param name="checkpoint">The checkpoint that the delta is made against</param>
+		nlohmann::json ToDeltaJson(Checkpoint checkpoint = Checkpoint::Save) const;
+		/// <summary>
+		/// Saves the changes since a checkpoint to a delta file, and moves that checkpoint up to now
+		/// </summary>
+		/// <param name="path">The path of the file to write to</param>
+		/// <param name="checkpoint">The checkpoint that the delta is made against</param>
+		void SaveDelta(const std::string& path, Checkpoint checkpoint = Checkpoint::Save);
+		/// <summary>
+		/// Marks the scene as being in sync with what's on disk for the given checkpoint, the next delta
+		/// against it will only contain changes made after this. Loading the scene marks all checkpoints,
+		/// and saving it marks the Save checkpoint
+		/// </summary>
+		void MarkCheckpoint(Checkpoint checkpoint = Checkpoint::Save);
+		/// <summary>
+		/// Flags every object as changed since the given checkpoint, ex: when the scene was loaded from
+		/// somewhere other than the file the checkpoint refers to. Removals from before this call are
+		/// not known, so use Save rather than SaveDelta to bring the checkpoint back in sync
+		/// </summary>
+		void MarkAllChanged(Checkpoint checkpoint);
+		/// <summary>
+		/// Returns true if anything in the scene has changed since the given checkpoint
+		/// </summary>
+		bool HasUnsavedChanges(Checkpoint checkpoint = Checkpoint::Save) const;
+		/// <summary>
+		/// Loads a scene from an input JSON or binary file, binary scenes are detected by their
+		/// header rather than their extension
 		/// </summary>
 		/// <param name="path">The path of the file to read from</param>
 		/// <returns>A new scene loaded from the file</returns>
 		static Scene::Sptr Load(const std::string& path);
 
+		/// <summary>
+		/// Captures the state of the scene (objects, transforms and components) in memory, so that it
+		/// can be put back with RestoreSnapshot, ex: when leaving play mode. Pooled objects are not captured
+		/// </summary>
+		Snapshot TakeSnapshot() const;
+		/// <summary>
+		/// Puts the scene back to the state it was in when the snapshot was taken, without re-creating the
+		/// scene. Objects that still exist are kept and have their state restored, objects that were created
+		/// since the snapshot are removed, and objects that were removed are re-created. Components are only
+		/// kept if their type declares RestoreInPlace and their saved state is unchanged, anything else is
+		/// re-created from the snapshot
+		/// </summary>
+		/// <returns>True if the snapshot was restored, false if it was corrupted</returns>
+		bool RestoreSnapshot(const Snapshot& snapshot);
+
 
 		int NumObjects() const;
 		GameObject::Sptr GetObjectByIndex(int index) const;
@@ -190,6 +371,9 @@ namespace Gameplay {
 	protected:
 		friend class HierarchyWindow;
 		friend class GameObject;
+		friend class IComponent;
+		friend class SceneLoader;
+		friend class Prefab;
 
 		// The component manager will store all components for objects in this scene
 		ComponentManager _components;
@@ -217,7 +401,34 @@ namespace Gameplay {
 
 		// Stores all the objects in our scene
 		std::vector<GameObject::Sptr>  _objects;
-		std::vector<std::weak_ptr<GameObject>>  _deletionQueue;
+		// Set when RemoveGameObject has flagged objects for removal, see _FlushDeleteQueue
+		bool                           _hasPendingDeletions;
+
+		// Lookup tables for finding objects without searching _objects, these must be kept in sync
+		// with _objects via _IndexObject and _UnindexObjects. Objects are listed under the name they had
+		// when they were indexed, renamed objects are moved over by _SyncObjectNames
+		std::unordered_map<Guid, GameObject*>             _objectsByGuid;
+		std::unordered_multimap<std::string, GameObject*> _objectsByName;
+		// Handed out to objects as they are added to _objectsByName, see GameObject::_indexOrder
+		uint64_t                                          _nextIndexOrder;
+
+		// Local and world transforms for every object in _objects, objects get their node in _IndexObject
+		TransformHierarchy _transforms;
+		// Wakes up components that are not updated every frame, and drives component timers. Only
+		// advances while playing
+		TimerWheel         _scheduler;
+
+		struct ObjectPool {
+			PrefabBuilder                 Builder;
+			// Inactive objects ready to be re-used, these are also in _objects
+			std::vector<GameObject::Sptr> Available;
+			ObjectPoolStats               Stats;
+		};
+		std::unordered_map<std::string, ObjectPool> _objectPools;
+
+		// GUIDs of the saved objects that have been removed since each checkpoint, see ToDeltaJson.
+		// Objects created and removed again since a checkpoint are left out
+		std::array<std::vector<Guid>, NumCheckpoints> _removedSinceCheckpoint;
 
 		// Info for rendering our skybox will be stored in the scene itself
 		std::shared_ptr<ShaderProgram>       _skyboxShader;
@@ -232,6 +443,20 @@ namespace Gameplay {
 
 		bool                       _isAwake;
 
+		// Only ever written by the main thread, before and after the parallel phase
+		bool                                _isInParallelUpdate;
+		// Set while DoPhysics is invoking the physics callbacks, releases are deferred until it's done
+		bool                                _isInPhysicsStep;
+		// Structural changes made during the parallel phase, applied by _ApplyDeferredChanges
+		std::mutex                          _deferredMutex;
+		std::vector<GameObject::Sptr>       _deferredObjects;
+		std::vector<IComponent::Sptr>       _deferredComponents;
+		std::vector<GameObject::Sptr>       _deferredReleases;
+		std::vector<IComponent*>            _deferredScheduleChanges;
+		// Objects that moved during the parallel phase, with one list per job system thread (see
+		// JobSystem::ThreadIndex) since nearly every moving object lands here. These don't need the lock
+		std::vector<std::vector<GameObject*>> _deferredTransformChanges;
+
 		/// <summary>
 		/// Handles configuring our bullet physics stuff
 		/// </summary>
@@ -241,6 +466,111 @@ namespace Gameplay {
 		/// </summary>
 		void _CleanupPhysics();
 
+		/// <summary>
+		/// Removes every object that has been flagged for removal, compacting _objects and updating the
+		/// lookup tables and component pools in a single pass
+		/// </summary>
 		void _FlushDeleteQueue();
+		/// <summary>
+		/// Flags an object and all of its children for removal, objects that are already flagged are skipped
+		/// </summary>
+		void _QueueDeletion(const GameObject::Sptr& object);
+		/// <summary>
+		/// Does the actual work for ReleasePooledObject, must be called from the main thread
+		/// </summary>
+		void _ReleasePooledObject(const GameObject::Sptr& object);
+		/// <summary>
+		/// Releases the objects that were passed to ReleasePooledObject during the parallel phase or
+		/// the physics step, must be called from the main thread
+		/// </summary>
+		void _ApplyDeferredReleases();
+		/// <summary>
+		/// Lets an object's pool know that it is being deleted, so it can be dropped from the counters
+		/// </summary>
+		void _DetachFromPool(GameObject* object);
+
+		/// <summary>
+		/// Queues a component created during the parallel phase to be attached to its game object
+		/// </summary>
+		/// <returns>The component that will be attached, which is an already queued component if the object already has one of the same type pending</returns>
+		IComponent::Sptr _DeferAddComponent(const IComponent::Sptr& component);
+		/// <summary>
+		/// Adds objects and components that were created during the parallel phase to the scene,
+		/// must be called from the main thread
+		/// </summary>
+		void _ApplyDeferredChanges();
+
+		/// <summary>
+		/// Invoked by game objects when their position, rotation or scale changes
+		/// </summary>
+		void _OnTransformChanged(GameObject* object);
+
+		/// <summary>
+		/// Invoked by components when their update rate, sleep state or timer changes
+		/// </summary>
+		void _OnScheduleChanged(IComponent* component);
+		/// <summary>
+		/// Applies any pending changes to a component's schedule, moving it between the scheduler and
+		/// its game object's update lists as needed
+		/// </summary>
+		void _ApplySchedule(IComponent* component);
+		/// <summary>
+		/// Removes a component's timers from the scheduler, for when it is being destroyed or removed from its object
+		/// </summary>
+		void _CancelSchedule(IComponent* component);
+		/// <summary>
+		/// Advances the scheduler, and invokes Update and OnTimer for all components whose timers have expired
+		/// </summary>
+		void _RunScheduledUpdates(float dt);
+
+		/// <summary>
+		/// Adds an object to the GUID and name lookup tables, and gives it a node in the transform hierarchy
+		/// </summary>
+		void _IndexObject(GameObject* object);
+		/// <summary>
+		/// Removes a batch of objects that are flagged for removal from the GUID and name lookup tables,
+		/// and from the transform hierarchy
+		/// </summary>
+		void _UnindexObjects(const std::vector<GameObject::Sptr>& objects);
+		/// <summary>
+		/// Moves any objects whose Name has changed since they were indexed to the name lookup entry
+		/// for their new name, and flags them as changed for the next delta save
+		/// </summary>
+		void _SyncObjectNames();
+		/// <summary>
+		/// Re-creates the name lookup table from scratch, for when objects have been reordered or
+		/// renamed in bulk
+		/// </summary>
+		void _RebuildNameIndex();
+
+		/// <summary>
+		/// Gets the bit for a checkpoint in the change tracking flags of our objects
+		/// </summary>
+		static constexpr uint8_t _CheckpointBit(Checkpoint checkpoint) {
+			return (uint8_t)(1 << (uint8_t)checkpoint);
+		}
+
+		/// <summary>
+		/// Creates a scene to load objects into, without the default camera
+		/// </summary>
+		static Scene::Sptr _CreateForLoading();
+		/// <summary>
+		/// Loads the scene wide settings (default material, lighting and skybox) from a scene file
+		/// </summary>
+		void _LoadSettings(const nlohmann::json& data);
+		void _LoadSettings(const SceneBinary::Header& header);
+		/// <summary>
+		/// Saves the scene wide settings (default material, lighting, skybox and main camera) to a JSON blob
+		/// </summary>
+		void _SaveSettings(nlohmann::json& blob) const;
+		/// <summary>
+		/// Adds an object that has just been loaded to the scene, parents are hooked up afterwards
+		/// by _FinishLoading
+		/// </summary>
+		void _AddLoadedObject(const GameObject::Sptr& object);
+		/// <summary>
+		/// Re-builds the parent hierarchy and finds the main camera after all objects have been loaded
+		/// </summary>
+		void _FinishLoading(const Guid& mainCamera);
 	};
 }
\ No newline at end of file
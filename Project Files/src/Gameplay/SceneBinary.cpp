@@ -0,0 +1,354 @@
+#include "Gameplay/SceneBinary.h"
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <unordered_map>
+#include <Logging.h>
+
+#include "Utils/JsonGlmHelpers.h"
+#include "Utils/FileHelpers.h"
+#include "Gameplay/SceneDelta.h"
+
+namespace Gameplay {
+	/// <summary>
+	/// Appends a plain value to the end of a byte buffer
+	/// </summary>
+	template <typename T>
+	static inline void AppendValue(std::vector<uint8_t>& buffer, const T& value) {
+		static_assert(std::is_trivially_copyable<T>::value, "Only trivial types can be appended");
+		size_t offset = buffer.size();
+		buffer.resize(offset + sizeof(T));
+		memcpy(buffer.data() + offset, &value, sizeof(T));
+	}
+
+	static inline void AppendBytes(std::vector<uint8_t>& buffer, const void* data, size_t size) {
+		size_t offset = buffer.size();
+		buffer.resize(offset + size);
+		if (size > 0) {
+			memcpy(buffer.data() + offset, data, size);
+		}
+	}
+
+	/// <summary>
+	/// Converts raw GUID bytes to a string, using "null" for invalid GUIDs like the JSON format does
+	/// </summary>
+	static inline std::string GuidToJson(const uint8_t* bytes) {
+		Guid guid = SceneBinary::ReadGuid(bytes);
+		return guid.isValid() ? guid.str() : "null";
+	}
+
+	bool SceneBinary::ComponentBlob::Decode(nlohmann::json& result, const Guid& owner) const {
+		try {
+			result = nlohmann::json::from_msgpack(Data, Data + Size);
+			return true;
+		}
+		catch (const nlohmann::json::exception& e) {
+			LOG_WARN("Component \"{}\" on object {} is corrupted, skipping it: {}", TypeName, owner.str(), e.what());
+			return false;
+		}
+	}
+
+	SceneBinary::Writer::Writer() :
+		SceneHeader(Header()),
+		_records(std::vector<ObjectRecord>()),
+		_data(std::vector<uint8_t>())
+	{
+		memset(&SceneHeader, 0, sizeof(Header));
+	}
+
+	void SceneBinary::Writer::BeginObject(const std::string& name, const Guid& guid, const Guid& parent, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale, uint32_t flags) {
+		ObjectRecord record;
+		memset(&record, 0, sizeof(ObjectRecord));
+		WriteGuid(guid, record.Guid);
+		WriteGuid(parent, record.Parent);
+		memcpy(record.Position, &position.x, sizeof(float) * 3);
+		record.Rotation[0] = rotation.x;
+		record.Rotation[1] = rotation.y;
+		record.Rotation[2] = rotation.z;
+		record.Rotation[3] = rotation.w;
+		memcpy(record.Scale, &scale.x, sizeof(float) * 3);
+		record.Flags = flags;
+
+		record.NameOffset = _data.size();
+		record.NameLength = static_cast<uint32_t>(name.size());
+		AppendBytes(_data, name.data(), name.size());
+
+		record.ComponentsOffset = _data.size();
+		_records.push_back(record);
+	}
+
+	void SceneBinary::Writer::AddComponent(const std::string& typeName, const nlohmann::json& blob) {
+		LOG_ASSERT(!_records.empty(), "Components must be added after BeginObject!");
+		ObjectRecord& record = _records.back();
+
+		std::vector<uint8_t> encoded = nlohmann::json::to_msgpack(blob);
+		AppendValue(_data, static_cast<uint32_t>(typeName.size()));
+		AppendBytes(_data, typeName.data(), typeName.size());
+		AppendValue(_data, static_cast<uint32_t>(encoded.size()));
+		AppendBytes(_data, encoded.data(), encoded.size());
+
+		record.ComponentCount++;
+		record.ComponentsSize = _data.size() - record.ComponentsOffset;
+	}
+
+	std::vector<uint8_t> SceneBinary::Writer::Finish() {
+		uint64_t dataOffset = sizeof(Header) + sizeof(ObjectRecord) * _records.size();
+
+		SceneHeader.Magic = SceneBinary::Magic;
+		SceneHeader.Version = SceneBinary::Version;
+		SceneHeader.ObjectCount = static_cast<uint32_t>(_records.size());
+		SceneHeader.HeaderSize = sizeof(Header);
+		SceneHeader.RecordSize = sizeof(ObjectRecord);
+		SceneHeader.FileSize = dataOffset + _data.size();
+
+		std::vector<uint8_t> result;
+		result.reserve(SceneHeader.FileSize);
+		AppendValue(result, SceneHeader);
+		for (ObjectRecord record : _records) {
+			// Data offsets become relative to the start of the file
+			record.NameOffset += dataOffset;
+			record.ComponentsOffset += dataOffset;
+			AppendValue(result, record);
+		}
+		AppendBytes(result, _data.data(), _data.size());
+		return result;
+	}
+
+	SceneBinary::Reader::Reader(const uint8_t* data, size_t size) :
+		_data(data),
+		_size(size),
+		_isValid(false)
+	{
+		if (!IsBinaryScene(data, size) || size < sizeof(Header)) {
+			return;
+		}
+
+		const Header& header = GetHeader();
+		if (header.Version != SceneBinary::Version) {
+			LOG_WARN("Binary scene is version {}, but we only support version {}", header.Version, SceneBinary::Version);
+			return;
+		}
+		if (header.HeaderSize != sizeof(Header) || header.RecordSize != sizeof(ObjectRecord) || header.FileSize != size) {
+			LOG_WARN("Binary scene header does not match the file, it may be truncated");
+			return;
+		}
+		if (!_InBounds(sizeof(Header), (uint64_t)sizeof(ObjectRecord) * header.ObjectCount)) {
+			return;
+		}
+
+		// Validate all of the records up front, so that the accessors don't need to
+		for (uint32_t ix = 0; ix < header.ObjectCount; ix++) {
+			const ObjectRecord& record = GetRecord(ix);
+			if (!_InBounds(record.NameOffset, record.NameLength) || !_InBounds(record.ComponentsOffset, record.ComponentsSize)) {
+				LOG_WARN("Binary scene object {} points outside of the file", ix);
+				return;
+			}
+		}
+
+		_isValid = true;
+	}
+
+	const SceneBinary::Header& SceneBinary::Reader::GetHeader() const {
+		return *reinterpret_cast<const Header*>(_data);
+	}
+
+	uint32_t SceneBinary::Reader::NumObjects() const {
+		return _isValid ? GetHeader().ObjectCount : 0;
+	}
+
+	const SceneBinary::ObjectRecord& SceneBinary::Reader::GetRecord(uint32_t index) const {
+		return reinterpret_cast<const ObjectRecord*>(_data + sizeof(Header))[index];
+	}
+
+	std::string_view SceneBinary::Reader::GetName(const ObjectRecord& record) const {
+		return std::string_view(reinterpret_cast<const char*>(_data + record.NameOffset), record.NameLength);
+	}
+
+	bool SceneBinary::Reader::GetComponents(const ObjectRecord& record, std::vector<ComponentBlob>& result) const {
+		result.clear();
+		result.reserve(record.ComponentCount);
+
+		uint64_t seek = record.ComponentsOffset;
+		uint64_t end = record.ComponentsOffset + record.ComponentsSize;
+		for (uint32_t ix = 0; ix < record.ComponentCount; ix++) {
+			ComponentBlob blob;
+			uint32_t length;
+
+			if (seek + sizeof(uint32_t) > end) return false;
+			memcpy(&length, _data + seek, sizeof(uint32_t));
+			seek += sizeof(uint32_t);
+			if (seek + length > end) return false;
+			blob.TypeName = std::string_view(reinterpret_cast<const char*>(_data + seek), length);
+			seek += length;
+
+			if (seek + sizeof(uint32_t) > end) return false;
+			memcpy(&length, _data + seek, sizeof(uint32_t));
+			seek += sizeof(uint32_t);
+			if (seek + length > end) return false;
+			blob.Data = _data + seek;
+			blob.Size = length;
+			seek += length;
+
+			result.push_back(blob);
+		}
+		return true;
+	}
+
+	bool SceneBinary::Reader::_InBounds(uint64_t offset, uint64_t size) const {
+		return offset <= _size && size <= _size - offset;
+	}
+
+	bool SceneBinary::IsBinaryScene(const uint8_t* data, size_t size) {
+		if (data == nullptr || size < sizeof(uint32_t)) {
+			return false;
+		}
+		uint32_t magic;
+		memcpy(&magic, data, sizeof(uint32_t));
+		return magic == SceneBinary::Magic;
+	}
+
+	std::vector<uint8_t> SceneBinary::JsonToBinary(const nlohmann::json& scene) {
+		Writer writer;
+		Header& header = writer.SceneHeader;
+
+		WriteGuid(Guid(JsonGet<std::string>(scene, "default_material", "null")), header.DefaultMaterial);
+		WriteGuid(Guid(JsonGet<std::string>(scene, "main_camera", "null")), header.MainCamera);
+
+		glm::vec3 ambient = JsonGet(scene, "ambient", glm::vec3(0.0f));
+		memcpy(header.AmbientLight, &ambient.x, sizeof(float) * 3);
+
+		if (scene.contains("skybox") && scene["skybox"].is_object()) {
+			const nlohmann::json& skybox = scene["skybox"];
+			header.Flags |= HasSkybox;
+			WriteGuid(Guid(JsonGet<std::string>(skybox, "mesh", "null")), header.SkyboxMesh);
+			WriteGuid(Guid(JsonGet<std::string>(skybox, "shader", "null")), header.SkyboxShader);
+			WriteGuid(Guid(JsonGet<std::string>(skybox, "texture", "null")), header.SkyboxTexture);
+			glm::quat orientation = JsonGet(skybox, "orientation", glm::quat(glm::vec3(0.0f)));
+			header.SkyboxOrientation[0] = orientation.x;
+			header.SkyboxOrientation[1] = orientation.y;
+			header.SkyboxOrientation[2] = orientation.z;
+			header.SkyboxOrientation[3] = orientation.w;
+		}
+
+		// The objects list is already flat, the nested children in each object are only there for
+		// readability so we skip them
+		if (scene.contains("objects") && scene["objects"].is_array()) {
+			for (const nlohmann::json& object : scene["objects"]) {
+				uint32_t flags = 0;
+				flags |= JsonGet(object, "hide_in_inspector", false) ? HideInHierarchy : 0;
+				flags |= JsonGet(object, "active", true) ? Active : 0;
+
+				writer.BeginObject(
+					object["name"].get<std::string>(),
+					Guid(object["guid"].get<std::string>()),
+					Guid(JsonGet<std::string>(object, "parent", "null")),
+					object["position"].get<glm::vec3>(),
+					object["rotation"].get<glm::quat>(),
+					object["scale"].get<glm::vec3>(),
+					flags
+				);
+
+				if (object.contains("components") && object["components"].is_object()) {
+					for (auto& [typeName, blob] : object["components"].items()) {
+						writer.AddComponent(typeName, blob);
+					}
+				}
+			}
+		}
+
+		return writer.Finish();
+	}
+
+	nlohmann::json SceneBinary::BinaryToJson(const uint8_t* data, size_t size) {
+		Reader reader(data, size);
+		if (!reader.IsValid()) {
+			return nlohmann::json();
+		}
+
+		const Header& header = reader.GetHeader();
+		nlohmann::json result;
+		result["default_material"] = GuidToJson(header.DefaultMaterial);
+		result["ambient"] = glm::vec3(header.AmbientLight[0], header.AmbientLight[1], header.AmbientLight[2]);
+		if (header.Flags & HasSkybox) {
+			result["skybox"] = nlohmann::json();
+			result["skybox"]["mesh"] = GuidToJson(header.SkyboxMesh);
+			result["skybox"]["shader"] = GuidToJson(header.SkyboxShader);
+			result["skybox"]["texture"] = GuidToJson(header.SkyboxTexture);
+			result["skybox"]["orientation"] = glm::quat(header.SkyboxOrientation[3], header.SkyboxOrientation[0], header.SkyboxOrientation[1], header.SkyboxOrientation[2]);
+		}
+
+		// Decode all of the objects without their children first
+		std::vector<nlohmann::json> objects;
+		objects.reserve(reader.NumObjects());
+		std::vector<ComponentBlob> components;
+		for (uint32_t ix = 0; ix < reader.NumObjects(); ix++) {
+			const ObjectRecord& record = reader.GetRecord(ix);
+			Guid guid = ReadGuid(record.Guid);
+
+			nlohmann::json object = {
+				{ "name", std::string(reader.GetName(record)) },
+				{ "guid", guid.str() },
+				{ "position", glm::vec3(record.Position[0], record.Position[1], record.Position[2]) },
+				{ "rotation", glm::quat(record.Rotation[3], record.Rotation[0], record.Rotation[1], record.Rotation[2]) },
+				{ "scale",    glm::vec3(record.Scale[0], record.Scale[1], record.Scale[2]) },
+				{ "parent",   GuidToJson(record.Parent) },
+				{ "hide_in_inspector", (record.Flags & HideInHierarchy) != 0 },
+				{ "active", (record.Flags & Active) != 0 }
+			};
+			object["components"] = nlohmann::json();
+			if (!reader.GetComponents(record, components)) {
+				LOG_WARN("Component data for object {} is corrupted, skipping components", guid.str());
+				components.clear();
+			}
+			for (const ComponentBlob& component : components) {
+				nlohmann::json blob;
+				if (component.Decode(blob, guid)) {
+					object["components"][std::string(component.TypeName)] = std::move(blob);
+				}
+			}
+
+			objects.push_back(std::move(object));
+		}
+
+		// Match Scene::ToJson, which nests a full copy of each child in its parent
+		result["objects"] = SceneDelta::NestChildren(objects);
+
+		result["main_camera"] = GuidToJson(header.MainCamera);
+		return result;
+	}
+
+	bool SceneBinary::ConvertFile(const std::string& inputPath, const std::string& outputPath) {
+		FileData::Sptr input = FileHelpers::OpenFile(inputPath);
+		if (input == nullptr) {
+			return false;
+		}
+
+		if (IsBinaryScene(input->Data(), input->Size())) {
+			nlohmann::json scene = BinaryToJson(input->Data(), input->Size());
+			if (scene.is_null()) {
+				LOG_ERROR("Failed to read binary scene '{}'", inputPath);
+				return false;
+			}
+			FileHelpers::WriteContentsToFile(outputPath, scene.dump(1, '\t'));
+		} else {
+			nlohmann::json scene = nlohmann::json::parse(input->Data(), input->Data() + input->Size());
+			std::vector<uint8_t> binary = JsonToBinary(scene);
+			if (!FileHelpers::WriteBinaryToFile(outputPath, binary.data(), binary.size())) {
+				return false;
+			}
+		}
+
+		LOG_INFO("Converted scene \"{}\" to \"{}\"", inputPath, outputPath);
+		return true;
+	}
+
+	void SceneBinary::WriteGuid(const Guid& guid, uint8_t* bytes) {
+		memcpy(bytes, guid.bytes(), 16);
+	}
+
+	Guid SceneBinary::ReadGuid(const uint8_t* bytes) {
+		uint8_t copy[16];
+		memcpy(copy, bytes, 16);
+		return Guid::FromBytes(copy);
+	}
+}
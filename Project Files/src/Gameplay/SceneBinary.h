@@ -0,0 +1,210 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+#include "json.hpp"
+#include "GLM/glm.hpp"
+#include "GLM/gtc/quaternion.hpp"
+
+#include "Utils/GUID.hpp"
+
+namespace Gameplay {
+	/// <summary>
+	/// Versioned binary version of the scene format, designed to be read straight out of a memory
+	/// mapped file without building a JSON document for the whole scene.
+	///
+	/// Layout (all values are little endian, and all offsets are from the start of the file):
+	///   Header
+	///   ObjectRecord[Header.ObjectCount]     - fixed size, so they can be indexed directly
+	///   Data section, referenced by the records:
+	///     object names (not null terminated)
+	///     per object component lists, each component being:
+	///       uint32 type name length, type name, uint32 blob length, MessagePack encoded component JSON
+	///
+	/// Components only know how to serialize themselves to JSON, so each component is stored as a
+	/// small, self-contained MessagePack blob. Everything else is stored as raw values
+	///
+	/// Use BinaryToJson and JsonToBinary (or ConvertFile) to go back and forth between this and the
+	/// JSON format, for diffing and tooling
+	/// </summary>
+	class SceneBinary {
+	public:
+		SceneBinary() = delete;
+
+		// "SCNB" when read as bytes
+		static constexpr uint32_t Magic = 0x424E4353;
+		// Bump whenever the layout changes, older versions are rejected
+		static constexpr uint32_t Version = 1;
+		// The extension that Scene::Save uses to decide to write a binary scene
+		static constexpr const char* Extension = ".bscene";
+
+		enum HeaderFlags : uint32_t {
+			HasSkybox  = 1 << 0
+		};
+
+		enum ObjectFlags : uint32_t {
+			HideInHierarchy = 1 << 0,
+			Active          = 1 << 1
+		};
+
+		struct Header {
+			uint32_t Magic;
+			uint32_t Version;
+			uint32_t ObjectCount;
+			uint32_t Flags;
+			// sizeof(Header) and sizeof(ObjectRecord) when the file was written, as a sanity check
+			uint32_t HeaderSize;
+			uint32_t RecordSize;
+			uint64_t FileSize;
+			uint8_t  DefaultMaterial[16];
+			uint8_t  MainCamera[16];
+			uint8_t  SkyboxMesh[16];
+			uint8_t  SkyboxShader[16];
+			uint8_t  SkyboxTexture[16];
+			float    AmbientLight[3];
+			// Stored as x, y, z, w
+			float    SkyboxOrientation[4];
+			uint32_t Reserved;
+		};
+
+		struct ObjectRecord {
+			uint8_t  Guid[16];
+			// All zeros if the object has no parent
+			uint8_t  Parent[16];
+			float    Position[3];
+			// Stored as x, y, z, w
+			float    Rotation[4];
+			float    Scale[3];
+			uint32_t Flags;
+			uint32_t NameLength;
+			uint32_t ComponentCount;
+			uint32_t Reserved;
+			uint64_t NameOffset;
+			uint64_t ComponentsOffset;
+			uint64_t ComponentsSize;
+		};
+
+		static_assert(std::is_trivially_copyable<Header>::value && sizeof(Header) == 144, "Scene binary header layout has changed, bump the version!");
+		static_assert(std::is_trivially_copyable<ObjectRecord>::value && sizeof(ObjectRecord) == 112, "Scene binary record layout has changed, bump the version!");
+
+		/// <summary>
+		/// A single component as stored in the file, the data points into the file's memory
+		/// </summary>
+		struct ComponentBlob {
+			std::string_view TypeName;
+			const uint8_t*   Data;
+			size_t           Size;
+
+			/// <summary>
+			/// Decodes the component's JSON from the blob. Corrupt blobs are logged and skipped, rather
+			/// than taking down the rest of the load
+			/// </summary>
+			/// <param name="result">Receives the component's JSON</param>
+			/// <param name="owner">The GUID of the object the component belongs to, for logging</param>
+			/// <returns>True if the blob was decoded, false if it is corrupt</returns>
+			bool Decode(nlohmann::json& result, const Guid& owner) const;
+		};
+
+		/// <summary>
+		/// Builds a binary scene in memory, one object at a time
+		/// </summary>
+		class Writer {
+		public:
+			Writer();
+
+			/// <summary>
+			/// The header for the scene, the writer fills in the magic, version, sizes and counts
+			/// </summary>
+			Header SceneHeader;
+
+			/// <summary>
+			/// Starts a new object, components added after this will belong to it
+			/// </summary>
+			void BeginObject(const std::string& name, const Guid& guid, const Guid& parent, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale, uint32_t flags);
+			/// <summary>
+			/// Adds a component to the last object that was started
+			/// </summary>
+			/// <param name="typeName">The component's type name, as in ComponentTypeName</param>
+			/// <param name="blob">The component's JSON, including the base IComponent fields</param>
+			void AddComponent(const std::string& typeName, const nlohmann::json& blob);
+
+			/// <summary>
+			/// Assembles the header, records and data into the final file contents
+			/// </summary>
+			std::vector<uint8_t> Finish();
+
+		protected:
+			std::vector<ObjectRecord> _records;
+			// Offsets in here are relative to the start of the data section until Finish
+			std::vector<uint8_t>      _data;
+		};
+
+		/// <summary>
+		/// Validates and provides access to a binary scene in memory, nothing is copied out of the
+		/// memory so it must outlive the reader
+		/// </summary>
+		class Reader {
+		public:
+			Reader(const uint8_t* data, size_t size);
+
+			/// <summary>
+			/// Returns true if the data is a binary scene of the current version, and all of the
+			/// records point inside of the data
+			/// </summary>
+			bool IsValid() const { return _isValid; }
+
+			const Header& GetHeader() const;
+			uint32_t NumObjects() const;
+			const ObjectRecord& GetRecord(uint32_t index) const;
+			std::string_view GetName(const ObjectRecord& record) const;
+
+			/// <summary>
+			/// Reads the list of components for an object
+			/// </summary>
+			/// <param name="record">The object to read the components for</param>
+			/// <param name="result">Cleared, then filled with the object's components</param>
+			/// <returns>False if the component list is corrupted</returns>
+			bool GetComponents(const ObjectRecord& record, std::vector<ComponentBlob>& result) const;
+
+		protected:
+			const uint8_t* _data;
+			size_t         _size;
+			bool           _isValid;
+
+			bool _InBounds(uint64_t offset, uint64_t size) const;
+		};
+
+		/// <summary>
+		/// Returns true if the data starts with the binary scene magic number (of any version)
+		/// </summary>
+		static bool IsBinaryScene(const uint8_t* data, size_t size);
+
+		/// <summary>
+		/// Converts a scene in the JSON format (as from Scene::ToJson) to the binary format
+		/// </summary>
+		static std::vector<uint8_t> JsonToBinary(const nlohmann::json& scene);
+		/// <summary>
+		/// Converts a binary scene back into the JSON format, the result can be loaded with Scene::FromJson
+		/// </summary>
+		/// <returns>The scene's JSON, or a null JSON value if the data is not a valid binary scene</returns>
+		static nlohmann::json BinaryToJson(const uint8_t* data, size_t size);
+		/// <summary>
+		/// Converts a scene file between the JSON and binary formats, the direction is decided by
+		/// the contents of the input file
+		/// </summary>
+		/// <param name="inputPath">The path of the scene to convert</param>
+		/// <param name="outputPath">The path to write the converted scene to</param>
+		/// <returns>True if the scene was converted</returns>
+		static bool ConvertFile(const std::string& inputPath, const std::string& outputPath);
+
+		/// <summary>
+		/// Helpers for going between GUIDs and raw bytes
+		/// </summary>
+		static void WriteGuid(const Guid& guid, uint8_t* bytes);
+		static Guid ReadGuid(const uint8_t* bytes);
+	};
+}
@@ -0,0 +1,190 @@
+#include "Gameplay/SceneDelta.h"
+#include <filesystem>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <Logging.h>
+
+#include "Gameplay/SceneBinary.h"
+#include "Utils/FileHelpers.h"
+
+namespace Gameplay {
+	bool SceneDelta::IsDelta(const nlohmann::json& blob) {
+		return blob.is_object() && blob.contains("delta_version") && blob["delta_version"] == Version;
+	}
+
+	nlohmann::json SceneDelta::Apply(nlohmann::json scene, const nlohmann::json& delta) {
+		if (!IsDelta(delta)) {
+			LOG_WARN("Not a version {} scene delta, ignoring", Version);
+			return scene;
+		}
+
+		// The settings are always stored in full
+		if (delta.contains("settings") && delta["settings"].is_object()) {
+			for (auto& [key, value] : delta["settings"].items()) {
+				scene[key] = value;
+			}
+		}
+
+		std::unordered_set<std::string> removed;
+		if (delta.contains("removed") && delta["removed"].is_array()) {
+			for (const auto& guid : delta["removed"]) {
+				removed.insert(guid.get<std::string>());
+			}
+		}
+
+		// Maps the GUIDs of changed objects to their index in the delta, cleared as they are used
+		static const nlohmann::json noObjects = nlohmann::json::array();
+		const nlohmann::json& changed = delta.contains("objects") && delta["objects"].is_array() ? delta["objects"] : noObjects;
+		std::unordered_map<std::string, size_t> changedIndices;
+		for (size_t ix = 0; ix < changed.size(); ix++) {
+			changedIndices[changed[ix]["guid"].get<std::string>()] = ix;
+		}
+		std::vector<bool> isUsed(changed.size(), false);
+
+		// Modified objects stay where they were, since the scene keeps its objects in order
+		std::vector<nlohmann::json> objects;
+		if (scene.contains("objects") && scene["objects"].is_array()) {
+			objects.reserve(scene["objects"].size() + changed.size());
+			for (auto& object : scene["objects"]) {
+				std::string guid = object["guid"].get<std::string>();
+				if (removed.count(guid) > 0) {
+					continue;
+				}
+
+				auto it = changedIndices.find(guid);
+				if (it != changedIndices.end()) {
+					objects.push_back(changed[it->second]);
+					isUsed[it->second] = true;
+				} else {
+					object.erase("children");
+					objects.push_back(std::move(object));
+				}
+			}
+		}
+
+		// Anything left over was added since the last checkpoint, new objects always go at the end of the scene
+		for (size_t ix = 0; ix < changed.size(); ix++) {
+			if (!isUsed[ix]) {
+				objects.push_back(changed[ix]);
+			}
+		}
+
+		// Parents may have changed, so the nested children are rebuilt from scratch
+		scene["objects"] = NestChildren(objects);
+		return scene;
+	}
+
+	nlohmann::json SceneDelta::Compact(nlohmann::json base, const std::vector<nlohmann::json>& deltas) {
+		for (const auto& delta : deltas) {
+			base = Apply(std::move(base), delta);
+		}
+		return base;
+	}
+
+	std::string SceneDelta::GetDeltaPath(const std::string& basePath, uint32_t index) {
+		std::filesystem::path path = basePath;
+		path.replace_filename(path.stem().string() + ".delta" + std::to_string(index) + ".json");
+		return path.string();
+	}
+
+	nlohmann::json SceneDelta::LoadChain(const std::string& basePath, uint32_t* numDeltas, bool* isBinary) {
+		FileData::Sptr file = FileHelpers::OpenFile(basePath);
+		if (file == nullptr) {
+			return nlohmann::json();
+		}
+
+		// Autosaves are read after a crash, so a half written file is a real possibility
+		try {
+			nlohmann::json result;
+			bool isBinaryScene = SceneBinary::IsBinaryScene(file->Data(), file->Size());
+			if (isBinaryScene) {
+				result = SceneBinary::BinaryToJson(file->Data(), file->Size());
+			} else {
+				result = nlohmann::json::parse(file->Data(), file->Data() + file->Size());
+			}
+			file = nullptr;
+
+			// Deltas are numbered in order, the chain ends at the first one that's missing
+			uint32_t index = 1;
+			for (; FileHelpers::Exists(GetDeltaPath(basePath, index)); index++) {
+				nlohmann::json delta = nlohmann::json::parse(FileHelpers::ReadFile(GetDeltaPath(basePath, index)));
+				result = Apply(std::move(result), delta);
+			}
+
+			if (numDeltas != nullptr) {
+				*numDeltas = index - 1;
+			}
+			if (isBinary != nullptr) {
+				*isBinary = isBinaryScene;
+			}
+			return result;
+		}
+		catch (const nlohmann::json::exception& e) {
+			LOG_ERROR("Failed to read scene \"{}\" or its deltas: {}", basePath, e.what());
+			return nlohmann::json();
+		}
+	}
+
+	bool SceneDelta::CompactFiles(const std::string& basePath) {
+		uint32_t numDeltas = 0;
+		bool isBinary = false;
+		nlohmann::json scene = LoadChain(basePath, &numDeltas, &isBinary);
+		if (scene.is_null()) {
+			LOG_ERROR("Failed to read scene \"{}\" for compaction", basePath);
+			return false;
+		}
+
+		// Write the full scene before removing any deltas, so we never lose data if something goes wrong.
+		// Loading detects binary scenes by their header, so the base has to stay in its own format
+		if (isBinary) {
+			std::vector<uint8_t> data = SceneBinary::JsonToBinary(scene);
+			if (!FileHelpers::WriteBinaryToFile(basePath, data.data(), data.size())) {
+				LOG_ERROR("Failed to write compacted scene \"{}\"", basePath);
+				return false;
+			}
+		} else {
+			FileHelpers::WriteContentsToFile(basePath, scene.dump(1, '\t'));
+		}
+		for (uint32_t ix = 1; ix <= numDeltas; ix++) {
+			std::filesystem::remove(GetDeltaPath(basePath, ix));
+		}
+
+		LOG_INFO("Compacted {} deltas into \"{}\"", numDeltas, basePath);
+		return true;
+	}
+
+	std::vector<nlohmann::json> SceneDelta::NestChildren(const std::vector<nlohmann::json>& objects) {
+		std::unordered_map<std::string, size_t> indices;
+		for (size_t ix = 0; ix < objects.size(); ix++) {
+			indices[objects[ix]["guid"].get<std::string>()] = ix;
+		}
+
+		// Parents are not guaranteed to come before their children, so collect children in a second pass
+		std::vector<std::vector<size_t>> children(objects.size());
+		for (size_t ix = 0; ix < objects.size(); ix++) {
+			if (objects[ix].contains("parent") && objects[ix]["parent"].is_string()) {
+				auto it = indices.find(objects[ix]["parent"].get<std::string>());
+				if (it != indices.end()) {
+					children[it->second].push_back(ix);
+				}
+			}
+		}
+
+		std::function<nlohmann::json(size_t)> buildObject = [&](size_t index) {
+			nlohmann::json object = objects[index];
+			object["children"] = std::vector<nlohmann::json>();
+			for (size_t child : children[index]) {
+				object["children"].push_back(buildObject(child));
+			}
+			return object;
+		};
+
+		std::vector<nlohmann::json> result;
+		result.reserve(objects.size());
+		for (size_t ix = 0; ix < objects.size(); ix++) {
+			result.push_back(buildObject(ix));
+		}
+		return result;
+	}
+}
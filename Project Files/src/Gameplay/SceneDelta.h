@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "json.hpp"
+
+namespace Gameplay {
+	/// <summary>
+	/// Helpers for working with scene deltas, which record only what has changed in a scene since its
+	/// last checkpoint (see Scene::ToDeltaJson and Scene::SaveDelta). A delta looks like:
+	///
+	///   {
+	///     "delta_version": 1,
+	///     "settings": { ... },  - the scene wide settings, these are tiny so they are always stored
+	///     "objects":  [ ... ],  - objects added or modified since the checkpoint, without nested children
+	///     "removed":  [ ... ]   - GUIDs of the objects removed since the checkpoint
+	///   }
+	///
+	/// Applying a chain of deltas on top of the full scene they started from gives the same scene as a
+	/// full save made at the time of the last delta. Compacting folds the chain back into a full scene
+	/// </summary>
+	class SceneDelta {
+	public:
+		SceneDelta() = delete;
+
+		// Bump whenever the format changes, older versions are rejected
+		static constexpr uint32_t Version = 1;
+
+		/// <summary>
+		/// Returns true if the JSON is a scene delta of the current version, rather than a full scene
+		/// </summary>
+		static bool IsDelta(const nlohmann::json& blob);
+
+		/// <summary>
+		/// Applies a delta on top of a full scene
+		/// </summary>
+		/// <param name="scene">The full scene (as from Scene::ToJson) that the delta was made against</param>
+		/// <param name="delta">The delta to apply</param>
+		/// <returns>The full scene with the delta applied, can be loaded with Scene::FromJson</returns>
+		static nlohmann::json Apply(nlohmann::json scene, const nlohmann::json& delta);
+		/// <summary>
+		/// Applies a chain of deltas, in order, on top of a full scene
+		/// </summary>
+		static nlohmann::json Compact(nlohmann::json base, const std::vector<nlohmann::json>& deltas);
+
+		/// <summary>
+		/// Gets the path that the Nth delta for a full scene file is stored at, deltas are numbered from 1
+		/// </summary>
+		static std::string GetDeltaPath(const std::string& basePath, uint32_t index);
+		/// <summary>
+		/// Loads a full scene file (JSON or binary), along with all of the delta files stored next to it
+		/// </summary>
+		/// <param name="basePath">The path to the full scene</param>
+		/// <param name="numDeltas">If not null, receives the number of deltas that were applied</param>
+		/// <param name="isBinary">If not null, receives whether the full scene is a binary scene</param>
+		/// <returns>The scene with all the deltas applied, or a null JSON value if any of the files could not be read</returns>
+		static nlohmann::json LoadChain(const std::string& basePath, uint32_t* numDeltas = nullptr, bool* isBinary = nullptr);
+		/// <summary>
+		/// Folds all of the delta files for a full scene file back into the full scene, and deletes them
+		/// </summary>
+		/// <param name="basePath">The path to the full scene, will be overwritten in the format it was already in</param>
+		/// <returns>True if the scene was compacted</returns>
+		static bool CompactFiles(const std::string& basePath);
+
+		/// <summary>
+		/// Takes a list of objects without their children and nests a full copy of each object's
+		/// children in it, matching the layout of Scene::ToJson
+		/// </summary>
+		static std::vector<nlohmann::json> NestChildren(const std::vector<nlohmann::json>& objects);
+	};
+}
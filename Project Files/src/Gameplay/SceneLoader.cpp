@@ -0,0 +1,213 @@
+#include "Gameplay/SceneLoader.h"
+
+#include <GLFW/glfw3.h>
+#include <filesystem>
+
+#include "Logging.h"
+#include "Utils/JobSystem.h"
+#include "Utils/FileHelpers.h"
+#include "Utils/ResourceManager/ResourceManager.h"
+#include "Gameplay/SceneBinary.h"
+
+namespace Gameplay {
+	SceneLoader::SceneLoader(const std::string& path) :
+		_path(path),
+		_state(LoadState::Parsing),
+		_completedSteps(0),
+		_totalSteps(0),
+		_hasManifest(false),
+		_manifest(nlohmann::ordered_json()),
+		_resources(std::vector<ResourceEntry>()),
+		_sceneFile(nullptr),
+		_reader(nullptr),
+		_isBinary(false),
+		_sceneJson(nlohmann::json()),
+		_numObjects(0),
+		_nextResource(0),
+		_nextObject(0),
+		_scene(nullptr)
+	{ }
+
+	SceneLoader::Sptr SceneLoader::Start(const std::string& path) {
+		SceneLoader::Sptr result(new SceneLoader(path));
+
+		// The job keeps the loader alive, in case the load is abandoned before it's done parsing. It goes in
+		// the background queue so the main thread never picks it up while helping in Scene::Update
+		JobSystem::SubmitBackground([result]() {
+			result->_Parse();
+		});
+
+		return result;
+	}
+
+	bool SceneLoader::Update(double budget) {
+		LoadState state = _state;
+		if (state == LoadState::Parsing) {
+			return false;
+		}
+
+		double start = glfwGetTime();
+		while (state == LoadState::Uploading || state == LoadState::Building) {
+			_RunStep();
+			state = _state;
+
+			if (glfwGetTime() - start >= budget) {
+				break;
+			}
+		}
+
+		return state == LoadState::Done || state == LoadState::Failed;
+	}
+
+	float SceneLoader::GetProgress() const {
+		if (_state == LoadState::Done) {
+			return 1.0f;
+		}
+		size_t total = _totalSteps;
+		return total > 0 ? static_cast<float>(_completedSteps) / static_cast<float>(total) : 0.0f;
+	}
+
+	void SceneLoader::_Parse() {
+		// Indices into _resources of the resources that can decode their files ahead of time
+		std::vector<size_t> resourcesToDecode;
+
+		try {
+			std::string manifestPath = std::filesystem::path(_path).stem().string() + "-manifest.json";
+			if (FileHelpers::Exists(manifestPath)) {
+				LOG_INFO("Loading manifest from \"{}\"", manifestPath);
+				FileData::Sptr file = FileHelpers::OpenFile(manifestPath);
+				if (file != nullptr) {
+					_manifest = nlohmann::ordered_json::parse(file->Data(), file->Data() + file->Size());
+					_hasManifest = true;
+				}
+			}
+
+			// Flatten the manifest, keeping its order so that dependencies are loaded before the resources that use them
+			if (_hasManifest) {
+				for (auto& [typeName, items] : _manifest.items()) {
+					bool canPreload = ResourceManager::CanPreload(typeName);
+					for (auto& [guid, blob] : items.items()) {
+						if (canPreload) {
+							resourcesToDecode.push_back(_resources.size());
+						}
+						_resources.push_back({ typeName, blob });
+					}
+				}
+			}
+
+			LOG_INFO("Loading scene from \"{}\"", _path);
+			_sceneFile = FileHelpers::OpenFile(_path);
+			if (_sceneFile == nullptr) {
+				_state = LoadState::Failed;
+				return;
+			}
+
+			_isBinary = SceneBinary::IsBinaryScene(_sceneFile->Data(), _sceneFile->Size());
+			if (_isBinary) {
+				_reader = std::make_unique<SceneBinary::Reader>(_sceneFile->Data(), _sceneFile->Size());
+				if (!_reader->IsValid()) {
+					LOG_ERROR("\"{}\" is not a valid version {} binary scene", _path, SceneBinary::Version);
+					_state = LoadState::Failed;
+					return;
+				}
+				_numObjects = _reader->NumObjects();
+			} else {
+				_sceneJson = nlohmann::json::parse(_sceneFile->Data(), _sceneFile->Data() + _sceneFile->Size());
+				// The JSON has everything we need now, so we can let go of the file
+				_sceneFile = nullptr;
+				if (!_sceneJson.contains("objects") || !_sceneJson["objects"].is_array()) {
+					LOG_ERROR("Objects not present in scene \"{}\"", _path);
+					_state = LoadState::Failed;
+					return;
+				}
+				_numObjects = _sceneJson["objects"].size();
+			}
+		}
+		catch (const nlohmann::json::exception& e) {
+			LOG_ERROR("Failed to parse scene \"{}\": {}", _path, e.what());
+			_state = LoadState::Failed;
+			return;
+		}
+
+		// Parsing counts as a step, so that the progress bar moves even for scenes with no assets
+		_totalSteps = 1 + resourcesToDecode.size() + _resources.size() + _numObjects;
+		_completedSteps++;
+
+		// Decode all the asset files in parallel, the resource types will pick up the decoded data when they load
+		JobSystem::ParallelFor(resourcesToDecode.size(), [&](size_t begin, size_t end) {
+			for (size_t ix = begin; ix < end; ix++) {
+				const ResourceEntry& entry = _resources[resourcesToDecode[ix]];
+				ResourceManager::PreloadResource(entry.TypeName, entry.Blob);
+				_completedSteps++;
+			}
+		}, 1);
+
+		_state = LoadState::Uploading;
+	}
+
+	void SceneLoader::_RunStep() {
+		if (_state == LoadState::Uploading) {
+			if (_nextResource == 0 && _hasManifest) {
+				ResourceManager::SetManifest(_manifest);
+			}
+
+			if (_nextResource < _resources.size()) {
+				const ResourceEntry& entry = _resources[_nextResource++];
+				ResourceManager::LoadResource(entry.TypeName, entry.Blob);
+				_completedSteps++;
+			}
+
+			if (_nextResource >= _resources.size()) {
+				// Anything that was decoded but not used by a resource is no longer needed
+				ResourceManager::ClearPreloadedResources();
+				_resources.clear();
+
+				_BeginBuilding();
+			}
+		}
+		else if (_state == LoadState::Building) {
+			if (_nextObject < _numObjects) {
+				if (_isBinary) {
+					_scene->_AddLoadedObject(GameObject::FromBinary(_scene.get(), *_reader, _reader->GetRecord(static_cast<uint32_t>(_nextObject))));
+				} else {
+					_scene->_AddLoadedObject(GameObject::FromJson(_scene.get(), _sceneJson["objects"][_nextObject]));
+				}
+				_nextObject++;
+				_completedSteps++;
+			}
+
+			if (_nextObject >= _numObjects) {
+				_FinishBuilding();
+			}
+		}
+	}
+
+	void SceneLoader::_BeginBuilding() {
+		// Scene settings refer to resources, so they can only be loaded once the resources are
+		_scene = Scene::_CreateForLoading();
+		if (_isBinary) {
+			_scene->_LoadSettings(_reader->GetHeader());
+		} else {
+			_scene->_LoadSettings(_sceneJson);
+		}
+		_scene->_objects.reserve(_numObjects);
+		_state = LoadState::Building;
+	}
+
+	void SceneLoader::_FinishBuilding() {
+		if (_isBinary) {
+			_scene->_FinishLoading(SceneBinary::ReadGuid(_reader->GetHeader().MainCamera));
+		} else {
+			_scene->_FinishLoading(Guid(_sceneJson["main_camera"]));
+		}
+		_scene->_filePath = _path;
+
+		// We're done with the file contents
+		_reader = nullptr;
+		_sceneFile = nullptr;
+		_sceneJson = nlohmann::json();
+		_manifest = nlohmann::ordered_json();
+
+		_state = LoadState::Done;
+	}
+}
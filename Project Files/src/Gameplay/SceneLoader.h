@@ -0,0 +1,119 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <atomic>
+
+#include "json.hpp"
+#include "Gameplay/Scene.h"
+#include "Gameplay/SceneBinary.h"
+#include "Utils/FileData.h"
+
+namespace Gameplay {
+	/// <summary>
+	/// Loads a scene and its resource manifest in the background, so that the application can keep
+	/// rendering while a scene is loading
+	///
+	/// Loading happens in three stages:
+	///   Parsing   - on a worker thread, the manifest and scene files are read and parsed, and any
+	///               asset files that can be decoded without OpenGL (images, OBJ meshes, shader
+	///               sources) are decoded in parallel, see ResourceManager::PreloadResource
+	///   Uploading - on the main thread, resources are created from the manifest, which uploads the
+	///               decoded data to the GPU (and compiles shaders)
+	///   Building  - on the main thread, the scene's objects and components are created
+	///
+	/// The main thread stages are split into small steps, and Update only runs as many steps as it
+	/// can fit in the given time budget, so loads are spread across frames
+	/// </summary>
+	class SceneLoader {
+	public:
+		typedef std::shared_ptr<SceneLoader> Sptr;
+
+		enum class LoadState {
+			Parsing,
+			Uploading,
+			Building,
+			Done,
+			Failed
+		};
+
+		~SceneLoader() = default;
+
+		SceneLoader(const SceneLoader& other) = delete;
+		SceneLoader& operator=(const SceneLoader& other) = delete;
+
+		/// <summary>
+		/// Starts loading a scene in the background, along with the manifest next to it (if any)
+		/// </summary>
+		/// <param name="path">The path of the JSON or binary scene file to load</param>
+		static SceneLoader::Sptr Start(const std::string& path);
+
+		/// <summary>
+		/// Runs the main thread part of the load, must be called once per frame from the main thread
+		/// until it returns true. At least one step is run per call, so the load always progresses
+		/// </summary>
+		/// <param name="budget">The time in seconds that we can spend loading this frame</param>
+		/// <returns>True if the load has finished or failed</returns>
+		bool Update(double budget);
+
+		/// <summary>
+		/// Gets how much of the load has been completed, between 0 and 1
+		/// </summary>
+		float GetProgress() const;
+		LoadState GetState() const { return _state; }
+		const std::string& GetPath() const { return _path; }
+
+		/// <summary>
+		/// Gets the loaded scene once the load is done, or nullptr if it has not finished or failed
+		/// </summary>
+		const Scene::Sptr& GetScene() const { return _scene; }
+
+	protected:
+		SceneLoader(const std::string& path);
+
+		struct ResourceEntry {
+			std::string    TypeName;
+			nlohmann::json Blob;
+		};
+
+		std::string _path;
+		std::atomic<LoadState> _state;
+
+		// Progress tracking, the total is only known once parsing has finished
+		std::atomic<size_t> _completedSteps;
+		std::atomic<size_t> _totalSteps;
+
+		// Output from the parsing stage
+		bool                         _hasManifest;
+		nlohmann::ordered_json       _manifest;
+		std::vector<ResourceEntry>   _resources;
+		FileData::Sptr               _sceneFile;
+		// Only set for binary scenes, reads straight out of the scene file
+		std::unique_ptr<SceneBinary::Reader> _reader;
+		bool                         _isBinary;
+		nlohmann::json               _sceneJson;
+		size_t                       _numObjects;
+
+		// Where we're up to in the main thread stages
+		size_t      _nextResource;
+		size_t      _nextObject;
+		Scene::Sptr _scene;
+
+		/// <summary>
+		/// Runs the parsing stage, called on a worker thread
+		/// </summary>
+		void _Parse();
+		/// <summary>
+		/// Runs a single main thread step, creating a resource or an object
+		/// </summary>
+		void _RunStep();
+		/// <summary>
+		/// Creates the scene that objects will be built into
+		/// </summary>
+		void _BeginBuilding();
+		/// <summary>
+		/// Links up the loaded objects and frees everything that was only needed for loading
+		/// </summary>
+		void _FinishBuilding();
+	};
+}
@@ -0,0 +1,112 @@
+#include "Gameplay/TimerWheel.h"
+#include <cmath>
+#include <algorithm>
+
+namespace Gameplay {
+	static_assert((TimerWheel::NumSlots & (TimerWheel::NumSlots - 1)) == 0, "Timer wheel slot count must be a power of two");
+
+	TimerWheel::TimerWheel() :
+		_slots(NumSlots),
+		_expired(std::vector<Timer*>()),
+		_nextExpired(0),
+		_time(0.0),
+		_currentTick(0),
+		_count(0)
+	{ }
+
+	void TimerWheel::Schedule(Timer* timer, double time) {
+		Cancel(timer);
+
+		// Always land at least one tick in the future, so a timer re-scheduling itself while we're
+		// handling expired timers can't expire again in the same frame
+		double ticks = std::ceil(time / TickLength);
+		uint64_t dueTick = ticks > (double)_currentTick ? (uint64_t)ticks : _currentTick + 1;
+
+		std::vector<Timer*>& slot = _slots[dueTick & (NumSlots - 1)];
+		timer->DueTick = dueTick;
+		timer->Slot = static_cast<uint32_t>(dueTick & (NumSlots - 1));
+		timer->Index = static_cast<uint32_t>(slot.size());
+		slot.push_back(timer);
+		_count++;
+	}
+
+	void TimerWheel::Cancel(Timer* timer) {
+		if (timer->Slot == NotScheduled) {
+			return;
+		}
+
+		if (timer->Slot == Expired) {
+			// Someone may be part way through popping the list, so just leave a hole
+			_expired[timer->Index] = nullptr;
+		} else {
+			_SwapRemove(_slots[timer->Slot], timer);
+		}
+		timer->Slot = NotScheduled;
+		_count--;
+	}
+
+	void TimerWheel::Advance(double dt) {
+		_time += dt;
+		uint64_t targetTick = (uint64_t)(_time / TickLength);
+
+		// If we've fallen more than a full turn behind (ex: after a long hitch), every slot needs to be
+		// visited exactly once, otherwise we only need the slots for the ticks that have passed
+		uint64_t numTicks = std::min<uint64_t>(targetTick - std::min(targetTick, _currentTick), NumSlots);
+		for (uint64_t tick = _currentTick + 1; tick <= _currentTick + numTicks; tick++) {
+			std::vector<Timer*>& slot = _slots[tick & (NumSlots - 1)];
+			for (size_t ix = 0; ix < slot.size(); ) {
+				Timer* timer = slot[ix];
+				if (timer->DueTick <= targetTick) {
+					// Swap removal puts a new timer at ix, so don't advance
+					_SwapRemove(slot, timer);
+					timer->Slot = Expired;
+					timer->Index = static_cast<uint32_t>(_expired.size());
+					_expired.push_back(timer);
+				} else {
+					ix++;
+				}
+			}
+		}
+		_currentTick = std::max(_currentTick, targetTick);
+	}
+
+	TimerWheel::Timer* TimerWheel::PopExpired() {
+		while (_nextExpired < _expired.size()) {
+			Timer* timer = _expired[_nextExpired++];
+			if (timer != nullptr) {
+				timer->Slot = NotScheduled;
+				_count--;
+				return timer;
+			}
+		}
+
+		// Everything has been handled, reset for the next advance
+		_expired.clear();
+		_nextExpired = 0;
+		return nullptr;
+	}
+
+	void TimerWheel::Clear() {
+		for (auto& slot : _slots) {
+			for (Timer* timer : slot) {
+				timer->Slot = NotScheduled;
+			}
+			slot.clear();
+		}
+		for (Timer* timer : _expired) {
+			if (timer != nullptr) {
+				timer->Slot = NotScheduled;
+			}
+		}
+		_expired.clear();
+		_nextExpired = 0;
+		_count = 0;
+	}
+
+	void TimerWheel::_SwapRemove(std::vector<Timer*>& list, Timer* timer) {
+		Timer* last = list.back();
+		list[timer->Index] = last;
+		last->Index = timer->Index;
+		list.pop_back();
+	}
+}
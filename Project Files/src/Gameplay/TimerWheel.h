@@ -0,0 +1,109 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Gameplay {
+	class IComponent;
+
+	/// <summary>
+	/// A hashed timer wheel, used by the scene to wake up components that are sleeping or updating at
+	/// a reduced rate. Time is split into fixed length ticks, and each timer lives in the slot for the
+	/// tick it is due on (wrapping around the wheel). Advancing the wheel only visits the slots for the
+	/// ticks that have passed, so timers that are not due yet cost nothing, and scheduling or cancelling
+	/// a timer is constant time
+	///
+	/// Timers that are further away than a full turn of the wheel share a slot with nearer timers, and
+	/// are simply skipped until their turn comes around
+	///
+	/// NOTE: None of this is thread safe, the wheel should only be touched from the main thread
+	/// </summary>
+	class TimerWheel {
+	public:
+		// Slot index for timers that are not on the wheel
+		static constexpr uint32_t NotScheduled = UINT32_MAX;
+		// Slot index for timers that have expired, but have not been popped yet
+		static constexpr uint32_t Expired = UINT32_MAX - 1;
+		// The length of a single tick, in seconds. Timers are rounded up to the next tick
+		static constexpr double TickLength = 1.0 / 100.0;
+		// Must be a power of two, at 100 ticks per second this covers a little over 5 seconds per turn
+		static constexpr uint32_t NumSlots = 512;
+
+		/// <summary>
+		/// A single timer that can be placed on the wheel. Timers are embedded in the objects that own
+		/// them, so scheduling never allocates (beyond growing the slots)
+		/// </summary>
+		struct Timer {
+			// The component that owns the timer
+			IComponent* Component = nullptr;
+			// The tick that the timer will expire on
+			uint64_t    DueTick   = 0;
+			// The slot the timer is in, or one of NotScheduled or Expired
+			uint32_t    Slot      = NotScheduled;
+			// The timer's index in its slot or in the expired list
+			uint32_t    Index     = 0;
+
+			bool IsScheduled() const { return Slot != NotScheduled; }
+		};
+
+		TimerWheel();
+		~TimerWheel() = default;
+
+		TimerWheel(const TimerWheel& other) = delete;
+		TimerWheel& operator=(const TimerWheel& other) = delete;
+
+		/// <summary>
+		/// Schedules a timer to expire at the given time, if the timer is already scheduled it will be
+		/// moved to the new time
+		/// </summary>
+		/// <param name="timer">The timer to schedule, must stay alive until it expires or is cancelled</param>
+		/// <param name="time">The time to expire at, relative to GetTime()</param>
+		void Schedule(Timer* timer, double time);
+		/// <summary>
+		/// Removes a timer from the wheel, does nothing if the timer is not scheduled
+		/// </summary>
+		void Cancel(Timer* timer);
+
+		/// <summary>
+		/// Moves time forwards, collecting all of the timers that have expired. Expired timers should
+		/// then be handled with PopExpired
+		/// </summary>
+		/// <param name="dt">The time in seconds since the last call to Advance</param>
+		void Advance(double dt);
+		/// <summary>
+		/// Gets the next expired timer, or nullptr if there are none left. The timer is no longer
+		/// scheduled once it has been popped, so it may be re-scheduled by the caller
+		/// </summary>
+		Timer* PopExpired();
+
+		/// <summary>
+		/// Gets the time that has passed on the wheel, in seconds
+		/// </summary>
+		double GetTime() const { return _time; }
+		/// <summary>
+		/// Gets the number of timers that are scheduled or waiting to be popped
+		/// </summary>
+		size_t Size() const { return _count; }
+
+		/// <summary>
+		/// Removes all timers from the wheel, without resetting the time
+		/// </summary>
+		void Clear();
+
+	protected:
+		std::vector<std::vector<Timer*>> _slots;
+		// Timers that have expired during the last Advance, cancelled timers are nulled out
+		std::vector<Timer*> _expired;
+		size_t              _nextExpired;
+
+		double   _time;
+		// The last tick that has been processed
+		uint64_t _currentTick;
+		size_t   _count;
+
+		/// <summary>
+		/// Removes a timer from the given list by swapping the last timer into its place
+		/// </summary>
+		static void _SwapRemove(std::vector<Timer*>& list, Timer* timer);
+	};
+}
@@ -0,0 +1,325 @@
+#include "Gameplay/TransformHierarchy.h"
+#include <algorithm>
+
+#include "Gameplay/GameObject.h"
+#include "Utils/GlmDefines.h"
+
+// All of our x64 targets have SSE, fall back to GLM everywhere else
+#if defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+#define TRANSFORM_HIERARCHY_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace Gameplay {
+	/// <summary>
+	/// Multiplies two column major 4x4 matrices, result must not alias either input
+	/// </summary>
+	static inline void MultiplyTransforms(const glm::mat4& lhs, const glm::mat4& rhs, glm::mat4& result) {
+		#ifdef TRANSFORM_HIERARCHY_USE_SSE
+		const float* a = &lhs[0][0];
+		const float* b = &rhs[0][0];
+		float* out = &result[0][0];
+
+		__m128 col0 = _mm_loadu_ps(a);
+		__m128 col1 = _mm_loadu_ps(a + 4);
+		__m128 col2 = _mm_loadu_ps(a + 8);
+		__m128 col3 = _mm_loadu_ps(a + 12);
+
+		// Each column of the result is the columns of lhs weighted by a column of rhs
+		for (int ix = 0; ix < 4; ix++) {
+			const float* column = b + ix * 4;
+			__m128 sum = _mm_mul_ps(col0, _mm_set1_ps(column[0]));
+			sum = _mm_add_ps(sum, _mm_mul_ps(col1, _mm_set1_ps(column[1])));
+			sum = _mm_add_ps(sum, _mm_mul_ps(col2, _mm_set1_ps(column[2])));
+			sum = _mm_add_ps(sum, _mm_mul_ps(col3, _mm_set1_ps(column[3])));
+			_mm_storeu_ps(out + ix * 4, sum);
+		}
+		#else
+		result = lhs * rhs;
+		#endif
+	}
+
+	TransformHierarchy::TransformHierarchy() :
+		_localTransforms(std::vector<glm::mat4>()),
+		_worldTransforms(std::vector<glm::mat4>()),
+		_inverseLocalTransforms(std::vector<glm::mat4>()),
+		_inverseWorldTransforms(std::vector<glm::mat4>()),
+		_parents(std::vector<uint32_t>()),
+		_subtreeEnds(std::vector<uint32_t>()),
+		_flags(std::vector<uint8_t>()),
+		_owners(std::vector<GameObject*>()),
+		_isOrderDirty(false),
+		_hasDirtyNodes(false)
+	{ }
+
+	uint32_t TransformHierarchy::Add(GameObject* owner) {
+		// A new root at the end of the list can't break the depth first order
+		uint32_t index = static_cast<uint32_t>(_owners.size());
+		_localTransforms.push_back(MAT4_IDENTITY);
+		_worldTransforms.push_back(MAT4_IDENTITY);
+		_inverseLocalTransforms.push_back(MAT4_IDENTITY);
+		_inverseWorldTransforms.push_back(MAT4_IDENTITY);
+		_parents.push_back(InvalidNode);
+		_subtreeEnds.push_back(index + 1);
+		_flags.push_back(AllDirty);
+		_owners.push_back(owner);
+		_hasDirtyNodes = true;
+		return index;
+	}
+
+	void TransformHierarchy::Remove(uint32_t node) {
+		// We leave the node in place until the next re-order, so that other indices stay valid
+		_owners[node] = nullptr;
+		_flags[node] = 0;
+		_isOrderDirty = true;
+	}
+
+	void TransformHierarchy::Clear() {
+		_localTransforms.clear();
+		_worldTransforms.clear();
+		_inverseLocalTransforms.clear();
+		_inverseWorldTransforms.clear();
+		_parents.clear();
+		_subtreeEnds.clear();
+		_flags.clear();
+		_owners.clear();
+		_isOrderDirty = false;
+		_hasDirtyNodes = false;
+	}
+
+	void TransformHierarchy::SetParent(uint32_t node, uint32_t parent) {
+		if (_parents[node] == parent) {
+			return;
+		}
+
+		// The re-order will push the dirty flag down to our children
+		_parents[node] = parent;
+		_flags[node] |= WorldDirty;
+		_hasDirtyNodes = true;
+		_isOrderDirty = true;
+	}
+
+	void TransformHierarchy::MarkDirty(uint32_t node) {
+		// If we were already dirty, so is our subtree. If the order is dirty, the subtree ranges
+		// are no good to us, but the re-order will take care of dirtying our children
+		bool needsPropagation = !_isOrderDirty && (_flags[node] & WorldDirty) == 0;
+
+		_flags[node] |= LocalDirty | WorldDirty;
+		_hasDirtyNodes = true;
+
+		if (needsPropagation) {
+			uint32_t end = _subtreeEnds[node];
+			for (uint32_t ix = node + 1; ix < end; ix++) {
+				_flags[ix] |= WorldDirty;
+			}
+		}
+	}
+
+	void TransformHierarchy::Update() {
+		// Removing nodes can dirty their children, so we need to re-order before we know for sure
+		_EnsureOrder();
+		if (!_hasDirtyNodes) {
+			return;
+		}
+
+		// Parents always come before children, so by the time we get to a node its parent is up to date
+		uint32_t count = static_cast<uint32_t>(_owners.size());
+		for (uint32_t ix = 0; ix < count; ix++) {
+			if (_flags[ix] & WorldDirty) {
+				_UpdateNodeFromParent(ix);
+			}
+		}
+		_hasDirtyNodes = false;
+	}
+
+	const glm::mat4& TransformHierarchy::GetLocal(uint32_t node) {
+		_EnsureOrder();
+		_UpdateLocal(node);
+		return _localTransforms[node];
+	}
+
+	const glm::mat4& TransformHierarchy::GetInverseLocal(uint32_t node) {
+		_EnsureOrder();
+		_UpdateLocal(node);
+		if (_flags[node] & InverseLocalDirty) {
+			_inverseLocalTransforms[node] = glm::inverse(_localTransforms[node]);
+			_flags[node] &= ~InverseLocalDirty;
+		}
+		return _inverseLocalTransforms[node];
+	}
+
+	const glm::mat4& TransformHierarchy::GetWorld(uint32_t node) {
+		_EnsureOrder();
+		if (_flags[node] & WorldDirty) {
+			_UpdateNode(node);
+		}
+		return _worldTransforms[node];
+	}
+
+	const glm::mat4& TransformHierarchy::GetInverseWorld(uint32_t node) {
+		GetWorld(node);
+		if (_flags[node] & InverseWorldDirty) {
+			_inverseWorldTransforms[node] = glm::inverse(_worldTransforms[node]);
+			_flags[node] &= ~InverseWorldDirty;
+		}
+		return _inverseWorldTransforms[node];
+	}
+
+	size_t TransformHierarchy::Size() const {
+		return _owners.size();
+	}
+
+	void TransformHierarchy::ComposeTransform(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale, glm::mat4& result) {
+		// Same as translate * rotate * scale, without the two extra matrix multiplies
+		glm::mat3 rot = glm::mat3_cast(rotation);
+		result[0] = glm::vec4(rot[0] * scale.x, 0.0f);
+		result[1] = glm::vec4(rot[1] * scale.y, 0.0f);
+		result[2] = glm::vec4(rot[2] * scale.z, 0.0f);
+		result[3] = glm::vec4(position, 1.0f);
+	}
+
+	void TransformHierarchy::_Reorder() {
+		uint32_t count = static_cast<uint32_t>(_owners.size());
+
+		// Build up linked lists of children, keeping them in their current order
+		std::vector<uint32_t> firstChild(count, InvalidNode);
+		std::vector<uint32_t> lastChild(count, InvalidNode);
+		std::vector<uint32_t> nextSibling(count, InvalidNode);
+		for (uint32_t ix = 0; ix < count; ix++) {
+			uint32_t parent = _parents[ix];
+			if (_owners[ix] == nullptr || parent == InvalidNode || _owners[parent] == nullptr) {
+				continue;
+			}
+			if (lastChild[parent] == InvalidNode) {
+				firstChild[parent] = ix;
+			} else {
+				nextSibling[lastChild[parent]] = ix;
+			}
+			lastChild[parent] = ix;
+		}
+
+		// Walk the tree depth first from every root. Anything still unvisited after the first pass
+		// is part of a parenting loop, we break the loop by treating the first node we find as a root
+		std::vector<uint32_t> order;
+		std::vector<uint32_t> remap(count, InvalidNode);
+		std::vector<uint32_t> newParents;
+		std::vector<uint32_t> stack;
+		order.reserve(count);
+		newParents.reserve(count);
+		for (int pass = 0; pass < 2; pass++) {
+			for (uint32_t root = 0; root < count; root++) {
+				if (_owners[root] == nullptr || remap[root] != InvalidNode) {
+					continue;
+				}
+				uint32_t parent = _parents[root];
+				bool isRoot = parent == InvalidNode || _owners[parent] == nullptr;
+				if (!isRoot && pass == 0) {
+					continue;
+				}
+
+				// Our parent was removed or we are breaking a loop, either way our world transform changes
+				if (parent != InvalidNode) {
+					_flags[root] |= WorldDirty;
+					_hasDirtyNodes = true;
+				}
+
+				stack.push_back(root);
+				while (!stack.empty()) {
+					uint32_t node = stack.back();
+					stack.pop_back();
+					if (remap[node] != InvalidNode) {
+						continue;
+					}
+
+					remap[node] = static_cast<uint32_t>(order.size());
+					newParents.push_back(node == root ? InvalidNode : remap[_parents[node]]);
+					order.push_back(node);
+
+					// Push the children backwards so that they get visited in order
+					size_t start = stack.size();
+					for (uint32_t child = firstChild[node]; child != InvalidNode; child = nextSibling[child]) {
+						stack.push_back(child);
+					}
+					std::reverse(stack.begin() + start, stack.end());
+				}
+			}
+		}
+
+		// Shuffle all our data into the new order
+		uint32_t newCount = static_cast<uint32_t>(order.size());
+		std::vector<glm::mat4>   localTransforms(newCount);
+		std::vector<glm::mat4>   worldTransforms(newCount);
+		std::vector<glm::mat4>   inverseLocalTransforms(newCount);
+		std::vector<glm::mat4>   inverseWorldTransforms(newCount);
+		std::vector<uint8_t>     flags(newCount);
+		std::vector<GameObject*> owners(newCount);
+		for (uint32_t ix = 0; ix < newCount; ix++) {
+			uint32_t oldIx = order[ix];
+			localTransforms[ix]        = _localTransforms[oldIx];
+			worldTransforms[ix]        = _worldTransforms[oldIx];
+			inverseLocalTransforms[ix] = _inverseLocalTransforms[oldIx];
+			inverseWorldTransforms[ix] = _inverseWorldTransforms[oldIx];
+			flags[ix]                  = _flags[oldIx];
+			owners[ix]                 = _owners[oldIx];
+			owners[ix]->_transformIndex = ix;
+		}
+		_localTransforms        = std::move(localTransforms);
+		_worldTransforms        = std::move(worldTransforms);
+		_inverseLocalTransforms = std::move(inverseLocalTransforms);
+		_inverseWorldTransforms = std::move(inverseWorldTransforms);
+		_flags                  = std::move(flags);
+		_owners                 = std::move(owners);
+		_parents                = std::move(newParents);
+
+		// Subtrees are contiguous, so a node's subtree ends where the last of its children's ends
+		_subtreeEnds.resize(newCount);
+		for (uint32_t ix = 0; ix < newCount; ix++) {
+			_subtreeEnds[ix] = ix + 1;
+		}
+		for (uint32_t ix = newCount; ix-- > 0;) {
+			uint32_t parent = _parents[ix];
+			if (parent != InvalidNode) {
+				_subtreeEnds[parent] = std::max(_subtreeEnds[parent], _subtreeEnds[ix]);
+			}
+		}
+
+		// Dirty flags may have been set while the order was dirty, push them down to the children
+		for (uint32_t ix = 0; ix < newCount; ix++) {
+			uint32_t parent = _parents[ix];
+			if (parent != InvalidNode && (_flags[parent] & WorldDirty)) {
+				_flags[ix] |= WorldDirty;
+			}
+		}
+
+		_isOrderDirty = false;
+	}
+
+	void TransformHierarchy::_UpdateNode(uint32_t node) {
+		uint32_t parent = _parents[node];
+		if (parent != InvalidNode && (_flags[parent] & WorldDirty)) {
+			_UpdateNode(parent);
+		}
+		_UpdateNodeFromParent(node);
+	}
+
+	void TransformHierarchy::_UpdateLocal(uint32_t node) {
+		if (_flags[node] & LocalDirty) {
+			GameObject* owner = _owners[node];
+			ComposeTransform(owner->_position, owner->_rotation, owner->_scale, _localTransforms[node]);
+			owner->_isLocalTransformDirty = false;
+			_flags[node] = (_flags[node] & ~LocalDirty) | InverseLocalDirty;
+		}
+	}
+
+	void TransformHierarchy::_UpdateNodeFromParent(uint32_t node) {
+		_UpdateLocal(node);
+
+		uint32_t parent = _parents[node];
+		if (parent == InvalidNode) {
+			_worldTransforms[node] = _localTransforms[node];
+		} else {
+			MultiplyTransforms(_worldTransforms[parent], _localTransforms[node], _worldTransforms[node]);
+		}
+		_flags[node] = (_flags[node] & ~WorldDirty) | InverseWorldDirty;
+	}
+}
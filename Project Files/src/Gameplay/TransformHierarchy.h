@@ -0,0 +1,149 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+#include "GLM/glm.hpp"
+#include "GLM/gtc/quaternion.hpp"
+
+namespace Gameplay {
+	class GameObject;
+
+	/// <summary>
+	/// Stores the local and world transforms for every object in a scene in flat arrays. Nodes are kept
+	/// in depth-first order, so a parent always comes before its children and every subtree occupies a
+	/// contiguous range of the arrays. This lets us dirty an entire subtree with a simple loop, and
+	/// recalculate all the dirty world transforms with a single forward pass
+	///
+	/// Node indices are not stable, they change whenever the hierarchy is re-ordered. The owning game
+	/// object's index is kept up to date by the hierarchy
+	///
+	/// NOTE: None of this is thread safe, world transforms should not be read from the parallel update
+	/// </summary>
+	class TransformHierarchy {
+	public:
+		static constexpr uint32_t InvalidNode = UINT32_MAX;
+
+		TransformHierarchy();
+		~TransformHierarchy() = default;
+
+		TransformHierarchy(const TransformHierarchy& other) = delete;
+		TransformHierarchy& operator=(const TransformHierarchy& other) = delete;
+
+		/// <summary>
+		/// Adds a new root node for the given object, the node starts out dirty
+		/// </summary>
+		/// <param name="owner">The object that owns the node</param>
+		/// <returns>The index of the new node</returns>
+		uint32_t Add(GameObject* owner);
+		/// <summary>
+		/// Removes a node from the hierarchy, any children will become roots
+		/// </summary>
+		/// <param name="node">The index of the node to remove</param>
+		void Remove(uint32_t node);
+		/// <summary>
+		/// Removes all nodes from the hierarchy
+		/// </summary>
+		void Clear();
+
+		/// <summary>
+		/// Sets the parent of a node, the node and all of its children will be marked dirty
+		/// </summary>
+		/// <param name="node">The node to re-parent</param>
+		/// <param name="parent">The new parent node, or InvalidNode to make the node a root</param>
+		void SetParent(uint32_t node, uint32_t parent);
+
+		/// <summary>
+		/// Notifies the hierarchy that the owner's position, rotation or scale has changed, dirtying
+		/// the node's local transform and the world transforms of the node and all of its children
+		/// </summary>
+		/// <param name="node">The node that has changed</param>
+		void MarkDirty(uint32_t node);
+
+		/// <summary>
+		/// Recalculates the world transforms for all dirty nodes. This is cheap to call if nothing
+		/// has changed
+		/// </summary>
+		void Update();
+
+		/// <summary>
+		/// Gets the local transform for a node, recalculating it if needed
+		/// </summary>
+		const glm::mat4& GetLocal(uint32_t node);
+		/// <summary>
+		/// Gets the inverse of the local transform for a node, this is only calculated on request
+		/// </summary>
+		const glm::mat4& GetInverseLocal(uint32_t node);
+		/// <summary>
+		/// Gets the world transform for a node, recalculating it and any dirty parents if needed
+		/// </summary>
+		const glm::mat4& GetWorld(uint32_t node);
+		/// <summary>
+		/// Gets the inverse of the world transform for a node, this is only calculated on request
+		/// </summary>
+		const glm::mat4& GetInverseWorld(uint32_t node);
+
+		/// <summary>
+		/// Gets the number of nodes in the hierarchy, including removed nodes that have not yet been
+		/// cleaned up
+		/// </summary>
+		size_t Size() const;
+
+		/// <summary>
+		/// Calculates a local transform matrix from a translation, rotation and scale
+		/// </summary>
+		static void ComposeTransform(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale, glm::mat4& result);
+
+	protected:
+		enum NodeFlags : uint8_t {
+			LocalDirty        = 1 << 0,
+			WorldDirty        = 1 << 1,
+			InverseLocalDirty = 1 << 2,
+			InverseWorldDirty = 1 << 3,
+			AllDirty          = LocalDirty | WorldDirty | InverseLocalDirty | InverseWorldDirty
+		};
+
+		std::vector<glm::mat4>   _localTransforms;
+		std::vector<glm::mat4>   _worldTransforms;
+		// Only valid when the corresponding InverseXDirty flag is cleared
+		std::vector<glm::mat4>   _inverseLocalTransforms;
+		std::vector<glm::mat4>   _inverseWorldTransforms;
+		std::vector<uint32_t>    _parents;
+		// One past the last node in each node's subtree
+		std::vector<uint32_t>    _subtreeEnds;
+		std::vector<uint8_t>     _flags;
+		// Null for nodes that have been removed but not yet cleaned up
+		std::vector<GameObject*> _owners;
+
+		// Set when nodes have been removed or re-parented, in which case the order needs to be rebuilt
+		// and the subtree ranges can't be trusted
+		bool _isOrderDirty;
+		// Set when any node has been dirtied since the last call to Update
+		bool _hasDirtyNodes;
+
+		/// <summary>
+		/// Rebuilds the node order if it is dirty
+		/// </summary>
+		inline void _EnsureOrder() {
+			if (_isOrderDirty) {
+				_Reorder();
+			}
+		}
+		/// <summary>
+		/// Drops removed nodes, sorts everything into depth first order, and pushes dirty world
+		/// transforms down to the children of dirty nodes
+		/// </summary>
+		void _Reorder();
+		/// <summary>
+		/// Recalculates the world transform for a single node, updating any dirty parents first
+		/// </summary>
+		void _UpdateNode(uint32_t node);
+		/// <summary>
+		/// Recalculates the local transform for a node from its owner's position, rotation and scale
+		/// </summary>
+		void _UpdateLocal(uint32_t node);
+		/// <summary>
+		/// Recalculates the world transform for a node whose parent is known to be up to date
+		/// </summary>
+		void _UpdateNodeFromParent(uint32_t node);
+	};
+}
@@ -43,6 +43,17 @@ public:
 	/// <param name="elementCount">The number of elements to upload</param>
 	virtual void LoadData(const void* data, uint32_t elementSize, uint32_t elementCount);
 
+	/// <summary>
+	/// Allocates immutable storage for this buffer and fills it with data, using glNamedBufferStorage.
+	/// The buffer can't be resized, reloaded or updated afterwards, so this is meant for data that is
+	/// uploaded once and never changes (ex: meshes loaded from disk). The data is copied by OpenGL
+	/// before this returns, so it can point into memory that is about to be freed or unmapped
+	/// </summary>
+	/// <param name="data">The data that you want to load into the buffer</param>
+	/// <param name="elementSize">The size of a single element, in bytes</param>
+	/// <param name="elementCount">The number of elements to upload</param>
+	virtual void LoadImmutableData(const void* data, uint32_t elementSize, uint32_t elementCount);
+
 	/// <summary>
 	/// Updates data within the buffer, optionally resizing the buffer
 	/// </summary>
@@ -83,6 +94,10 @@ public:
 	/// Returns the usage hint for this buffer (ex GL_STATIC_DRAW, GL_DYNAMIC_DRAW)
 	/// </summary>
 	BufferUsage GetUsage() const { return _usage; }
+	/// <summary>
+	/// Returns true if this buffer's storage was allocated with LoadImmutableData
+	/// </summary>
+	bool IsImmutable() const { return _isImmutable; }
 
 	/// <summary>
 	/// Maps the buffer's data to a pointer that the CPU can access. Note that unmap should be called
@@ -134,4 +149,5 @@ protected:
 	uint32_t _size; // The size of the buffer in bytes
 	BufferUsage _usage; // The buffer usage mode (GL_STATIC_DRAW, GL_DYNAMIC_DRAW)
 	BufferType _type; // The buffer type (ex GL_ARRAY_BUFFER, GL_ARRAY_ELEMENT_BUFFER)
+	bool _isImmutable; // True if the storage was allocated with glNamedBufferStorage
 };
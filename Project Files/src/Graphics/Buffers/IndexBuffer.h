@@ -43,6 +43,23 @@ public:
 		_elementType = elementType;
 	}
 
+	// Same as LoadData, the element type is required
+	inline void LoadImmutableData(const void* data, uint32_t elementSize, uint32_t elementCount) override {
+		throw std::runtime_error("Must use the LoadImmutableData that specifies the element type");
+	}
+
+	/// <summary>
+	/// Allocates immutable storage for the index buffer and fills it with data, see IBuffer::LoadImmutableData
+	/// </summary>
+	/// <param name="data">The pointer to the data to load in</param>
+	/// <param name="elementSize">The size of a single element, in bytes</param>
+	/// <param name="elementCount">The number of elements to upload</param>
+	/// <param name="elementType">The type of elements you are storing (GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT, GL_UNSIGNED_INT)</param>
+	inline void LoadImmutableData(const void* data, uint32_t elementSize, uint32_t elementCount, IndexType elementType) {
+		IBuffer::LoadImmutableData(data, elementSize, elementCount);
+		_elementType = elementType;
+	}
+
 	/// <summary>
 	/// Loads data of a known type into this index buffer
 	/// </summary>
@@ -185,6 +185,41 @@ constexpr GLint GetTexelComponentCount(PixelFormat format) {
 	}
 }
 
+/*
+ * Gets the number of bytes used to store a single texel in the given internal format. Drivers are
+ * free to pad formats (ex: RGB8 is usually stored as 4 bytes), so this is an estimate
+ */
+constexpr size_t GetInternalFormatSize(InternalFormat format) {
+	switch (format) {
+		case InternalFormat::R8:
+			return 1;
+		case InternalFormat::R16:
+		case InternalFormat::RG8:
+		case InternalFormat::Depth16:
+			return 2;
+		case InternalFormat::RGB8:
+		case InternalFormat::SRGB:
+			return 3;
+		case InternalFormat::Depth24:
+		case InternalFormat::Depth32:
+		case InternalFormat::DepthStencil:
+		case InternalFormat::RGB10:
+		case InternalFormat::RGBA8:
+		case InternalFormat::SRGBA:
+			return 4;
+		case InternalFormat::RGB16:
+			return 6;
+		case InternalFormat::RGBA16:
+			return 8;
+		case InternalFormat::RGB32F:
+			return 12;
+		case InternalFormat::RGB32AF:
+			return 16;
+		default:
+			return 0;
+	}
+}
+
 /*
  * Gets the number of bytes needed to represent a single texel of the given format and type
  * @param format The format of the texel
@@ -815,9 +850,46 @@ ENUM(AttributeType, GLenum,
 	 UInt    = GL_UNSIGNED_INT,
 	 Float   = GL_FLOAT,
 	 Double  = GL_DOUBLE,
+	 HalfFloat     = GL_HALF_FLOAT,
+	 // 3 signed 10 bit and 1 signed 2 bit components packed into 32 bits, must have a size of 4
+	 Int2_10_10_10 = GL_INT_2_10_10_10_REV,
 	 Unknown = GL_NONE
 )
 
+/// <summary>
+/// Gets the size of a single component of the given attribute type in bytes, or 0 if the type is unknown
+/// or packs all of its components together (see GetAttributeSize)
+/// </summary>
+inline size_t GetAttributeTypeSize(AttributeType type) {
+	switch (type) {
+		case AttributeType::Byte:
+		case AttributeType::UByte:  return sizeof(uint8_t);
+		case AttributeType::Short:
+		case AttributeType::UShort:
+		case AttributeType::HalfFloat: return sizeof(uint16_t);
+		case AttributeType::Int:
+		case AttributeType::UInt:   return sizeof(uint32_t);
+		case AttributeType::Float:  return sizeof(float);
+		case AttributeType::Double: return sizeof(double);
+		case AttributeType::Int2_10_10_10:
+		case AttributeType::Unknown:
+		default:
+			return 0;
+	}
+}
+
+/// <summary>
+/// Gets the size of a whole attribute in bytes, or 0 if the type is unknown or can't have that many components
+/// </summary>
+/// <param name="type">The type of the attribute's components</param>
+/// <param name="components">The number of components in the attribute</param>
+inline size_t GetAttributeSize(AttributeType type, int components) {
+	if (type == AttributeType::Int2_10_10_10) {
+		return components == 4 ? sizeof(uint32_t) : 0;
+	}
+	return GetAttributeTypeSize(type) * components;
+}
+
 /// <summary>
 /// Represents the mode in which a VAO will be drawn
 /// </summary>
@@ -7,6 +7,8 @@
 #include "Utils/FileHelpers.h"
 #include "Utils/JsonGlmHelpers.h"
 
+PreloadCache<std::string> ShaderProgram::_preloadedSources;
+
 ShaderProgram::ShaderProgram() : 
 	IGraphicsResource(),
 	IResource()
@@ -84,10 +86,11 @@ bool ShaderProgram::LoadShaderPart(const char* source, ShaderPartType type) {
 
 bool ShaderProgram::LoadShaderPartFromFile(const char* path, ShaderPartType type) {
 	// Make sure that the file exists before we try reading
-	if (std::filesystem::exists(path)) {
+	if (FileHelpers::Exists(path)) {
 		// Load the source from the file, using our helper that will
-		// resolve #include directives
-		std::string source = FileHelpers::ReadResolveIncludes(path);
+		// resolve #include directives, unless it was already read ahead of time
+		std::unique_ptr<std::string> preloaded = _preloadedSources.Take(path);
+		std::string source = preloaded != nullptr ? std::move(*preloaded) : FileHelpers::ReadResolveIncludes(path);
 		// Pass off to LoadShaderPart
 		bool result =  LoadShaderPart(source.c_str(), type);
 		_fileSourceMap[type].IsFilePath = true;
@@ -341,6 +344,17 @@ nlohmann::json ShaderProgram::ToJson() const {
 
 }
 
+size_t ShaderProgram::GetCpuMemoryUsage() const {
+	// We keep a copy of any source that wasn't loaded from a file, so that we can save it
+	size_t result = 0;
+	for (auto& [key, value] : _fileSourceMap) {
+		if (!value.IsFilePath) {
+			result += value.Source.size();
+		}
+	}
+	return result;
+}
+
 ShaderProgram::Sptr ShaderProgram::FromJson(const nlohmann::json& data) {
 	ShaderProgram::Sptr result = std::make_shared<ShaderProgram>();
 	result->SetDebugName(JsonGet(data, "name", result->_debugName));
@@ -364,6 +378,24 @@ ShaderProgram::Sptr ShaderProgram::FromJson(const nlohmann::json& data) {
 	return result;
 }
 
+void ShaderProgram::PreloadFile(const std::string& path) {
+	if (FileHelpers::Exists(path)) {
+		_preloadedSources.Store(path, std::make_unique<std::string>(FileHelpers::ReadResolveIncludes(path)));
+	}
+}
+
+void ShaderProgram::Preload(const nlohmann::json& data) {
+	for (auto& [key, blob] : data.items()) {
+		if (ParseShaderPartType(key, ShaderPartType::Unknown) != ShaderPartType::Unknown && blob.contains("path")) {
+			PreloadFile(blob["path"].get<std::string>());
+		}
+	}
+}
+
+void ShaderProgram::ClearPreloadedFiles() {
+	_preloadedSources.Clear();
+}
+
 void ShaderProgram::_Introspect() {
 	_IntrospectUniforms();
 	_IntrospectUnifromBlocks();
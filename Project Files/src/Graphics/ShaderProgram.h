@@ -9,6 +9,7 @@
 #include <EnumToString.h>
 
 #include "Utils/ResourceManager/IResource.h"
+#include "Utils/PreloadCache.h"
 #include "Graphics/GlEnums.h"
 #include "Graphics/IGraphicsResource.h"
 
@@ -117,6 +118,24 @@ public:
 
 	virtual nlohmann::json ToJson() const override;
 	static ShaderProgram::Sptr FromJson(const nlohmann::json& data);
+	virtual size_t GetCpuMemoryUsage() const override;
+	virtual bool IsReloadable() const override { return true; }
+
+	/// <summary>
+	/// Reads a shader file and resolves its includes without touching OpenGL, so this is safe to
+	/// call from a worker thread. The next shader part loaded from the same file will compile the
+	/// preloaded source instead of reading the files again
+	/// </summary>
+	/// <param name="path">The path of the shader file to read</param>
+	static void PreloadFile(const std::string& path);
+	/// <summary>
+	/// Reads all of the shader files for a shader program's manifest entry, see PreloadFile
+	/// </summary>
+	static void Preload(const nlohmann::json& data);
+	/// <summary>
+	/// Frees any preloaded shader sources that were never compiled
+	/// </summary>
+	static void ClearPreloadedFiles();
 
 public:
 	bool FindUniform(const std::string& name, UniformInfo* out);
@@ -198,6 +217,9 @@ protected:
 	};
 	std::unordered_map<ShaderPartType, ShaderSource> _fileSourceMap;
 
+	// Shader sources (with includes resolved) that were read ahead of time, keyed by file path
+	static PreloadCache<std::string> _preloadedSources;
+
 	/// <summary>
 	/// Performs program introspection, where we examine the uniforms that
 	/// the program contains
@@ -1,4 +1,5 @@
 #include "ITexture.h"
+#include <Logging.h>
 
 ITexture::Limits ITexture::__limits = ITexture::Limits();
 bool ITexture::__isStaticInit = false;
@@ -73,6 +74,10 @@ void ITexture::__StaticInit()
 	__isStaticInit = true;
 }
 
+void ITexture::_AssertNotShared() const {
+	LOG_ASSERT(!IsShared(), "Texture {} is shared by everything that loaded it from the same file, load it with a description holding the settings you need instead of changing it", GetGUID().str());
+}
+
 ITexture::Limits ITexture::GetLimits() {
 	__StaticInit();
 	return __limits;
@@ -60,6 +60,12 @@ protected:
 	/// </summary>
 	virtual void _Recreate();
 
+	/// <summary>
+	/// Asserts that this texture isn't shared between everyone that loaded it from the same file (see
+	/// IResource::IsShared), call before changing any of its state
+	/// </summary>
+	void _AssertNotShared() const;
+
 	TextureType _type; // The type for this texture, mainly used for debugging
 
 // STATIC SECTION
@@ -1,6 +1,7 @@
 #include "Texture1D.h"
 #include "Utils/Base64.h"
 #include "Utils/JsonGlmHelpers.h"
+#include "Utils/FileHelpers.h"
 #include <stb_image.h>
 
 inline int CalcRequiredMipLevels(int size) {
@@ -17,6 +18,23 @@ Texture1D::Texture1D(const std::string& filePath) :
 	_LoadDataFromFile();
 }
 
+std::string Texture1D::GetSourceKey(const std::string& filePath) {
+	Texture1DDescription description = Texture1DDescription();
+	description.Filename = filePath;
+	return GetSourceKey(description);
+}
+
+std::string Texture1D::GetSourceKey(const Texture1DDescription& description) {
+	// Generated textures each have their own data, so they are never shared
+	if (description.Filename.empty()) {
+		return std::string();
+	}
+	return FileHelpers::NormalizePath(description.Filename) +
+		"|" + std::to_string(*description.Wrap) +
+		"|" + std::to_string(*description.MinificationFilter) + "," + std::to_string(*description.MagnificationFilter) +
+		"|" + std::to_string(*description.FormatHint) + (description.GenerateMipMaps ? "|mips" : "");
+}
+
 Texture1D::Texture1D(const Texture1DDescription& description) :
 	ITexture(TextureType::_1D),
 	_description(description),
@@ -29,16 +47,19 @@ Texture1D::Texture1D(const Texture1DDescription& description) :
 }
 
 void Texture1D::SetMinFilter(MinFilter value) {
+	_AssertNotShared();
 	_description.MinificationFilter = value;
 	glTextureParameteri(_rendererId, GL_TEXTURE_MIN_FILTER, *_description.MinificationFilter);
 }
 
 void Texture1D::SetMagFilter(MagFilter value) {
+	_AssertNotShared();
 	_description.MagnificationFilter = value;
 	glTextureParameteri(_rendererId, GL_TEXTURE_MAG_FILTER, *_description.MagnificationFilter);
 }
 
 void Texture1D::SetWrap(WrapMode value) {
+	_AssertNotShared();
 	_description.Wrap = value;
 	glTextureParameteri(_rendererId, GL_TEXTURE_WRAP_S, *_description.Wrap);
 }
@@ -46,6 +67,7 @@ void Texture1D::SetWrap(WrapMode value) {
 void Texture1D::LoadData(uint32_t size, PixelFormat format, PixelType type, void* data, uint32_t offset /*= 0*/)
 {
 	LOG_ASSERT((size + offset) <= _description.Size, "Pixel bounds are outside of the X extents of the image!");
+	_AssertNotShared();
 
 	_description.FormatHint = format;
 	_pixelType = type;
@@ -130,7 +152,8 @@ void Texture1D::_LoadDataFromFile()
 
 		// Use STBI to load the image
 		stbi_set_flip_vertically_on_load(true);
-		uint8_t* data = stbi_load(_description.Filename.c_str(), &width, &height, &numChannels, targetChannels);
+		FileData::Sptr file = FileHelpers::OpenFile(_description.Filename);
+		uint8_t* data = file != nullptr ? stbi_load_from_memory(file->Data(), static_cast<int>(file->Size()), &width, &height, &numChannels, targetChannels) : nullptr;
 
 		// If we could not load any data, warn and return null
 		if (data == nullptr) {
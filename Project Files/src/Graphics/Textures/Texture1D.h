@@ -66,6 +66,19 @@ public:
 	Texture1D(const std::string& filePath);
 	Texture1D(const Texture1DDescription& description);
 
+	/// <summary>
+	/// Gets the key that ResourceManager::CreateAsset uses to share textures loaded from the same file
+	/// with the same sampler settings
+	/// </summary>
+	static std::string GetSourceKey(const std::string& filePath);
+	/// <summary>
+	/// Gets the key that ResourceManager::CreateAsset uses to share textures loaded from the same file
+	/// with the same settings, or an empty string if the description doesn't load a file
+	/// </summary>
+	static std::string GetSourceKey(const Texture1DDescription& description);
+
+	virtual std::string GetCurrentSourceKey() const override { return GetSourceKey(_description); }
+
 	/// <summary>
 	/// Gets the internal format OpenGL is using for this texture
 	/// </summary>
@@ -4,6 +4,7 @@
 #include "GLM/glm.hpp"
 #include "Utils/JsonGlmHelpers.h"
 #include "Utils/Base64.h"
+#include "Utils/FileHelpers.h"
 
 /// <summary>
 /// Get the number of mipmap levels required for a texture of the given size
@@ -15,6 +16,19 @@ inline int CalcRequiredMipLevels(int width, int height) {
 	return (1 + floor(log2(glm::max(width, height))));
 }
 
+/// <summary>
+/// Gets the part of a source key for the sampler settings, which can be changed after the texture is loaded
+/// </summary>
+static std::string GetSamplerKey(const Texture2DDescription& description) {
+	// Negative anisotropy is replaced with the max when the texture is created, so they need to match
+	float aniso = description.MaxAnisotropic < 0.0f ? ITexture::GetLimits().MAX_ANISOTROPY : description.MaxAnisotropic;
+	return "|" + std::to_string(*description.HorizontalWrap) + "," + std::to_string(*description.VerticalWrap) +
+		"|" + std::to_string(*description.MinificationFilter) + "," + std::to_string(*description.MagnificationFilter) +
+		"|" + std::to_string(aniso);
+}
+
+PreloadCache<Texture2D::DecodedImage> Texture2D::_preloadedImages;
+
 nlohmann::json Texture2D::ToJson() const {
 	nlohmann::json result = {
 		{ "wrap_s",  ~_description.HorizontalWrap },
@@ -94,7 +108,23 @@ Texture2D::Texture2D(const std::string& filePath) :
 	_LoadDataFromFile();
 }
 
+std::string Texture2D::GetSourceKey(const std::string& filePath) {
+	Texture2DDescription description = Texture2DDescription();
+	description.Filename = filePath;
+	return GetSourceKey(description);
+}
+
+std::string Texture2D::GetSourceKey(const Texture2DDescription& description) {
+	// Generated textures each have their own data, so they are never shared
+	if (description.Filename.empty()) {
+		return std::string();
+	}
+	return FileHelpers::NormalizePath(description.Filename) + GetSamplerKey(description) +
+		"|" + std::to_string(*description.FormatHint) + (description.GenerateMipMaps ? "|mips" : "");
+}
+
 void Texture2D::SetMinFilter(MinFilter value) {
+	_AssertNotShared();
 	if (_description.MultisampleCount == 1) {
 		_description.MinificationFilter = value;
 		glTextureParameteri(_rendererId, GL_TEXTURE_MIN_FILTER, *_description.MinificationFilter);
@@ -105,6 +135,7 @@ void Texture2D::SetMinFilter(MinFilter value) {
 }
 
 void Texture2D::SetMagFilter(MagFilter value) {
+	_AssertNotShared();
 	if (_description.MultisampleCount == 1) {
 		_description.MagnificationFilter = value;
 		glTextureParameteri(_rendererId, GL_TEXTURE_MAG_FILTER, *_description.MagnificationFilter);
@@ -114,6 +145,7 @@ void Texture2D::SetMagFilter(MagFilter value) {
 }
 
 void Texture2D::SetAnisoLevel(float value) {
+	_AssertNotShared();
 	if (value != _description.MaxAnisotropic) {
 		_description.MaxAnisotropic = glm::clamp(value, 1.0f, ITexture::GetLimits().MAX_ANISOTROPY);
 		glTextureParameterf(_rendererId, GL_TEXTURE_MAX_ANISOTROPY, _description.MaxAnisotropic);
@@ -128,6 +160,7 @@ void Texture2D::LoadData(uint32_t width, uint32_t height, PixelFormat format, Pi
 	// Ensure the rectangle we're setting is within the bounds of the image
 	LOG_ASSERT((width + offsetX) <= _description.Width, "Pixel bounds are outside of the X extents of the image!");
 	LOG_ASSERT((height + offsetY) <= _description.Height, "Pixel bounds are outside of the Y extents of the image!");
+	_AssertNotShared();
 
 	_description.FormatHint = format;
 	_pixelType = type;
@@ -150,55 +183,99 @@ void Texture2D::_LoadDataFromFile() {
 	LOG_ASSERT(_description.Width + _description.Height == 0, "This texture has already been configured with a size! Cannot re-allocate memory!");
 
 	if (!_description.Filename.empty()) {
-		// Variables that will store properties about our image
-		int width, height, numChannels;
 		const int targetChannels = GetTexelComponentCount(_description.FormatHint);
 
-		// Use STBI to load the image
-		stbi_set_flip_vertically_on_load(true);
-		uint8_t* data = stbi_load(_description.Filename.c_str(), &width, &height, &numChannels, targetChannels);
+		// If the image was decoded ahead of time with the same channel count we can skip straight to uploading it
+		std::unique_ptr<DecodedImage> image = _preloadedImages.Take(_description.Filename);
+		if (image == nullptr || image->TargetChannels != targetChannels) {
+			image = _DecodeFile(_description.Filename, targetChannels);
+		}
 
 		// If we could not load any data, warn and return null
-		if (data == nullptr) {
+		if (image == nullptr) {
 			LOG_WARN("STBI Failed to load image from \"{}\"", _description.Filename);
 			return ;
 		}
 
-		// We should estimate a good format for our data
-
-		// numChannels will store the number of channels in the image on disk, if we overrode that we should use the override value
-		if (targetChannels != 0)
-			numChannels = targetChannels;
-
 		// We'll determine a recommended format for the image based on number of channels
 		// We hinted that we wanted a certain number of channels, but we're not guaranteed
 		// that all those channels exist (ex: loading an RGB image but requesting RGBA)
-		InternalFormat internal_format = GetInternalFormatForChannels8(numChannels);
-		PixelFormat    image_format = GetPixelFormatForChannels(numChannels);
+		InternalFormat internal_format = GetInternalFormatForChannels8(image->NumChannels);
+		PixelFormat    image_format = GetPixelFormatForChannels(image->NumChannels);
 
 		// This is one of those poorly documented things in OpenGL
-		if ((numChannels * width) % 4 != 0) {
+		if ((image->NumChannels * image->Width) % 4 != 0) {
 			LOG_WARN("The alignment of a horizontal line is not a multiple of 4, this will require a call to glPixelStorei(GL_PACK_ALIGNMENT)");
 		}
 
 		// Update our description to match what we loaded
 		_description.Format = internal_format;
-		_description.Width = width;
-		_description.Height = height;
+		_description.Width = image->Width;
+		_description.Height = image->Height;
 
 		// Allocates our memory
 		_SetTextureParams();
 
-		// Upload data to our texture
-		LoadData(width, height, image_format, PixelType::UByte, data);
-
-		// We now have data in the image, we can clear the STBI data
-		stbi_image_free(data);
+		// Upload data to our texture, the STBI data is freed along with the image
+		LoadData(image->Width, image->Height, image_format, PixelType::UByte, image->Data);
 	}
 	
 	SetDebugName(_description.Filename);
 }
 
+Texture2D::DecodedImage::~DecodedImage() {
+	stbi_image_free(Data);
+}
+
+std::unique_ptr<Texture2D::DecodedImage> Texture2D::_DecodeFile(const std::string& path, int targetChannels) {
+	// Variables that will store properties about our image
+	int width, height, numChannels;
+
+	// Use STBI to load the image, from a pak archive if it's in one
+	stbi_set_flip_vertically_on_load(true);
+	FileData::Sptr file = FileHelpers::OpenFile(path);
+	uint8_t* data = file != nullptr ? stbi_load_from_memory(file->Data(), static_cast<int>(file->Size()), &width, &height, &numChannels, targetChannels) : nullptr;
+	if (data == nullptr) {
+		return nullptr;
+	}
+
+	std::unique_ptr<DecodedImage> result = std::make_unique<DecodedImage>();
+	result->Data = data;
+	result->Width = width;
+	result->Height = height;
+	// numChannels will store the number of channels in the image on disk, if we overrode that we should use the override value
+	result->NumChannels = targetChannels != 0 ? targetChannels : numChannels;
+	result->TargetChannels = targetChannels;
+	return result;
+}
+
+void Texture2D::PreloadFile(const std::string& path, PixelFormat formatHint) {
+	const int targetChannels = GetTexelComponentCount(formatHint);
+	std::unique_ptr<DecodedImage> image = _DecodeFile(path, targetChannels);
+	if (image != nullptr) {
+		_preloadedImages.Store(path, std::move(image));
+	}
+}
+
+size_t Texture2D::GetGpuMemoryUsage() const {
+	size_t result = (size_t)_description.Width * _description.Height * GetInternalFormatSize(_description.Format) * glm::max((int)_description.MultisampleCount, 1);
+	// A full mip chain adds another third on top of the base image
+	return _description.GenerateMipMaps ? result + result / 3 : result;
+}
+
+void Texture2D::Preload(const nlohmann::json& data) {
+	if (data.contains("filename") && data["filename"].is_string()) {
+		std::string filename = data["filename"].get<std::string>();
+		if (!filename.empty()) {
+			PreloadFile(filename);
+		}
+	}
+}
+
+void Texture2D::ClearPreloadedFiles() {
+	_preloadedImages.Clear();
+}
+
 void Texture2D::_SetTextureParams() {
 	// If we have a multisampled texture, and the current type is 2D, change it to 2D multisampled
 	if (_description.MultisampleCount > 1 && _type == TextureType::_2D) {
@@ -1,5 +1,6 @@
 #pragma once
 #include "ITexture.h"
+#include "Utils/PreloadCache.h"
 
 /// <summary>
 /// Describes all parameters we can manipulate with our 2D Textures
@@ -89,6 +90,19 @@ public:
 	Texture2D(const std::string& filePath);
 	Texture2D(const Texture2DDescription& description);
 
+	/// <summary>
+	/// Gets the key that ResourceManager::CreateAsset uses to share textures loaded from the same file
+	/// with the same sampler settings
+	/// </summary>
+	static std::string GetSourceKey(const std::string& filePath);
+	/// <summary>
+	/// Gets the key that ResourceManager::CreateAsset uses to share textures loaded from the same file
+	/// with the same settings, or an empty string if the description doesn't load a file
+	/// </summary>
+	static std::string GetSourceKey(const Texture2DDescription& description);
+
+	virtual std::string GetCurrentSourceKey() const override { return GetSourceKey(_description); }
+
 	/// <summary>
 	/// Gets the internal format OpenGL is using for this texture
 	/// </summary>
@@ -146,8 +160,44 @@ public:
 
 	virtual nlohmann::json ToJson() const override;
 	static Texture2D::Sptr FromJson(const nlohmann::json& data);
+	virtual size_t GetGpuMemoryUsage() const override;
+	// Only textures loaded from a file can be loaded again, generated textures have no file to load from
+	virtual bool IsReloadable() const override { return !_description.Filename.empty(); }
+
+	/// <summary>
+	/// Decodes an image file into memory without touching OpenGL, so this is safe to call from a
+	/// worker thread. The next texture that is created from the same file will upload the decoded
+	/// pixels instead of reading the file again
+	/// </summary>
+	/// <param name="path">The path of the image file to decode</param>
+	/// <param name="formatHint">The format the texture will be created with, determines the channel count</param>
+	static void PreloadFile(const std::string& path, PixelFormat formatHint = PixelFormat::RGBA);
+	/// <summary>
+	/// Decodes the image file for a texture's manifest entry, see PreloadFile
+	/// </summary>
+	static void Preload(const nlohmann::json& data);
+	/// <summary>
+	/// Frees any preloaded images that were never used by a texture
+	/// </summary>
+	static void ClearPreloadedFiles();
 
 protected:
+	/// <summary>
+	/// Pixel data decoded by STBI, freed when the image is destroyed
+	/// </summary>
+	struct DecodedImage {
+		uint8_t* Data = nullptr;
+		int      Width = 0;
+		int      Height = 0;
+		int      NumChannels = 0;
+		// The channel count that was requested from STBI, 0 for whatever is in the file
+		int      TargetChannels = 0;
+
+		~DecodedImage();
+	};
+
+	static PreloadCache<DecodedImage> _preloadedImages;
+
 	Texture2DDescription _description;
 	PixelType _pixelType;
 
@@ -160,6 +210,10 @@ protected:
 	/// Allocates our texture's memory and sets sampling / filtering parameters
 	/// </summary>
 	void _SetTextureParams();
+	/// <summary>
+	/// Decodes an image file with STBI, returns nullptr if the file could not be loaded
+	/// </summary>
+	static std::unique_ptr<DecodedImage> _DecodeFile(const std::string& path, int targetChannels);
 
 public:
 	static Texture2D::Sptr LoadFromFile(const std::string& path, const Texture2DDescription& description = Texture2DDescription(), bool forceRgba = true);
@@ -4,6 +4,7 @@
 #include "GLM/glm.hpp"
 #include "Utils/JsonGlmHelpers.h"
 #include "Utils/Base64.h"
+#include "Utils/FileHelpers.h"
 
 /// <summary>
 /// Get the number of mipmap levels required for a texture of the given size
@@ -102,21 +103,45 @@ Texture2DArray::Texture2DArray(const std::string& filePath, uint32_t splitX, uin
 	_LoadDataFromFile();
 }
 
+/// <summary>
+/// Gets the part of a source key for the sampler settings, which can be changed after the texture is loaded
+/// </summary>
+static std::string GetSamplerKey(const Texture2DArrayDescription& description) {
+	// Negative anisotropy is replaced with the max when the texture is created, so they need to match
+	float aniso = description.MaxAnisotropic < 0.0f ? ITexture::GetLimits().MAX_ANISOTROPY : description.MaxAnisotropic;
+	return "|" + std::to_string(*description.MinificationFilter) + "," + std::to_string(*description.MagnificationFilter) +
+		"|" + std::to_string(aniso);
+}
+
+std::string Texture2DArray::GetSourceKey(const std::string& filePath, uint32_t slicesX, uint32_t slicesY) {
+	return FileHelpers::NormalizePath(filePath) + "|" + std::to_string(slicesX) + "x" + std::to_string(slicesY) + GetSamplerKey(Texture2DArrayDescription());
+}
+
+std::string Texture2DArray::GetCurrentSourceKey() const {
+	if (_description.Filename.empty()) {
+		return std::string();
+	}
+	return FileHelpers::NormalizePath(_description.Filename) + "|" + std::to_string(_description.XDivisions) + "x" + std::to_string(_description.YDivisions) + GetSamplerKey(_description);
+}
+
 int Texture2DArray::GetLevels() const {
 	return _description.XDivisions * _description.YDivisions;
 }
 
 void Texture2DArray::SetMinFilter(MinFilter value) {
+	_AssertNotShared();
 	_description.MinificationFilter = value;
 	glTextureParameteri(_rendererId, GL_TEXTURE_MIN_FILTER, *_description.MinificationFilter);
 }
 
 void Texture2DArray::SetMagFilter(MagFilter value) {
+	_AssertNotShared();
 	_description.MagnificationFilter = value;
 	glTextureParameteri(_rendererId, GL_TEXTURE_MAG_FILTER, *_description.MagnificationFilter);
 }
 
 void Texture2DArray::SetAnisoLevel(float value) {
+	_AssertNotShared();
 	if (value != _description.MaxAnisotropic) {
 		_description.MaxAnisotropic = glm::clamp(value, 1.0f, ITexture::GetLimits().MAX_ANISOTROPY);
 		glTextureParameterf(_rendererId, GL_TEXTURE_MAX_ANISOTROPY, _description.MaxAnisotropic);
@@ -131,6 +156,7 @@ void Texture2DArray::LoadData(uint32_t width, uint32_t height, uint32_t layers,
 	// Ensure the rectangle we're setting is within the bounds of the image
 	LOG_ASSERT((width + offsetX) <= _description.Width, "Pixel bounds are outside of the X extents of the image!");
 	LOG_ASSERT((height + offsetY) <= _description.Height, "Pixel bounds are outside of the Y extents of the image!");
+	_AssertNotShared();
 
 	_description.FormatHint = format;
 	_pixelType = type;
@@ -159,7 +185,8 @@ void Texture2DArray::_LoadDataFromFile() {
 
 		// Use STBI to load the image
 		stbi_set_flip_vertically_on_load(true);
-		uint8_t* data = stbi_load(_description.Filename.c_str(), &width, &height, &numChannels, targetChannels);
+		FileData::Sptr file = FileHelpers::OpenFile(_description.Filename);
+		uint8_t* data = file != nullptr ? stbi_load_from_memory(file->Data(), static_cast<int>(file->Size()), &width, &height, &numChannels, targetChannels) : nullptr;
 
 		// If we could not load any data, warn and return null
 		if (data == nullptr) {
@@ -90,6 +90,14 @@ public:
 	Texture2DArray(const std::string& filePath, uint32_t slicesX, uint32_t slicesY);
 	Texture2DArray(const Texture2DArrayDescription& description);
 
+	/// <summary>
+	/// Gets the key that ResourceManager::CreateAsset uses to share textures loaded from the same file,
+	/// with the same number of slices
+	/// </summary>
+	static std::string GetSourceKey(const std::string& filePath, uint32_t slicesX, uint32_t slicesY);
+
+	virtual std::string GetCurrentSourceKey() const override;
+
 	/// <summary>
 	/// Gets the internal format OpenGL is using for this texture
 	/// </summary>
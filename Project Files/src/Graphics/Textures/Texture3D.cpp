@@ -2,6 +2,7 @@
 #include "Utils/Base64.h"
 #include "Utils/JsonGlmHelpers.h"
 #include "Utils/StringUtils.h"
+#include "Utils/FileHelpers.h"
 #include <Logging.h>
 #include <stb_image.h>
 #include <iostream>
@@ -21,6 +22,19 @@ Texture3D::Texture3D(const std::string& filePath) :
 	_LoadDataFromFile();
 }
 
+std::string Texture3D::GetSourceKey(const std::string& filePath) {
+	// Only the filters are part of the key, loading a LUT always clamps the wrap modes
+	Texture3DDescription description = Texture3DDescription();
+	return FileHelpers::NormalizePath(filePath) + "|" + std::to_string(*description.MinificationFilter) + "," + std::to_string(*description.MagnificationFilter);
+}
+
+std::string Texture3D::GetCurrentSourceKey() const {
+	if (_description.Filename.empty()) {
+		return std::string();
+	}
+	return FileHelpers::NormalizePath(_description.Filename) + "|" + std::to_string(*_description.MinificationFilter) + "," + std::to_string(*_description.MagnificationFilter);
+}
+
 Texture3D::Texture3D(const Texture3DDescription& description) :
 	ITexture(TextureType::_3D),
 	_description(description),
@@ -34,12 +48,14 @@ Texture3D::Texture3D(const Texture3DDescription& description) :
 
 void Texture3D::SetMinFilter(MinFilter value)
 {
+	_AssertNotShared();
 	_description.MinificationFilter = value;
 	glTextureParameteri(_rendererId, GL_TEXTURE_MIN_FILTER, *_description.MinificationFilter);
 }
 
 void Texture3D::SetMagFilter(MagFilter value)
 {
+	_AssertNotShared();
 	_description.MagnificationFilter = value;
 	glTextureParameteri(_rendererId, GL_TEXTURE_MAG_FILTER, *_description.MagnificationFilter);
 }
@@ -47,6 +63,7 @@ void Texture3D::SetMagFilter(MagFilter value)
 void Texture3D::LoadData(uint32_t width, uint32_t height, uint32_t depth, PixelFormat format, PixelType type, void* data, uint32_t offsetX /*= 0*/, uint32_t offsetY /*= 0*/, uint32_t offsetZ /*= 0*/)
 {
 	LOG_ASSERT(((width + offsetX) <= _description.Width) && ((height + offsetY) <= _description.Height) && ((depth + offsetZ) <= _description.Depth), "Pixel bounds are outside of the extents of the image!");
+	_AssertNotShared();
 
 	_description.FormatHint = format;
 	_pixelType = type;
@@ -149,9 +166,9 @@ void Texture3D::_LoadDataFromFile()
 
 void Texture3D::_LoadCubeFile()
 {
-	std::ifstream inFile(_description.Filename);
+	FileInputStream inFile(FileHelpers::OpenFile(_description.Filename));
 
-	if (!inFile.is_open()) {
+	if (!inFile) {
 		LOG_WARN("Failed to open file .cube file: {}", _description.Filename);
 		return;
 	}
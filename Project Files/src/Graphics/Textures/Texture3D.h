@@ -84,6 +84,13 @@ public:
 	Texture3D(const std::string& filePath);
 	Texture3D(const Texture3DDescription& description);
 
+	/// <summary>
+	/// Gets the key that ResourceManager::CreateAsset uses to share textures loaded from the same file
+	/// </summary>
+	static std::string GetSourceKey(const std::string& filePath);
+
+	virtual std::string GetCurrentSourceKey() const override;
+
 	/// <summary>
 	/// Gets the internal format OpenGL is using for this texture
 	/// </summary>
@@ -2,6 +2,7 @@
 #include <filesystem>
 #include "stb_image.h"
 #include "Utils/JsonGlmHelpers.h"
+#include "Utils/FileHelpers.h"
 
 TextureCube::TextureCube(const std::string& baseFilename) :
 	ITexture(TextureType::Cubemap),
@@ -11,6 +12,10 @@ TextureCube::TextureCube(const std::string& baseFilename) :
 	_LoadFromDescription();
 }
 
+std::string TextureCube::GetSourceKey(const std::string& baseFilename) {
+	return FileHelpers::NormalizePath(baseFilename);
+}
+
 TextureCube::TextureCube(const std::unordered_map<CubeMapFace, std::string>& faceFilenames) :
 	ITexture(TextureType::Cubemap),
 	_description(TextureCubeDescription())
@@ -44,6 +49,13 @@ nlohmann::json TextureCube::ToJson() const
 	return result;
 }
 
+size_t TextureCube::GetGpuMemoryUsage() const {
+	size_t result = (size_t)_description.Size * _description.Size * GetInternalFormatSize(_description.Format) * 6;
+	// Mipmapped filters mean we've got a full mip chain, which adds another third on top of the base images
+	bool hasMips = _description.MinificationFilter != MinFilter::Nearest && _description.MinificationFilter != MinFilter::Linear;
+	return hasMips ? result + result / 3 : result;
+}
+
 TextureCube::Sptr TextureCube::FromJson(const nlohmann::json& data)
 {
 	TextureCubeDescription descr = TextureCubeDescription();
@@ -82,7 +94,7 @@ void TextureCube::_LoadFromDescription()
 			targetPath += baseName.extension();
 
 			// If the file exists, store it in the description
-			if (std::filesystem::exists(targetPath)) {
+			if (FileHelpers::Exists(targetPath.string())) {
 				_description.FaceFileNames[face] = targetPath.string();
 			}
 		}
@@ -117,7 +129,8 @@ void TextureCube::_LoadImages(const std::unordered_map<CubeMapFace, std::string>
 
 		// Use STBI to load the image
 		stbi_set_flip_vertically_on_load(true);
-		uint8_t* data = stbi_load(filename.c_str(), &fileWidth, &fileHeight, &fileNumChannels, 0);
+		FileData::Sptr file = FileHelpers::OpenFile(filename);
+		uint8_t* data = file != nullptr ? stbi_load_from_memory(file->Data(), static_cast<int>(file->Size()), &fileWidth, &fileHeight, &fileNumChannels, 0) : nullptr;
 
 		// If we could not load any data, warn and return null
 		if (data == nullptr) {
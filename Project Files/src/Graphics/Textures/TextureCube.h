@@ -85,6 +85,11 @@ public:
 	TextureCube(const std::unordered_map<CubeMapFace, std::string>& faceFilenames);
 	TextureCube(const TextureCubeDescription& description);
 
+	/// <summary>
+	/// Gets the key that ResourceManager::CreateAsset uses to share textures loaded from the same file
+	/// </summary>
+	static std::string GetSourceKey(const std::string& baseFilename);
+
 	/// <summary>
 	/// Gets the width of this texture in pixels
 	/// </summary>
@@ -108,6 +113,9 @@ public:
 	/// </summary>
 	const TextureCubeDescription& GetDescription() const { return _description; }
 
+	virtual size_t GetGpuMemoryUsage() const override;
+	virtual bool IsReloadable() const override { return !_description.Filename.empty() || !_description.FaceFileNames.empty(); }
+
 	virtual nlohmann::json ToJson() const override;
 	static TextureCube::Sptr FromJson(const nlohmann::json& data);
 
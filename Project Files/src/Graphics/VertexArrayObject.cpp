@@ -163,6 +163,17 @@ VertexArrayObject::VertexBufferBinding* VertexArrayObject::GetBufferBinding(Attr
 	return nullptr;
 }
 
+size_t VertexArrayObject::GetBufferMemoryUsage() const
+{
+	size_t result = _indexBuffer != nullptr ? _indexBuffer->GetTotalSize() : 0;
+	for (const auto& binding : _vertexBuffers) {
+		if (binding->Buffer != nullptr) {
+			result += binding->Buffer->GetTotalSize();
+		}
+	}
+	return result;
+}
+
 VertexArrayObject::Sptr VertexArrayObject::Clone() const
 {
 	VertexArrayObject::Sptr result = Create();
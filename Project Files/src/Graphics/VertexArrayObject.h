@@ -89,6 +89,12 @@ public:
 	uint32_t GetIndexCount() const { return _indexBuffer != nullptr ? _indexBuffer->GetElementCount() : 0; }
 	uint32_t GetElementCount() const { return _elementCount; }
 
+	/// <summary>
+	/// Gets the total size of the index and vertex buffers bound to this VAO, in bytes. Buffers that
+	/// are shared with other VAOs (ex: from Clone) are counted by each of them
+	/// </summary>
+	size_t GetBufferMemoryUsage() const;
+
 	/// <summary>
 	/// Creates a copy of this VAO pointing to the same buffers, with the same attributes
 	/// </summary>
@@ -3,10 +3,14 @@
 #include <cstdint>
 #include <vector>
 #include <GLM/glm.hpp>
+#include <GLM/gtc/packing.hpp>
 #include "Graphics/VertexArrayObject.h"
 
 /// <summary>
 /// Structure for mapping and setting a Vertex's attribute based on a vertex declaration
+///
+/// Besides full precision floats, this understands the packed attributes used by the compact vertex
+/// types (see VertexPosNormTexColTangentsPacked), and packs or unpacks them as they are set and read
 /// </summary>
 struct VertexParamMap {
 	uint32_t PositionOffset;
@@ -16,6 +20,12 @@ struct VertexParamMap {
 	uint32_t ColorSize;
 	uint32_t TangentOffset;
 	uint32_t BiTangentOffset;
+	// True if the attribute is stored packed rather than as floats
+	bool     NormalPacked;
+	bool     TexturePacked;
+	bool     ColorPacked;
+	bool     TangentPacked;
+	bool     BiTangentPacked;
 
 	VertexParamMap() :
 		PositionOffset(-1),
@@ -24,7 +34,12 @@ struct VertexParamMap {
 		ColorOffset(-1),
 		ColorSize(0),
 		TangentOffset(-1),
-		BiTangentOffset(-1) {}
+		BiTangentOffset(-1),
+		NormalPacked(false),
+		TexturePacked(false),
+		ColorPacked(false),
+		TangentPacked(false),
+		BiTangentPacked(false) {}
 
 	VertexParamMap(const std::vector<BufferAttribute>& vDecl) : VertexParamMap() {
 		// Loop over all the vertex type's attributes
@@ -37,23 +52,49 @@ struct VertexParamMap {
 			else if (vDecl[ix].Usage == AttribUsage::Normal && vDecl[ix].Size == 3 && vDecl[ix].Type == AttributeType::Float) {
 				NormalOffset = vDecl[ix].Offset;
 			}
+			// If the attribute is a packed 10 bit normal, store it's byte offset
+			else if (vDecl[ix].Usage == AttribUsage::Normal && vDecl[ix].Size == 4 && vDecl[ix].Type == AttributeType::Int2_10_10_10) {
+				NormalOffset = vDecl[ix].Offset;
+				NormalPacked = true;
+			}
 			// If the attribute is a float2 texture UV, store it's byte offset
 			else if (vDecl[ix].Usage == AttribUsage::Texture && vDecl[ix].Size == 2 && vDecl[ix].Type == AttributeType::Float) {
 				TextureOffset = vDecl[ix].Offset;
 			}
+			// If the attribute is a half float texture UV, store it's byte offset
+			else if (vDecl[ix].Usage == AttribUsage::Texture && vDecl[ix].Size == 2 && vDecl[ix].Type == AttributeType::HalfFloat) {
+				TextureOffset = vDecl[ix].Offset;
+				TexturePacked = true;
+			}
 			// If the attribute is a float2 texture UV, store it's byte offset
 			else if (vDecl[ix].Usage == AttribUsage::Color && vDecl[ix].Type == AttributeType::Float) {
 				ColorOffset = vDecl[ix].Offset;
 				ColorSize   = vDecl[ix].Size;
 			}
+			// If the attribute is an RGBA8 color, store it's byte offset
+			else if (vDecl[ix].Usage == AttribUsage::Color && vDecl[ix].Size == 4 && vDecl[ix].Type == AttributeType::UByte && vDecl[ix].Normalized) {
+				ColorOffset = vDecl[ix].Offset;
+				ColorSize   = vDecl[ix].Size;
+				ColorPacked = true;
+			}
 			// If the attribute is a float3 tangent, store it's byte offset
 			else if (vDecl[ix].Usage == AttribUsage::Tangent && vDecl[ix].Size == 3 && vDecl[ix].Type == AttributeType::Float) {
 				TangentOffset = vDecl[ix].Offset;
 			}
+			// If the attribute is a packed 10 bit tangent, store it's byte offset
+			else if (vDecl[ix].Usage == AttribUsage::Tangent && vDecl[ix].Size == 4 && vDecl[ix].Type == AttributeType::Int2_10_10_10) {
+				TangentOffset = vDecl[ix].Offset;
+				TangentPacked = true;
+			}
 			// If the attribute is a float3 bitangent, store it's byte offset
 			else if (vDecl[ix].Usage == AttribUsage::BiTangent && vDecl[ix].Size == 3 && vDecl[ix].Type == AttributeType::Float) {
 				BiTangentOffset = vDecl[ix].Offset;
 			}
+			// If the attribute is a packed 10 bit bitangent, store it's byte offset
+			else if (vDecl[ix].Usage == AttribUsage::BiTangent && vDecl[ix].Size == 4 && vDecl[ix].Type == AttributeType::Int2_10_10_10) {
+				BiTangentOffset = vDecl[ix].Offset;
+				BiTangentPacked = true;
+			}
 		}
 	}
 
@@ -67,35 +108,65 @@ struct VertexParamMap {
 	template <typename Vertex>
 	void SetNormal(Vertex& vertex, const glm::vec3& value) const {
 		if (NormalOffset != (uint32_t)-1) {
-			memcpy(GetPtrOffset(vertex, NormalOffset), glm::value_ptr(value), sizeof(glm::vec3));
+			if (NormalPacked) {
+				*GetPtrOffset<Vertex, uint32_t>(vertex, NormalOffset) = glm::packSnorm3x10_1x2(glm::vec4(value, 0.0f));
+			} else {
+				memcpy(GetPtrOffset(vertex, NormalOffset), glm::value_ptr(value), sizeof(glm::vec3));
+			}
 		}
 	}
 
 	template <typename Vertex>
 	void SetTexture(Vertex& vertex, const glm::vec2& value) const {
 		if (TextureOffset != (uint32_t)-1) {
-			memcpy(GetPtrOffset(vertex, TextureOffset), glm::value_ptr(value), sizeof(glm::vec2));
+			if (TexturePacked) {
+				*GetPtrOffset<Vertex, uint32_t>(vertex, TextureOffset) = glm::packHalf2x16(value);
+			} else {
+				memcpy(GetPtrOffset(vertex, TextureOffset), glm::value_ptr(value), sizeof(glm::vec2));
+			}
 		}
 	}
 
 	template <typename Vertex>
 	void SetColor(Vertex& vertex, const glm::vec4& value) const {
 		if (ColorOffset != (uint32_t)-1) {
-			memcpy(GetPtrOffset(vertex, ColorOffset), glm::value_ptr(value), sizeof(float) * ColorSize);
+			if (ColorPacked) {
+				*GetPtrOffset<Vertex, uint32_t>(vertex, ColorOffset) = glm::packUnorm4x8(value);
+			} else {
+				memcpy(GetPtrOffset(vertex, ColorOffset), glm::value_ptr(value), sizeof(float) * ColorSize);
+			}
 		}
 	}
 
 	template <typename Vertex>
 	void SetTangent(Vertex& vertex, const glm::vec3& value) const {
 		if (TangentOffset != (uint32_t)-1) {
-			memcpy(GetPtrOffset(vertex, TangentOffset), glm::value_ptr(value), sizeof(glm::vec3));
+			if (TangentPacked) {
+				// Keep the handedness that's already stored, it gets updated when the bitangent is set
+				uint32_t& packed = *GetPtrOffset<Vertex, uint32_t>(vertex, TangentOffset);
+				float sign = glm::unpackSnorm3x10_1x2(packed).w < 0.0f ? -1.0f : 1.0f;
+				packed = glm::packSnorm3x10_1x2(glm::vec4(value, sign));
+			} else {
+				memcpy(GetPtrOffset(vertex, TangentOffset), glm::value_ptr(value), sizeof(glm::vec3));
+			}
 		}
 	}
 
 	template <typename Vertex>
 	void SetBiTangent(Vertex& vertex, const glm::vec3& value) const {
 		if (BiTangentOffset != (uint32_t)-1) {
-			memcpy(GetPtrOffset(vertex, BiTangentOffset), glm::value_ptr(value), sizeof(glm::vec3));
+			if (BiTangentPacked) {
+				*GetPtrOffset<Vertex, uint32_t>(vertex, BiTangentOffset) = glm::packSnorm3x10_1x2(glm::vec4(value, 0.0f));
+			} else {
+				memcpy(GetPtrOffset(vertex, BiTangentOffset), glm::value_ptr(value), sizeof(glm::vec3));
+			}
+		}
+		// Packed tangents carry the handedness of the tangent frame in their w component
+		if (TangentPacked && NormalOffset != (uint32_t)-1) {
+			uint32_t& packed = *GetPtrOffset<Vertex, uint32_t>(vertex, TangentOffset);
+			glm::vec4 tangent = glm::unpackSnorm3x10_1x2(packed);
+			tangent.w = glm::dot(glm::cross(GetNormal(vertex), glm::vec3(tangent)), value) < 0.0f ? -1.0f : 1.0f;
+			packed = glm::packSnorm3x10_1x2(tangent);
 		}
 	}
 
@@ -111,6 +182,9 @@ struct VertexParamMap {
 	template <typename Vertex>
 	glm::vec3 GetNormal(Vertex& vertex) const {
 		if (NormalOffset != (uint32_t)-1) {
+			if (NormalPacked) {
+				return glm::vec3(glm::unpackSnorm3x10_1x2(*GetPtrOffset<Vertex, uint32_t>(vertex, NormalOffset)));
+			}
 			return *GetPtrOffset<Vertex, glm::vec3>(vertex, NormalOffset);
 		}
 		return glm::vec3(0.0f);
@@ -119,6 +193,9 @@ struct VertexParamMap {
 	template <typename Vertex>
 	glm::vec2 GetTexture(Vertex& vertex) const {
 		if (TextureOffset != (uint32_t)-1) {
+			if (TexturePacked) {
+				return glm::unpackHalf2x16(*GetPtrOffset<Vertex, uint32_t>(vertex, TextureOffset));
+			}
 			return *GetPtrOffset<Vertex, glm::vec2>(vertex, TextureOffset);
 		}
 		return glm::vec2(0.0f);
@@ -127,6 +204,9 @@ struct VertexParamMap {
 	template <typename Vertex>
 	glm::vec4 GetColor(Vertex& vertex) const {
 		if (ColorOffset != (uint32_t)-1) {
+			if (ColorPacked) {
+				return glm::unpackUnorm4x8(*GetPtrOffset<Vertex, uint32_t>(vertex, ColorOffset));
+			}
 			switch (ColorSize) {
 				case 2:
 					return glm::vec4(*GetPtrOffset<Vertex, glm::vec2>(vertex, ColorOffset), 0, 1);
@@ -142,6 +222,9 @@ struct VertexParamMap {
 	template <typename Vertex>
 	glm::vec3 GetTangent(Vertex& vertex) const {
 		if (TangentOffset != (uint32_t)-1) {
+			if (TangentPacked) {
+				return glm::vec3(glm::unpackSnorm3x10_1x2(*GetPtrOffset<Vertex, uint32_t>(vertex, TangentOffset)));
+			}
 			return *GetPtrOffset<Vertex, glm::vec3>(vertex, TangentOffset);
 		}
 		return glm::vec3(0.0f);
@@ -150,6 +233,9 @@ struct VertexParamMap {
 	template <typename Vertex>
 	glm::vec3 GetBiTangent(Vertex& vertex) const {
 		if (BiTangentOffset != (uint32_t)-1) {
+			if (BiTangentPacked) {
+				return glm::vec3(glm::unpackSnorm3x10_1x2(*GetPtrOffset<Vertex, uint32_t>(vertex, BiTangentOffset)));
+			}
 			return *GetPtrOffset<Vertex, glm::vec3>(vertex, BiTangentOffset);
 		}
 		return glm::vec3(0.0f);
@@ -7,6 +7,8 @@ VertexPosNormCol* VPNC = nullptr;
 VertexPosNormTex* VPNT = nullptr;
 VertexPosNormTexCol* VPNTC = nullptr;
 VertexPosNormTexColTangents* VPNTCT = nullptr;
+VertexPosNormTexColPacked* VPNTCP = nullptr;
+VertexPosNormTexColTangentsPacked* VPNTCTP = nullptr;
 
 const std::vector<BufferAttribute> VertexPosCol::V_DECL = {
 	BufferAttribute(0, 3, AttributeType::Float, sizeof(VertexPosCol), (size_t)&VPC->Position, AttribUsage::Position),
@@ -41,4 +43,19 @@ const std::vector<BufferAttribute> VertexPosNormTexColTangents::V_DECL ={
 	BufferAttribute(4, 3, AttributeType::Float, sizeof(VertexPosNormTexColTangents), (size_t)&VPNTCT->Tangent, AttribUsage::Tangent),
 	BufferAttribute(5, 3, AttributeType::Float, sizeof(VertexPosNormTexColTangents), (size_t)&VPNTCT->BiTangent, AttribUsage::BiTangent)
 };
+// The packed types are normalized, so the shaders still get floats in the usual ranges
+const std::vector<BufferAttribute> VertexPosNormTexColPacked::V_DECL = {
+	BufferAttribute(0, 3, AttributeType::Float, sizeof(VertexPosNormTexColPacked), (size_t)&VPNTCP->Position, AttribUsage::Position),
+	BufferAttribute(1, 4, AttributeType::UByte, sizeof(VertexPosNormTexColPacked), (size_t)&VPNTCP->Color, AttribUsage::Color, true),
+	BufferAttribute(2, 4, AttributeType::Int2_10_10_10, sizeof(VertexPosNormTexColPacked), (size_t)&VPNTCP->Normal, AttribUsage::Normal, true),
+	BufferAttribute(3, 2, AttributeType::HalfFloat, sizeof(VertexPosNormTexColPacked), (size_t)&VPNTCP->UV, AttribUsage::Texture),
+};
+const std::vector<BufferAttribute> VertexPosNormTexColTangentsPacked::V_DECL = {
+	BufferAttribute(0, 3, AttributeType::Float, sizeof(VertexPosNormTexColTangentsPacked), (size_t)&VPNTCTP->Position, AttribUsage::Position),
+	BufferAttribute(1, 4, AttributeType::UByte, sizeof(VertexPosNormTexColTangentsPacked), (size_t)&VPNTCTP->Color, AttribUsage::Color, true),
+	BufferAttribute(2, 4, AttributeType::Int2_10_10_10, sizeof(VertexPosNormTexColTangentsPacked), (size_t)&VPNTCTP->Normal, AttribUsage::Normal, true),
+	BufferAttribute(3, 2, AttributeType::HalfFloat, sizeof(VertexPosNormTexColTangentsPacked), (size_t)&VPNTCTP->UV, AttribUsage::Texture),
+	BufferAttribute(4, 4, AttributeType::Int2_10_10_10, sizeof(VertexPosNormTexColTangentsPacked), (size_t)&VPNTCTP->Tangent, AttribUsage::Tangent, true),
+	BufferAttribute(5, 4, AttributeType::Int2_10_10_10, sizeof(VertexPosNormTexColTangentsPacked), (size_t)&VPNTCTP->BiTangent, AttribUsage::BiTangent, true)
+};
 #pragma warning(pop)
\ No newline at end of file
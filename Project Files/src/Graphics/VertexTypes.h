@@ -1,6 +1,7 @@
 #pragma once
 
 #include <GLM/glm.hpp>
+#include <GLM/gtc/packing.hpp>
 #include "VertexArrayObject.h"
 
 
@@ -116,4 +117,71 @@ struct VertexPosNormTexColTangents {
 	{}
 
 	static const std::vector<BufferAttribute> V_DECL;
-};
\ No newline at end of file
+};
+
+/// <summary>
+/// A compact version of VertexPosNormTexCol, at 24 bytes instead of 48. Normals are stored as 10 bit
+/// signed normalized values (GL_INT_2_10_10_10_REV), UVs as half floats and colors as 8 bit values
+///
+/// The packed attributes are normalized when they're fetched, so shaders see the same vec3 normal,
+/// vec2 UV and vec3/vec4 color as with the full precision vertex. Use VertexParamMap to read and write
+/// the packed attributes
+/// </summary>
+struct VertexPosNormTexColPacked {
+	glm::vec3 Position;
+	uint32_t  Normal;
+	uint32_t  UV;
+	uint32_t  Color;
+
+	VertexPosNormTexColPacked() :
+		Position(glm::vec3(0.0f)),
+		Normal(0),
+		UV(0),
+		Color(glm::packUnorm4x8(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)))
+	{}
+	VertexPosNormTexColPacked(const glm::vec3& pos, const glm::vec3& norm, const glm::vec2& uv, const glm::vec4& col) :
+		Position(pos),
+		Normal(glm::packSnorm3x10_1x2(glm::vec4(norm, 0.0f))),
+		UV(glm::packHalf2x16(uv)),
+		Color(glm::packUnorm4x8(col))
+	{}
+
+	static const std::vector<BufferAttribute> V_DECL;
+};
+
+/// <summary>
+/// A compact version of VertexPosNormTexColTangents, at 32 bytes instead of 72. Normals, tangents and
+/// bitangents are stored as 10 bit signed normalized values (GL_INT_2_10_10_10_REV), UVs as half floats
+/// and colors as 8 bit values
+///
+/// The tangent's 2 bit w component holds the handedness of the tangent frame (the sign of
+/// dot(cross(normal, tangent), bitangent)), so shaders can rebuild the bitangent from it. The bitangent
+/// is still stored so that existing shaders keep working as is
+/// </summary>
+struct VertexPosNormTexColTangentsPacked {
+	glm::vec3 Position;
+	uint32_t  Normal;
+	uint32_t  UV;
+	uint32_t  Color;
+	uint32_t  Tangent;
+	uint32_t  BiTangent;
+
+	VertexPosNormTexColTangentsPacked() :
+		Position(glm::vec3(0.0f)),
+		Normal(0),
+		UV(0),
+		Color(glm::packUnorm4x8(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f))),
+		Tangent(glm::packSnorm3x10_1x2(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f))),
+		BiTangent(0)
+	{}
+	VertexPosNormTexColTangentsPacked(const glm::vec3& pos, const glm::vec3& norm, const glm::vec2& uv, const glm::vec4& col) :
+		Position(pos),
+		Normal(glm::packSnorm3x10_1x2(glm::vec4(norm, 0.0f))),
+		UV(glm::packHalf2x16(uv)),
+		Color(glm::packUnorm4x8(col)),
+		Tangent(glm::packSnorm3x10_1x2(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f))),
+		BiTangent(0)
+	{}
+
+	static const std::vector<BufferAttribute> V_DECL;
+};
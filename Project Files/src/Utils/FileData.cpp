@@ -0,0 +1,58 @@
+#include "Utils/FileData.h"
+
+FileData::FileData(const std::shared_ptr<const void>& owner, const uint8_t* data, size_t size) :
+	_data(data),
+	_size(size),
+	_owner(owner),
+	_buffer(std::vector<uint8_t>())
+{ }
+
+FileData::FileData(std::vector<uint8_t>&& buffer) :
+	_data(nullptr),
+	_size(0),
+	_owner(nullptr),
+	_buffer(std::move(buffer))
+{
+	_data = _buffer.empty() ? nullptr : _buffer.data();
+	_size = _buffer.size();
+}
+
+FileInputStream::FileInputStream(const FileData::Sptr& file) :
+	std::istream(nullptr),
+	_file(file),
+	_buffer(file)
+{
+	rdbuf(&_buffer);
+	if (_file == nullptr) {
+		setstate(std::ios_base::failbit);
+	}
+}
+
+FileInputStream::Buffer::Buffer(const FileData::Sptr& file) :
+	std::streambuf()
+{
+	if (file != nullptr && file->Data() != nullptr) {
+		// streambuf wants non-const pointers, but we never write through them
+		char* begin = reinterpret_cast<char*>(const_cast<uint8_t*>(file->Data()));
+		setg(begin, begin, begin + file->Size());
+	}
+}
+
+FileInputStream::Buffer::pos_type FileInputStream::Buffer::seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which) {
+	off_type base = 0;
+	if (dir == std::ios_base::cur) {
+		base = gptr() - eback();
+	} else if (dir == std::ios_base::end) {
+		base = egptr() - eback();
+	}
+	return seekpos(pos_type(base + offset), which);
+}
+
+FileInputStream::Buffer::pos_type FileInputStream::Buffer::seekpos(pos_type pos, std::ios_base::openmode which) {
+	off_type target = off_type(pos);
+	if (!(which & std::ios_base::in) || target < 0 || target > egptr() - eback()) {
+		return pos_type(off_type(-1));
+	}
+	setg(eback(), eback() + target, egptr());
+	return pos;
+}
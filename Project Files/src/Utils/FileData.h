@@ -0,0 +1,73 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <istream>
+#include <streambuf>
+#include <cstdint>
+#include <cstddef>
+
+/// <summary>
+/// A read-only view of a file's contents, as returned by FileHelpers::OpenFile. Depending on where the
+/// file was found the data may be mapped straight from a loose file, point into a mounted pak archive,
+/// or be a decompressed copy of an archive entry. Either way, the data stays valid for as long as the
+/// object is alive
+/// </summary>
+class FileData {
+public:
+	typedef std::shared_ptr<FileData> Sptr;
+
+	/// <summary>
+	/// Creates a view into memory that is kept alive by another object (ex: a memory mapped file)
+	/// </summary>
+	/// <param name="owner">The object that owns the memory, held on to for as long as the view is alive</param>
+	/// <param name="data">The start of the file's contents</param>
+	/// <param name="size">The size of the file's contents in bytes</param>
+	FileData(const std::shared_ptr<const void>& owner, const uint8_t* data, size_t size);
+	/// <summary>
+	/// Creates a view of a buffer that the file data takes ownership of
+	/// </summary>
+	FileData(std::vector<uint8_t>&& buffer);
+	~FileData() = default;
+
+	FileData(const FileData& other) = delete;
+	FileData& operator=(const FileData& other) = delete;
+
+	/// <summary>
+	/// Gets a pointer to the start of the file's contents, or nullptr if the file is empty
+	/// </summary>
+	const uint8_t* Data() const { return _data; }
+	/// <summary>
+	/// Gets the size of the file in bytes
+	/// </summary>
+	size_t Size() const { return _size; }
+
+protected:
+	const uint8_t*          _data;
+	size_t                  _size;
+	std::shared_ptr<const void> _owner;
+	std::vector<uint8_t>    _buffer;
+};
+
+/// <summary>
+/// An input stream that reads from a FileData, so that stream based parsers can read files that live
+/// in an archive the same way they read loose files. If the file is null, the stream starts out failed
+/// </summary>
+class FileInputStream : public std::istream {
+public:
+	FileInputStream(const FileData::Sptr& file);
+	virtual ~FileInputStream() = default;
+
+protected:
+	// Reads straight from the file's memory without copying it
+	class Buffer : public std::streambuf {
+	public:
+		Buffer(const FileData::Sptr& file);
+
+	protected:
+		virtual pos_type seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+		virtual pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+	};
+
+	FileData::Sptr _file;
+	Buffer         _buffer;
+};
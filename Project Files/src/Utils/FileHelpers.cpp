@@ -1,12 +1,51 @@
 #include "Utils/FileHelpers.h"
 #include <fstream>
 #include <filesystem>
+#include <algorithm>
 #include <Logging.h>
 
 #include "Utils/StringUtils.h"
+#include "Utils/PakArchive.h"
+#include "Utils/MemoryMappedFile.h"
+
+FileData::Sptr FileHelpers::OpenFile(const std::string& filename) {
+	FileData::Sptr result = PakArchive::OpenMountedFile(filename);
+	if (result != nullptr) {
+		return result;
+	}
+
+	MemoryMappedFile::Sptr file = MemoryMappedFile::Open(filename);
+	if (file == nullptr) {
+		return nullptr;
+	}
+	return std::make_shared<FileData>(file, file->Data(), file->Size());
+}
+
+bool FileHelpers::Exists(const std::string& filename) {
+	return PakArchive::MountedContains(filename) || std::filesystem::exists(filename);
+}
+
+std::string FileHelpers::NormalizePath(const std::string& path) {
+	std::string result = path;
+	std::replace(result.begin(), result.end(), '\\', '/');
+	result = std::filesystem::path(result).lexically_normal().generic_string();
+	while (result.rfind("./", 0) == 0) {
+		result.erase(0, 2);
+	}
+	StringTools::ToLower(result);
+	return result;
+}
 
 std::string FileHelpers::ReadFile(const std::string& filename) {
 	std::string result;
+
+	// Files in an archive win over loose files (unless the loose file is newer), same as OpenFile
+	FileData::Sptr packed = PakArchive::OpenMountedFile(filename);
+	if (packed != nullptr) {
+		result.assign(reinterpret_cast<const char*>(packed->Data()), packed->Size());
+		return result;
+	}
+
 	std::ifstream in(filename, std::ios::in | std::ios::binary); // ifstream closes itself due to RAII
 
 	if (in) {
@@ -77,7 +116,7 @@ std::string FileHelpers::ReadResolveIncludes(const std::string& filename, std::v
 		if (std::find(resolvedPaths.begin(), resolvedPaths.end(), target.string()) == resolvedPaths.end()) {
 
 			// Make sure file exists, then load and resolve it's includes
-			LOG_ASSERT(std::filesystem::exists(target), "File does not exist");
+			LOG_ASSERT(Exists(target.string()), "File does not exist");
 			std::string replacement = FileHelpers::ReadResolveIncludes(target.string(), resolvedPaths);
 
 			// Inject result into our string
@@ -101,3 +140,13 @@ void FileHelpers::WriteContentsToFile(const std::string& filename, const std::st
 	std::ofstream output(filename, std::ios::out | (append ? std::ios::app : 0));
 	output << contents;
 }
+
+bool FileHelpers::WriteBinaryToFile(const std::string& filename, const void* data, size_t size) {
+	std::ofstream output(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!output) {
+		LOG_ERROR("Could not open file '{}' for writing", filename);
+		return false;
+	}
+	output.write(static_cast<const char*>(data), size);
+	return output.good();
+}
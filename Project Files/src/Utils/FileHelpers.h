@@ -3,9 +3,34 @@
 #include <string>
 #include <vector>
 
+#include "Utils/FileData.h"
+
 class FileHelpers {
 public:
 	FileHelpers() = delete;
+	/// <summary>
+	/// Opens a file for reading, looking in any mounted pak archives first and then falling back
+	/// to loose files on disk, which are memory mapped. Loose files that are newer than the archive
+	/// holding the same path are used instead of the archive's copy
+	/// </summary>
+	/// <param name="filename">The path of the file to open</param>
+	/// <returns>The contents of the file, or nullptr if it could not be found or opened</returns>
+	static FileData::Sptr OpenFile(const std::string& filename);
+
+	/// <summary>
+	/// Checks whether a file exists, either in a mounted pak archive or on disk
+	/// </summary>
+	/// <param name="filename">The path of the file to check for</param>
+	static bool Exists(const std::string& filename);
+
+	/// <summary>
+	/// Gets a canonical form of a relative path, so that different ways of writing the same path compare
+	/// equal. Separators are converted to forward slashes, . and .. parts are resolved, and the path is
+	/// lowercased (paths are case insensitive on Windows)
+	/// </summary>
+	/// <param name="path">The path to normalize</param>
+	static std::string NormalizePath(const std::string& path);
+
 	/// <summary>
 	/// Reads the entire contents of a file into a string
 	/// </summary>
@@ -29,4 +54,13 @@ public:
 	/// <param name="contents">The contents of the file to write</param>
 	/// <param name="append">True if contents should be appended to end of existing files</param>
 	static void WriteContentsToFile(const std::string& filename, const std::string& contents, bool append = false);
+
+	/// <summary>
+	/// Helper for writing raw bytes into a file, replacing anything already in it
+	/// </summary>
+	/// <param name="filename">The path to write the data to</param>
+	/// <param name="data">The data to write</param>
+	/// <param name="size">The number of bytes to write</param>
+	/// <returns>True if the data was written</returns>
+	static bool WriteBinaryToFile(const std::string& filename, const void* data, size_t size);
 };
\ No newline at end of file
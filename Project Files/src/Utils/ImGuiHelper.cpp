@@ -149,7 +149,7 @@ void ImGuiHelper::ResourceDragSource(const IResource* resource, const std::strin
 	}
 }
 
-void ImGuiHelper::HeaderCheckbox(ImGuiID headerId, bool* value)
+bool ImGuiHelper::HeaderCheckbox(ImGuiID headerId, bool* value)
 {
 	ImGuiWindow* window = ImGui::GetCurrentWindow();
 	ImGuiContext& g = *GImGui;
@@ -157,8 +157,19 @@ void ImGuiHelper::HeaderCheckbox(ImGuiID headerId, bool* value)
 	float button_size = g.FontSize;
 	float button_x = ImMax(window->DC.LastItemRect.Min.x, window->DC.LastItemRect.Max.x - g.Style.FramePadding.x * 2.0f - button_size);
 	float button_y = window->DC.LastItemRect.Min.y;
-	CheckboxEx(window->GetID((void*)((intptr_t)headerId + 1)), ImVec2(button_x, button_y), value);
+	bool result = CheckboxEx(window->GetID((void*)((intptr_t)headerId + 1)), ImVec2(button_x, button_y), value);
 	last_item_backup.Restore();
+	return result;
+}
+
+bool ImGuiHelper::DrawAndCheckEdited(const std::function<void()>& draw)
+{
+	ImGuiContext& g = *GImGui;
+	// The flag stays up for the rest of the frame once any widget is edited, but only one widget can be
+	// active at a time, so if it goes up while we're drawing then the edited widget was one of ours
+	bool wasEdited = g.ActiveIdHasBeenEditedThisFrame;
+	draw();
+	return !wasEdited && g.ActiveIdHasBeenEditedThisFrame;
 }
 
 bool VertArrowEx(ImGuiID id, ImVec2 pos, bool positive, int* value) {
@@ -5,6 +5,7 @@
 #include "ResourceManager/ResourceManager.h"
 
 #include <map>
+#include <functional>
 #include <EnumToString.h>
 #include "Graphics/ShaderProgram.h"
 #include "Graphics/Textures/Texture2D.h"
@@ -100,7 +101,19 @@ public:
 	/// </summary>
 	static void EndFrame();
 
-	static void HeaderCheckbox(ImGuiID headerId, bool* value);
+	/// <summary>
+	/// Draws a checkbox on the right side of a collapsing header
+	/// </summary>
+	/// <returns>True if the value was toggled</returns>
+	static bool HeaderCheckbox(ImGuiID headerId, bool* value);
+
+	/// <summary>
+	/// Invokes a function that draws some widgets, and reports whether any of them were edited. For drawing
+	/// code that doesn't pass on its widgets' return values, like IComponent::RenderImGui
+	/// </summary>
+	/// <param name="draw">The function that draws the widgets</param>
+	/// <returns>True if one of the widgets drawn by the function was edited this frame</returns>
+	static bool DrawAndCheckEdited(const std::function<void()>& draw);
 
 	static bool HeaderMoveButtons(ImGuiID headerId, int* delta);
 
@@ -0,0 +1,222 @@
+#include "Utils/JobSystem.h"
+#include <algorithm>
+#include <Logging.h>
+
+std::vector<JobSystem::WorkQueue*> JobSystem::_queues;
+JobSystem::WorkQueue JobSystem::_backgroundQueue;
+std::vector<std::thread> JobSystem::_workers;
+std::mutex JobSystem::_sleepMutex;
+std::condition_variable JobSystem::_wakeCondition;
+std::atomic<size_t> JobSystem::_pendingJobs(0);
+std::atomic<bool> JobSystem::_isRunning(false);
+thread_local size_t JobSystem::_threadIndex = 0;
+thread_local bool JobSystem::_isInBackgroundJob = false;
+
+void JobSystem::Init(uint32_t numWorkers) {
+	LOG_ASSERT(!_isRunning, "Job system has already been initialized!");
+
+	if (numWorkers == 0) {
+		uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		numWorkers = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+	}
+
+	// Queue 0 is for the main thread, the rest are for the workers
+	for (uint32_t ix = 0; ix <= numWorkers; ix++) {
+		_queues.push_back(new WorkQueue());
+	}
+
+	_isRunning = true;
+	for (uint32_t ix = 1; ix <= numWorkers; ix++) {
+		_workers.emplace_back(&JobSystem::_WorkerLoop, ix);
+	}
+
+	LOG_INFO("Started job system with {} worker threads", numWorkers);
+}
+
+void JobSystem::Shutdown() {
+	if (!_isRunning) return;
+
+	// Flag the workers to stop, and wake them all up so they notice
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_isRunning = false;
+	}
+	_wakeCondition.notify_all();
+
+	for (auto& worker : _workers) {
+		worker.join();
+	}
+	_workers.clear();
+
+	for (WorkQueue* queue : _queues) {
+		delete queue;
+	}
+	_queues.clear();
+	_backgroundQueue.Jobs.clear();
+	_pendingJobs = 0;
+}
+
+uint32_t JobSystem::WorkerCount() {
+	return static_cast<uint32_t>(_workers.size());
+}
+
+size_t JobSystem::ThreadIndex() {
+	return _threadIndex;
+}
+
+void JobSystem::Submit(Job job) {
+	// Without workers, just run the job now
+	if (_workers.empty()) {
+		job();
+		return;
+	}
+
+	// Work split off from a background job has to stay out of the main thread's reach too
+	if (_isInBackgroundJob) {
+		_PushBackground(std::move(job), true);
+		return;
+	}
+
+	// Bump the pending count under the sleep lock, so that a worker can't check the count and then
+	// go to sleep between us incrementing it and notifying. We count the job before it's visible so
+	// that a thief can never take the count below zero
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_pendingJobs++;
+	}
+
+	WorkQueue* queue = _queues[_threadIndex];
+	{
+		std::lock_guard<std::mutex> lock(queue->Mutex);
+		queue->Jobs.push_back(std::move(job));
+	}
+	_wakeCondition.notify_one();
+}
+
+void JobSystem::SubmitBackground(Job job) {
+	// Without workers, just run the job now
+	if (_workers.empty()) {
+		job();
+		return;
+	}
+
+	_PushBackground(std::move(job), false);
+}
+
+void JobSystem::_PushBackground(Job job, bool atFront) {
+	Job wrapped = [job = std::move(job)]() {
+		bool wasInBackground = _isInBackgroundJob;
+		_isInBackgroundJob = true;
+		job();
+		_isInBackgroundJob = wasInBackground;
+	};
+
+	// See Submit for why this happens first
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_pendingJobs++;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_backgroundQueue.Mutex);
+		if (atFront) {
+			_backgroundQueue.Jobs.push_front(std::move(wrapped));
+		} else {
+			_backgroundQueue.Jobs.push_back(std::move(wrapped));
+		}
+	}
+	_wakeCondition.notify_one();
+}
+
+void JobSystem::ParallelFor(size_t count, const RangeJob& job, size_t grainSize) {
+	if (count == 0) return;
+	if (grainSize == 0) grainSize = 1;
+
+	// Small ranges or no workers, not worth the overhead of splitting up
+	if (_workers.empty() || count <= grainSize) {
+		job(0, count);
+		return;
+	}
+
+	// Aim for a few chunks per thread so that stealing can balance uneven work
+	size_t numThreads = _workers.size() + 1;
+	size_t chunkSize = std::max(grainSize, (count + (numThreads * 4) - 1) / (numThreads * 4));
+	size_t numChunks = (count + chunkSize - 1) / chunkSize;
+
+	std::atomic<size_t> remaining(numChunks);
+	for (size_t chunk = 0; chunk < numChunks; chunk++) {
+		size_t begin = chunk * chunkSize;
+		size_t end = std::min(begin + chunkSize, count);
+		Submit([&job, &remaining, begin, end]() {
+			job(begin, end);
+			remaining--;
+		});
+	}
+
+	// Help out until all of our chunks are done, the chunks reference this stack frame so we can't leave early.
+	// Background jobs are left alone, since they could keep us from returning long after our chunks are done.
+	// The exception is when we are a background job, since then our chunks are in the background queue too
+	Job next;
+	while (remaining > 0) {
+		if (_TryGetJob(next, _isInBackgroundJob)) {
+			next();
+		} else {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::_WorkerLoop(size_t index) {
+	_threadIndex = index;
+
+	Job job;
+	while (_isRunning) {
+		if (_TryGetJob(job, true)) {
+			job();
+			continue;
+		}
+
+		// Nothing to do, sleep until someone submits more work
+		std::unique_lock<std::mutex> lock(_sleepMutex);
+		_wakeCondition.wait(lock, []() { return !_isRunning || _pendingJobs > 0; });
+	}
+}
+
+bool JobSystem::_TryGetJob(Job& job, bool includeBackground) {
+	// Newest work from our own queue first, it's most likely to still be in cache
+	WorkQueue* own = _queues[_threadIndex];
+	{
+		std::lock_guard<std::mutex> lock(own->Mutex);
+		if (!own->Jobs.empty()) {
+			job = std::move(own->Jobs.back());
+			own->Jobs.pop_back();
+			_pendingJobs--;
+			return true;
+		}
+	}
+
+	// Steal the oldest work from everyone else, starting with our neighbour so threads don't all gang up on queue 0
+	for (size_t offset = 1; offset < _queues.size(); offset++) {
+		WorkQueue* victim = _queues[(_threadIndex + offset) % _queues.size()];
+		std::lock_guard<std::mutex> lock(victim->Mutex);
+		if (!victim->Jobs.empty()) {
+			job = std::move(victim->Jobs.front());
+			victim->Jobs.pop_front();
+			_pendingJobs--;
+			return true;
+		}
+	}
+
+	// Only once there's nothing more urgent to do
+	if (includeBackground) {
+		std::lock_guard<std::mutex> lock(_backgroundQueue.Mutex);
+		if (!_backgroundQueue.Jobs.empty()) {
+			job = std::move(_backgroundQueue.Jobs.front());
+			_backgroundQueue.Jobs.pop_front();
+			_pendingJobs--;
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <functional>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+
+/// <summary>
+/// A small work-stealing thread pool. Every thread (including the main thread) has its
+/// own job queue. Threads push and pop work from the back of their own queue, and steal
+/// from the front of other threads' queues when they run out of work
+///
+/// Long running work that shouldn't hold up a frame goes through SubmitBackground instead, into a
+/// separate queue that only the worker threads take from. Anything a background job submits (including
+/// ParallelFor chunks) goes to that queue as well, so the main thread never picks up a piece of it
+///
+/// If the job system has not been initialized, or has no workers, all work is run inline
+/// on the calling thread
+/// </summary>
+class JobSystem {
+public:
+	typedef std::function<void()> Job;
+	typedef std::function<void(size_t begin, size_t end)> RangeJob;
+
+	JobSystem() = delete;
+
+	/// <summary>
+	/// Starts up the worker threads, should be called once at application start
+	/// </summary>
+	/// <param name="numWorkers">The number of worker threads to create, or 0 to use one less than the number of hardware threads</param>
+	static void Init(uint32_t numWorkers = 0);
+	/// <summary>
+	/// Waits for all worker threads to finish their current jobs and shuts them down
+	/// </summary>
+	static void Shutdown();
+
+	/// <summary>
+	/// Gets the number of worker threads (not including the main thread)
+	/// </summary>
+	static uint32_t WorkerCount();
+	/// <summary>
+	/// Gets the index of the calling thread in the pool, 0 for the main thread and 1 to WorkerCount()
+	/// for the workers. Handy for giving each thread its own output list in a ParallelFor
+	/// </summary>
+	static size_t ThreadIndex();
+
+	/// <summary>
+	/// Queues a job to be run on any thread in the pool. If called from inside a job,
+	/// the job is pushed to the current thread's queue, or to the front of the background
+	/// queue if called from inside a background job
+	/// </summary>
+	/// <param name="job">The job to run</param>
+	static void Submit(Job job);
+	/// <summary>
+	/// Queues a long running job (ex: decoding a file) to be run on a worker thread. Unlike Submit,
+	/// these are never picked up by a thread that is helping out while it waits in ParallelFor, so the
+	/// main thread can't end up running them in the middle of a frame
+	/// </summary>
+	/// <param name="job">The job to run</param>
+	static void SubmitBackground(Job job);
+
+	/// <summary>
+	/// Splits the range [0, count) into chunks and runs them across all threads, blocking
+	/// until every chunk is done. The calling thread will help run jobs while it waits, so
+	/// this is safe to call from inside another job
+	/// </summary>
+	/// <param name="count">The number of items to process</param>
+	/// <param name="job">The function to invoke for each chunk, receives the begin and end indices of the chunk</param>
+	/// <param name="grainSize">The minimum number of items to process in a single chunk</param>
+	static void ParallelFor(size_t count, const RangeJob& job, size_t grainSize = 64);
+
+protected:
+	struct WorkQueue {
+		std::mutex      Mutex;
+		std::deque<Job> Jobs;
+	};
+
+	// One queue per thread, index 0 belongs to the main thread
+	static std::vector<WorkQueue*>  _queues;
+	// Jobs from SubmitBackground, in the order they were submitted
+	static WorkQueue                _backgroundQueue;
+	static std::vector<std::thread> _workers;
+
+	// Used to put workers to sleep when there's nothing to do
+	static std::mutex               _sleepMutex;
+	static std::condition_variable  _wakeCondition;
+	static std::atomic<size_t>      _pendingJobs;
+	static std::atomic<bool>        _isRunning;
+
+	// The index of the queue owned by the current thread
+	static thread_local size_t      _threadIndex;
+	// True while the current thread is running a job from the background queue
+	static thread_local bool        _isInBackgroundJob;
+
+	static void _WorkerLoop(size_t index);
+	/// <summary>
+	/// Pushes a job to the background queue, flagging it so that anything it submits stays in the background
+	/// </summary>
+	/// <param name="job">The job to push</param>
+	/// <param name="atFront">True to run the job before other background work, for pieces of a background job that's already running</param>
+	static void _PushBackground(Job job, bool atFront);
+	/// <summary>
+	/// Tries to pop a job from our own queue, then tries to steal from everyone else
+	/// </summary>
+	/// <param name="job">Receives the job that was found</param>
+	/// <param name="includeBackground">True to fall back to the background queue if there is no other work</param>
+	/// <returns>True if a job was found and stored in job</returns>
+	static bool _TryGetJob(Job& job, bool includeBackground);
+};
@@ -0,0 +1,158 @@
+#include "Utils/LZ4.h"
+#include <cstring>
+#include <algorithm>
+
+// LZ4 block format limits, see https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+static const size_t MIN_MATCH     = 4;
+// The last match must start at least this many bytes before the end of the block
+static const size_t MF_LIMIT      = 12;
+// The last this many bytes of a block are always literals
+static const size_t LAST_LITERALS = 5;
+static const size_t MAX_OFFSET    = 65535;
+static const int    HASH_BITS     = 16;
+
+/// <summary>
+/// Appends an LZ4 length continuation, used when a length doesn't fit in its 4 bits of the token
+/// </summary>
+static inline void AppendLZ4Length(std::vector<uint8_t>& out, size_t length) {
+	for (; length >= 255; length -= 255) {
+		out.push_back(255);
+	}
+	out.push_back(static_cast<uint8_t>(length));
+}
+
+static inline uint32_t ReadU32(const uint8_t* data) {
+	uint32_t result;
+	memcpy(&result, data, sizeof(uint32_t));
+	return result;
+}
+
+std::vector<uint8_t> LZ4::Compress(const uint8_t* data, size_t size) {
+	std::vector<uint8_t> result;
+	// Positions are stored as 32 bit values in the hash table
+	if (size > UINT32_MAX) {
+		return result;
+	}
+	result.reserve(size + size / 255 + 16);
+
+	// Greedy matching against the last position each 4 byte sequence was seen at
+	std::vector<uint32_t> table(1ull << HASH_BITS, UINT32_MAX);
+	size_t anchor = 0;
+	size_t ix = 0;
+
+	while (ix + MF_LIMIT <= size) {
+		uint32_t sequence = ReadU32(data + ix);
+		uint32_t hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+		uint32_t candidate = table[hash];
+		table[hash] = static_cast<uint32_t>(ix);
+
+		if (candidate == UINT32_MAX || ix - candidate > MAX_OFFSET || ReadU32(data + candidate) != sequence) {
+			ix++;
+			continue;
+		}
+
+		// Extend the match, without running into the literals at the end of the block
+		size_t matchLength = MIN_MATCH;
+		const size_t matchLimit = size - LAST_LITERALS;
+		while (ix + matchLength < matchLimit && data[candidate + matchLength] == data[ix + matchLength]) {
+			matchLength++;
+		}
+
+		size_t literals = ix - anchor;
+		size_t extraMatch = matchLength - MIN_MATCH;
+		result.push_back(static_cast<uint8_t>((std::min<size_t>(literals, 15) << 4) | std::min<size_t>(extraMatch, 15)));
+		if (literals >= 15) {
+			AppendLZ4Length(result, literals - 15);
+		}
+		result.insert(result.end(), data + anchor, data + ix);
+
+		size_t offset = ix - candidate;
+		result.push_back(static_cast<uint8_t>(offset & 0xFF));
+		result.push_back(static_cast<uint8_t>(offset >> 8));
+		if (extraMatch >= 15) {
+			AppendLZ4Length(result, extraMatch - 15);
+		}
+
+		ix += matchLength;
+		anchor = ix;
+	}
+
+	// Everything after the last match goes in a final literal only sequence
+	size_t literals = size - anchor;
+	result.push_back(static_cast<uint8_t>(std::min<size_t>(literals, 15) << 4));
+	if (literals >= 15) {
+		AppendLZ4Length(result, literals - 15);
+	}
+	result.insert(result.end(), data + anchor, data + size);
+
+	return result;
+}
+
+bool LZ4::Decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) {
+	size_t in = 0;
+	size_t out = 0;
+
+	// Reads a length continuation, returns false if it runs off the end of the input
+	auto readLength = [&](size_t& length) {
+		uint8_t value;
+		do {
+			if (in >= srcSize) {
+				return false;
+			}
+			value = src[in++];
+			length += value;
+		} while (value == 255);
+		return true;
+	};
+
+	while (in < srcSize) {
+		uint8_t token = src[in++];
+
+		size_t literals = token >> 4;
+		if (literals == 15 && !readLength(literals)) {
+			return false;
+		}
+		if (literals > srcSize - in || literals > dstSize - out) {
+			return false;
+		}
+		memcpy(dst + out, src + in, literals);
+		in += literals;
+		out += literals;
+
+		// The last sequence has no match
+		if (in == srcSize) {
+			break;
+		}
+
+		if (srcSize - in < 2) {
+			return false;
+		}
+		size_t offset = src[in] | (static_cast<size_t>(src[in + 1]) << 8);
+		in += 2;
+		if (offset == 0 || offset > out) {
+			return false;
+		}
+
+		size_t matchLength = token & 0x0F;
+		if (matchLength == 15 && !readLength(matchLength)) {
+			return false;
+		}
+		matchLength += MIN_MATCH;
+		if (matchLength > dstSize - out) {
+			return false;
+		}
+
+		// Matches can overlap the bytes they produce (ex: runs), so those have to be copied forwards one at a time
+		const uint8_t* match = dst + out - offset;
+		if (offset >= matchLength) {
+			memcpy(dst + out, match, matchLength);
+		} else {
+			for (size_t ix = 0; ix < matchLength; ix++) {
+				dst[out + ix] = match[ix];
+			}
+		}
+		out += matchLength;
+	}
+
+	return out == dstSize;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/// <summary>
+/// A small implementation of the LZ4 block format (without the frame header). Compression is a
+/// single greedy pass, so it's fast but not the smallest, while decompression is little more than
+/// a series of memcpys
+/// </summary>
+class LZ4 {
+public:
+	LZ4() = delete;
+
+	/// <summary>
+	/// Compresses a block of data
+	/// </summary>
+	/// <param name="data">The data to compress</param>
+	/// <param name="size">The size of the data in bytes, must be less than 4GB</param>
+	/// <returns>The compressed block, or an empty vector if the data is too large</returns>
+	static std::vector<uint8_t> Compress(const uint8_t* data, size_t size);
+
+	/// <summary>
+	/// Decompresses a block of data. The output size must be known up front, and the block must
+	/// decompress to exactly that many bytes
+	/// </summary>
+	/// <param name="src">The compressed block</param>
+	/// <param name="srcSize">The size of the compressed block in bytes</param>
+	/// <param name="dst">The buffer to decompress into</param>
+	/// <param name="dstSize">The size of the decompressed data in bytes</param>
+	/// <returns>True if the block was valid and decompressed to exactly dstSize bytes</returns>
+	static bool Decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
+};
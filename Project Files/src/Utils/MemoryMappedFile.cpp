@@ -0,0 +1,99 @@
+#include "Utils/MemoryMappedFile.h"
+#include <Logging.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+MemoryMappedFile::MemoryMappedFile() :
+	_data(nullptr),
+	_size(0),
+	_fileHandle(nullptr),
+	_mappingHandle(nullptr)
+{ }
+
+MemoryMappedFile::~MemoryMappedFile() {
+	#ifdef _WIN32
+	if (_data != nullptr) {
+		UnmapViewOfFile(_data);
+	}
+	if (_mappingHandle != nullptr) {
+		CloseHandle(_mappingHandle);
+	}
+	if (_fileHandle != nullptr) {
+		CloseHandle(_fileHandle);
+	}
+	#else
+	if (_data != nullptr) {
+		munmap(const_cast<uint8_t*>(_data), _size);
+	}
+	#endif
+}
+
+MemoryMappedFile::Sptr MemoryMappedFile::Open(const std::string& path) {
+	MemoryMappedFile::Sptr result(new MemoryMappedFile());
+
+	#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		LOG_ERROR("Could not open file '{}'", path);
+		return nullptr;
+	}
+	result->_fileHandle = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) {
+		LOG_ERROR("Could not get the size of file '{}'", path);
+		return nullptr;
+	}
+	result->_size = static_cast<size_t>(size.QuadPart);
+
+	// Windows won't map empty files, but there's nothing to read anyways
+	if (result->_size == 0) {
+		return result;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		LOG_ERROR("Could not create a file mapping for '{}'", path);
+		return nullptr;
+	}
+	result->_mappingHandle = mapping;
+
+	result->_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	#else
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0) {
+		LOG_ERROR("Could not open file '{}'", path);
+		return nullptr;
+	}
+
+	struct stat info;
+	if (fstat(file, &info) != 0) {
+		LOG_ERROR("Could not get the size of file '{}'", path);
+		close(file);
+		return nullptr;
+	}
+	result->_size = static_cast<size_t>(info.st_size);
+
+	if (result->_size > 0) {
+		void* data = mmap(nullptr, result->_size, PROT_READ, MAP_PRIVATE, file, 0);
+		result->_data = data != MAP_FAILED ? static_cast<const uint8_t*>(data) : nullptr;
+	}
+	// The mapping keeps its own reference to the file
+	close(file);
+	#endif
+
+	if (result->_data == nullptr && result->_size > 0) {
+		LOG_ERROR("Could not map file '{}' into memory", path);
+		return nullptr;
+	}
+
+	return result;
+}
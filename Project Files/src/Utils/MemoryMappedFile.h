@@ -0,0 +1,48 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/// <summary>
+/// A read-only view of a file's contents, mapped directly into memory by the OS. Pages are only
+/// loaded as they are touched, and nothing is copied into our own heap, so this is a good fit for
+/// large binary files that we only need to read once
+///
+/// The mapping stays valid for as long as the object is alive
+/// </summary>
+class MemoryMappedFile {
+public:
+	typedef std::shared_ptr<MemoryMappedFile> Sptr;
+
+	~MemoryMappedFile();
+
+	MemoryMappedFile(const MemoryMappedFile& other) = delete;
+	MemoryMappedFile& operator=(const MemoryMappedFile& other) = delete;
+
+	/// <summary>
+	/// Maps the given file into memory
+	/// </summary>
+	/// <param name="path">The path of the file to map</param>
+	/// <returns>The mapped file, or nullptr if the file could not be opened or mapped</returns>
+	static MemoryMappedFile::Sptr Open(const std::string& path);
+
+	/// <summary>
+	/// Gets a pointer to the start of the file's contents, or nullptr if the file is empty
+	/// </summary>
+	const uint8_t* Data() const { return _data; }
+	/// <summary>
+	/// Gets the size of the file in bytes
+	/// </summary>
+	size_t Size() const { return _size; }
+
+protected:
+	MemoryMappedFile();
+
+	const uint8_t* _data;
+	size_t         _size;
+
+	// Platform handles, stored as opaque values so we don't drag Windows.h into every header
+	void* _fileHandle;
+	void* _mappingHandle;
+};
@@ -570,16 +570,18 @@ void MeshFactory::CalculateTBN(MeshBuilder<Vertex>& mesh)
 		return;
 	}
 
-	for (size_t i = 0; i < mesh._vertices.size(); i++) {
-		vMap.SetTangent(mesh._vertices[i], glm::vec3(0.0f));
-		vMap.SetBiTangent(mesh._vertices[i], glm::vec3(0.0f));
-	}
+	// Accumulate in full precision, so that vertex types with packed tangents only get rounded once
+	std::vector<glm::vec3> tangents(mesh._vertices.size(), glm::vec3(0.0f));
+	std::vector<glm::vec3> bitangents(mesh._vertices.size(), glm::vec3(0.0f));
 
 	// Iterate over all indices in the mesh, we'll assume that the mesh is indexed
 	for (size_t i = 0; i < mesh._indices.size(); i += 3) {
-		Vertex& v1 = mesh._vertices[mesh._indices[i + 0u]];
-		Vertex& v2 = mesh._vertices[mesh._indices[i + 1u]];
-		Vertex& v3 = mesh._vertices[mesh._indices[i + 2u]];
+		const uint32_t i1 = mesh._indices[i + 0u];
+		const uint32_t i2 = mesh._indices[i + 1u];
+		const uint32_t i3 = mesh._indices[i + 2u];
+		Vertex& v1 = mesh._vertices[i1];
+		Vertex& v2 = mesh._vertices[i2];
+		Vertex& v3 = mesh._vertices[i3];
 
 		// Extract the positions from the mesh
 		glm::vec3 pos[3];
@@ -607,13 +609,20 @@ void MeshFactory::CalculateTBN(MeshBuilder<Vertex>& mesh)
 		glm::vec3 tangent = glm::normalize((deltaP1 * deltaT2.y - deltaP2 * deltaT1.y) * r);
 		glm::vec3 bitangent = glm::normalize((deltaP2 * deltaT1.x - deltaP1 * deltaT2.x) * r);
 
-		// Set attributes in the vertex
-		vMap.SetTangent(v1, glm::normalize((vMap.GetTangent(v1) + tangent) / 2.0f));
-		vMap.SetTangent(v2, glm::normalize((vMap.GetTangent(v2) + tangent) / 2.0f));
-		vMap.SetTangent(v3, glm::normalize((vMap.GetTangent(v3) + tangent) / 2.0f));
+		// Blend into the vertices' running tangents
+		tangents[i1] = glm::normalize((tangents[i1] + tangent) / 2.0f);
+		tangents[i2] = glm::normalize((tangents[i2] + tangent) / 2.0f);
+		tangents[i3] = glm::normalize((tangents[i3] + tangent) / 2.0f);
 
-		vMap.SetBiTangent(v1, glm::normalize((vMap.GetBiTangent(v1) + bitangent) / 2.0f));
-		vMap.SetBiTangent(v2, glm::normalize((vMap.GetBiTangent(v1) + bitangent) / 2.0f));
-		vMap.SetBiTangent(v3, glm::normalize((vMap.GetBiTangent(v1) + bitangent) / 2.0f));
+		bitangents[i1] = glm::normalize((bitangents[i1] + bitangent) / 2.0f);
+		bitangents[i2] = glm::normalize((bitangents[i2] + bitangent) / 2.0f);
+		bitangents[i3] = glm::normalize((bitangents[i3] + bitangent) / 2.0f);
+	}
+
+	// Set attributes in the vertices, the tangent goes first so that packed tangents pick up their
+	// handedness from the bitangent
+	for (size_t i = 0; i < mesh._vertices.size(); i++) {
+		vMap.SetTangent(mesh._vertices[i], tangents[i]);
+		vMap.SetBiTangent(mesh._vertices[i], bitangents[i]);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,429 @@
+#include "Utils/ObjParser.h"
+
+#include <string>
+#include <sstream>
+#include <charconv>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "Utils/JobSystem.h"
+#include "Utils/StringUtils.h"
+
+// We can construct a key using a bitmask of the attribute indices
+// This let's us quickly look up a combination of attributes to see if it's already been added
+// Note that this limits us to 2,097,150 unique attributes for positions, normals and textures
+inline uint64_t MakeVertexKey(const glm::ivec3& vertexIndices) {
+	const uint64_t mask = 0b0'000000000000000000000'000000000000000000000'111111111111111111111;
+	return ((vertexIndices.x & mask) << 42) | ((vertexIndices.y & mask) << 21) | (vertexIndices.z & mask);
+}
+
+// Files smaller than this aren't worth splitting up
+const size_t MIN_CHUNK_BYTES = 256 * 1024;
+
+bool ObjData::operator==(const ObjData& other) const {
+	return
+		Positions == other.Positions &&
+		Normals   == other.Normals &&
+		UVs       == other.UVs &&
+		Vertices  == other.Vertices &&
+		Indices   == other.Indices;
+}
+
+namespace {
+	// Everything parsed out of one chunk of the file
+	struct ObjChunk {
+		const char* Begin;
+		const char* End;
+
+		std::vector<glm::vec3>  Positions;
+		std::vector<glm::vec3>  Normals;
+		std::vector<glm::vec2>  UVs;
+
+		// Up to 4 corners per face, with the number of corners in FaceSizes
+		std::vector<glm::ivec3> Corners;
+		std::vector<uint8_t>    FaceSizes;
+		// Negative indices are relative to the attributes before them, which may be in an earlier chunk.
+		// Those are resolved against this chunk's attributes first, and flagged here (bit 0 for the
+		// position, 1 for the UV and 2 for the normal) so we can add the earlier chunks' counts later
+		std::vector<uint8_t>    RelativeMasks;
+
+		// The number of attributes in all the chunks before this one
+		glm::ivec3 Base = glm::ivec3(0);
+
+		// The unique corners in this chunk in the order they first appear, and the index of each corner
+		// into them, already triangulated
+		std::vector<uint64_t>   UniqueKeys;
+		std::vector<glm::ivec3> UniqueVertices;
+		std::vector<uint32_t>   LocalIndices;
+		// Maps indices into UniqueKeys to indices in the final mesh
+		std::vector<uint32_t>   Remap;
+		// Where this chunk's indices start in the final mesh
+		size_t IndexOffset = 0;
+	};
+
+	inline bool IsSpace(char c) {
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	inline const char* SkipSpaces(const char* p, const char* end) {
+		while (p < end && IsSpace(*p)) { p++; }
+		return p;
+	}
+
+	// Reads a float and returns the position after it, leaves the result as 0 if there isn't one
+	inline const char* ParseFloat(const char* p, const char* end, float& result) {
+		p = SkipSpaces(p, end);
+		// from_chars doesn't allow a leading plus, but streams do
+		if (p < end && *p == '+') { p++; }
+		result = 0.0f;
+		std::from_chars_result parsed = std::from_chars(p, end, result);
+		return parsed.ec == std::errc() ? parsed.ptr : p;
+	}
+
+	inline const char* ParseInt(const char* p, const char* end, int& result) {
+		if (p < end && *p == '+') { p++; }
+		result = 0;
+		std::from_chars_result parsed = std::from_chars(p, end, result);
+		return parsed.ec == std::errc() ? parsed.ptr : p;
+	}
+
+	// Reads a face corner in the form v, v/vt, v//vn or v/vt/vn. Missing indices are left as 0
+	inline const char* ParseCorner(const char* p, const char* end, glm::ivec3& result) {
+		result = glm::ivec3(0);
+		p = ParseInt(p, end, result.x);
+		if (p < end && *p == '/') {
+			p++;
+			if (p < end && *p != '/') {
+				p = ParseInt(p, end, result.y);
+			}
+			if (p < end && *p == '/') {
+				p = ParseInt(p + 1, end, result.z);
+			}
+		}
+		return p;
+	}
+
+	void ParseChunk(ObjChunk& chunk) {
+		const char* p = chunk.Begin;
+		const char* end = chunk.End;
+
+		while (p < end) {
+			const char* lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+			if (lineEnd == nullptr) { lineEnd = end; }
+
+			// Read in the first part of the line (ex: f, v, vn, etc...)
+			p = SkipSpaces(p, lineEnd);
+			const char* command = p;
+			while (p < lineEnd && !IsSpace(*p)) { p++; }
+			size_t commandLength = p - command;
+
+			// The v command defines a vertex's position
+			if (commandLength == 1 && command[0] == 'v') {
+				glm::vec3 position;
+				p = ParseFloat(p, lineEnd, position.x);
+				p = ParseFloat(p, lineEnd, position.y);
+				p = ParseFloat(p, lineEnd, position.z);
+				chunk.Positions.push_back(position);
+			}
+			else if (commandLength == 2 && command[0] == 'v' && command[1] == 'n') {
+				glm::vec3 normal;
+				p = ParseFloat(p, lineEnd, normal.x);
+				p = ParseFloat(p, lineEnd, normal.y);
+				p = ParseFloat(p, lineEnd, normal.z);
+				chunk.Normals.push_back(normal);
+			}
+			else if (commandLength == 2 && command[0] == 'v' && command[1] == 't') {
+				glm::vec2 uv;
+				p = ParseFloat(p, lineEnd, uv.x);
+				p = ParseFloat(p, lineEnd, uv.y);
+				chunk.UVs.push_back(uv);
+			}
+			// The f command defines a polygon in the mesh, anything past the 4th corner is ignored
+			else if (commandLength == 1 && command[0] == 'f') {
+				uint8_t count = 0;
+				p = SkipSpaces(p, lineEnd);
+				while (p < lineEnd && count < 4) {
+					glm::ivec3 corner;
+					const char* next = ParseCorner(p, lineEnd, corner);
+					if (next == p) { break; }
+					p = SkipSpaces(next, lineEnd);
+
+					// Resolve negative indices against what we've seen so far, see RelativeMasks
+					uint8_t relative = 0;
+					if (corner.x < 0) { corner.x = static_cast<int>(chunk.Positions.size()) + 1 + corner.x; relative |= 0b001; }
+					if (corner.y < 0) { corner.y = static_cast<int>(chunk.UVs.size())       + 1 + corner.y; relative |= 0b010; }
+					if (corner.z < 0) { corner.z = static_cast<int>(chunk.Normals.size())   + 1 + corner.z; relative |= 0b100; }
+
+					chunk.Corners.push_back(corner);
+					chunk.RelativeMasks.push_back(relative);
+					count++;
+				}
+				chunk.FaceSizes.push_back(count);
+			}
+
+			// Anything else (comments, groups, materials) is skipped
+			p = lineEnd + 1;
+		}
+	}
+
+	void DeduplicateChunk(ObjChunk& chunk) {
+		std::unordered_map<uint64_t, uint32_t> vertexMap;
+		vertexMap.reserve(chunk.Corners.size());
+		chunk.LocalIndices.reserve(chunk.FaceSizes.size() * 3);
+
+		size_t cornerIx = 0;
+		for (uint8_t faceSize : chunk.FaceSizes) {
+			uint32_t edges[4];
+			for (uint8_t ix = 0; ix < faceSize; ix++, cornerIx++) {
+				glm::ivec3 corner = chunk.Corners[cornerIx];
+				uint8_t relative = chunk.RelativeMasks[cornerIx];
+				if (relative & 0b001) { corner.x += chunk.Base.x; }
+				if (relative & 0b010) { corner.y += chunk.Base.y; }
+				if (relative & 0b100) { corner.z += chunk.Base.z; }
+
+				uint64_t key = MakeVertexKey(corner);
+				auto it = vertexMap.find(key);
+				if (it != vertexMap.end()) {
+					edges[ix] = it->second;
+				} else {
+					uint32_t index = static_cast<uint32_t>(chunk.UniqueKeys.size());
+					chunk.UniqueKeys.push_back(key);
+					chunk.UniqueVertices.push_back(corner - glm::ivec3(1));
+					vertexMap[key] = index;
+					edges[ix] = index;
+				}
+			}
+
+			// Corners of faces with less than 3 corners still count as vertices, but make no triangles
+			if (faceSize >= 3) {
+				chunk.LocalIndices.push_back(edges[0]);
+				chunk.LocalIndices.push_back(edges[1]);
+				chunk.LocalIndices.push_back(edges[2]);
+			}
+			if (faceSize == 4) {
+				chunk.LocalIndices.push_back(edges[0]);
+				chunk.LocalIndices.push_back(edges[2]);
+				chunk.LocalIndices.push_back(edges[3]);
+			}
+		}
+
+		// We don't need the raw corners anymore
+		chunk.Corners = std::vector<glm::ivec3>();
+		chunk.RelativeMasks = std::vector<uint8_t>();
+	}
+}
+
+ObjData ObjParser::Parse(const FileData::Sptr& file) {
+	if (file == nullptr) {
+		throw std::runtime_error("Failed to open file");
+	}
+
+	ObjData result;
+	const char* data = reinterpret_cast<const char*>(file->Data());
+	size_t size = file->Size();
+	if (data == nullptr || size == 0) {
+		return result;
+	}
+
+	// Split the file into a few chunks per thread, so that stealing can balance out uneven lines
+	size_t maxChunks = (JobSystem::WorkerCount() + 1) * 4;
+	size_t numChunks = std::max<size_t>(1, std::min(maxChunks, size / MIN_CHUNK_BYTES));
+	std::vector<ObjChunk> chunks(numChunks);
+	const char* dataEnd = data + size;
+	const char* chunkBegin = data;
+	for (size_t ix = 0; ix < numChunks; ix++) {
+		const char* chunkEnd = dataEnd;
+		if (ix + 1 < numChunks) {
+			// Move the split up to the start of the next line. If a long line ran past our split already,
+			// this chunk is just empty
+			chunkEnd = std::max(chunkBegin, data + (size * (ix + 1)) / numChunks);
+			if (chunkEnd > chunkBegin) {
+				const char* newline = static_cast<const char*>(memchr(chunkEnd - 1, '\n', dataEnd - (chunkEnd - 1)));
+				chunkEnd = newline != nullptr ? newline + 1 : dataEnd;
+			}
+		}
+		chunks[ix].Begin = chunkBegin;
+		chunks[ix].End = chunkEnd;
+		chunkBegin = chunkEnd;
+	}
+
+	// Tokenize all the chunks at the same time
+	JobSystem::ParallelFor(numChunks, [&](size_t begin, size_t end) {
+		for (size_t ix = begin; ix < end; ix++) {
+			ParseChunk(chunks[ix]);
+		}
+	}, 1);
+
+	// Now that we know how many attributes each chunk has, we know where they'll all end up
+	glm::ivec3 base = glm::ivec3(0);
+	for (ObjChunk& chunk : chunks) {
+		chunk.Base = base;
+		base += glm::ivec3(chunk.Positions.size(), chunk.UVs.size(), chunk.Normals.size());
+	}
+
+	JobSystem::ParallelFor(numChunks, [&](size_t begin, size_t end) {
+		for (size_t ix = begin; ix < end; ix++) {
+			DeduplicateChunk(chunks[ix]);
+		}
+	}, 1);
+
+	// Merge the unique vertices in file order, so that they're numbered the same way as if we'd gone
+	// through the file front to back. A chunk's unique corners are already in first seen order, so a
+	// vertex is always numbered by the first chunk that has it
+	result.Positions.reserve(base.x);
+	result.UVs.reserve(base.y);
+	result.Normals.reserve(base.z);
+	size_t numUnique = 0;
+	size_t numIndices = 0;
+	for (ObjChunk& chunk : chunks) {
+		numUnique += chunk.UniqueKeys.size();
+		chunk.IndexOffset = numIndices;
+		numIndices += chunk.LocalIndices.size();
+	}
+
+	std::unordered_map<uint64_t, uint32_t> vertexMap;
+	vertexMap.reserve(numUnique);
+	for (ObjChunk& chunk : chunks) {
+		result.Positions.insert(result.Positions.end(), chunk.Positions.begin(), chunk.Positions.end());
+		result.UVs.insert(result.UVs.end(), chunk.UVs.begin(), chunk.UVs.end());
+		result.Normals.insert(result.Normals.end(), chunk.Normals.begin(), chunk.Normals.end());
+
+		chunk.Remap.resize(chunk.UniqueKeys.size());
+		for (size_t ix = 0; ix < chunk.UniqueKeys.size(); ix++) {
+			auto it = vertexMap.find(chunk.UniqueKeys[ix]);
+			if (it != vertexMap.end()) {
+				chunk.Remap[ix] = it->second;
+			} else {
+				uint32_t index = static_cast<uint32_t>(result.Vertices.size());
+				result.Vertices.push_back(chunk.UniqueVertices[ix]);
+				vertexMap[chunk.UniqueKeys[ix]] = index;
+				chunk.Remap[ix] = index;
+			}
+		}
+	}
+
+	// Every chunk knows where its indices go, so they can all be written at once
+	result.Indices.resize(numIndices);
+	JobSystem::ParallelFor(numChunks, [&](size_t begin, size_t end) {
+		for (size_t ix = begin; ix < end; ix++) {
+			const ObjChunk& chunk = chunks[ix];
+			uint32_t* out = result.Indices.data() + chunk.IndexOffset;
+			for (uint32_t local : chunk.LocalIndices) {
+				*out++ = chunk.Remap[local];
+			}
+		}
+	}, 1);
+
+	return result;
+}
+
+ObjData ObjParser::ParseStream(std::istream& file) {
+	ObjData result;
+
+	// Maps a key generated from obj indices to a vertex index that
+	// has been added to the mesh already
+	std::unordered_map<uint64_t, uint32_t> vertexMap;
+
+	// Storage for temporary data
+	std::string line;
+	glm::vec3 vecData;
+	glm::ivec3 vertexIndices;
+
+	// Read and process the entire file
+	while (file.peek() != EOF) {
+		// Read in the first part of the line (ex: f, v, vn, etc...)
+		std::string command;
+		file >> command;
+
+		// We will ignore the rest of the line for comment lines
+		if (command == "#") {
+			std::getline(file, line);
+		}
+
+		// The v command defines a vertex's position
+		else if (command == "v") {
+			// Read in and store a position
+			file >> vecData.x >> vecData.y >> vecData.z;
+			result.Positions.push_back(vecData);
+		}
+		else if (command == "vn") {
+			// Read in and store a normal
+			file >> vecData.x >> vecData.y >> vecData.z;
+			result.Normals.push_back(vecData);
+		}
+		else if (command == "vt") {
+			// Read in and store a texture coordinate
+			file >> vecData.x >> vecData.y;
+			result.UVs.push_back(vecData);
+		}
+
+		// The f command defines a polygon in the mesh
+		// NOTE: make sure you triangulate in blender, otherwise it will
+		// output quads instead of triangles
+		else if (command == "f") {
+			// Read the rest of the line from the file
+			std::getline(file, line);
+			// Trim whitespace from either end of the line
+			StringTools::Trim(line);
+			// Create a string stream so we can use streaming operators on it
+			std::stringstream stream = std::stringstream(line);
+
+			uint32_t edges[4];
+			int ix = 0;
+			// Iterate over up to 4 sets of attributes
+			for (; ix < 4; ix++) {
+				if (stream.peek() != EOF) {
+					// Load in the faces, split up by slashes
+					char tempChar;
+					vertexIndices = glm::ivec3(0);
+					stream >> vertexIndices.x >> tempChar >> vertexIndices.y >> tempChar >> vertexIndices.z;
+					// The OBJ format can have negative values, which are a reference from the last added attributes
+					if (vertexIndices.x < 0) { vertexIndices.x = result.Positions.size() + 1 + vertexIndices.x; }
+					if (vertexIndices.y < 0) { vertexIndices.y = result.UVs.size()       + 1 + vertexIndices.y; }
+					if (vertexIndices.z < 0) { vertexIndices.z = result.Normals.size()   + 1 + vertexIndices.z; }
+
+					uint64_t key = MakeVertexKey(vertexIndices);
+
+					// Find the index associated with the combination of attributes
+					auto it = vertexMap.find(key);
+
+					// If it exists, we push the index to our indices
+					if (it != vertexMap.end()) {
+						edges[ix] = it->second;
+					} else {
+						result.Vertices.push_back(vertexIndices - glm::ivec3(1));
+						uint32_t index = static_cast<uint32_t>(result.Vertices.size()) - 1;
+
+						// Cache the index based on our key
+						vertexMap[key] = index;
+						// Add index to mesh, and add to edges list for if we are using quads
+						edges[ix] = index;
+					}
+				}
+				// We've reached the end of the line, break out of the loop
+				else { break; }
+			}
+
+			// Handling for triangle faces
+			if (ix == 3) {
+				result.Indices.push_back(edges[0]);
+				result.Indices.push_back(edges[1]);
+				result.Indices.push_back(edges[2]);
+			}
+			// Handling for quad faces
+			else if (ix == 4) {
+				result.Indices.push_back(edges[0]);
+				result.Indices.push_back(edges[1]);
+				result.Indices.push_back(edges[2]);
+
+				result.Indices.push_back(edges[0]);
+				result.Indices.push_back(edges[2]);
+				result.Indices.push_back(edges[3]);
+			}
+		}
+	}
+
+	return result;
+}
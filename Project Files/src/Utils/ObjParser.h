@@ -0,0 +1,54 @@
+#pragma once
+#include <vector>
+#include <istream>
+#include <cstdint>
+#include <GLM/glm.hpp>
+
+#include "Utils/FileData.h"
+
+/// <summary>
+/// The contents of an OBJ file, before it's turned into vertices of a given type
+/// </summary>
+struct ObjData {
+	std::vector<glm::vec3>  Positions;
+	std::vector<glm::vec3>  Normals;
+	std::vector<glm::vec2>  UVs;
+	// Every unique combination of position, UV and normal indices that the faces use, in the order
+	// that they first appear. These are zero based, so -1 means that a face corner had no UV or normal
+	std::vector<glm::ivec3> Vertices;
+	// Triangle list of indices into Vertices, quads are split into 2 triangles
+	std::vector<uint32_t>   Indices;
+
+	bool operator==(const ObjData& other) const;
+	bool operator!=(const ObjData& other) const { return !(*this == other); }
+};
+
+/// <summary>
+/// Parses the v, vt, vn and f records of OBJ files, everything else is ignored
+/// </summary>
+class ObjParser {
+public:
+	/// <summary>
+	/// Parses an OBJ file that has already been opened (see FileHelpers::OpenFile)
+	///
+	/// The file is split into chunks at line boundaries, which are tokenized in parallel on the job
+	/// system with std::from_chars. Vertices are deduplicated within each chunk in parallel, then merged
+	/// in file order, so the result is the same as parsing the file front to back
+	/// </summary>
+	/// <param name="file">The file to parse</param>
+	/// <returns>The parsed mesh data</returns>
+	static ObjData Parse(const FileData::Sptr& file);
+
+	/// <summary>
+	/// The original stream based parser, one token at a time. Kept around as a reference to check
+	/// Parse against, and to benchmark it against. Note that this only understands faces in the
+	/// v/vt/vn form, it drops faces written as v//vn or v
+	/// </summary>
+	/// <param name="stream">The stream to read the OBJ data from</param>
+	/// <returns>The parsed mesh data</returns>
+	static ObjData ParseStream(std::istream& stream);
+
+protected:
+	ObjParser() = default;
+	~ObjParser() = default;
+};
@@ -7,8 +7,15 @@
 #include <fstream>
 #include <iostream>
 #include <filesystem>
+#include <cstring>
+#include <atomic>
+#include <GLM/gtc/packing.hpp>
 
 #include "Utils/StringUtils.h"
+#include "Utils/FileHelpers.h"
+#include "Utils/ObjParser.h"
+#include "Utils/JobSystem.h"
+#include "Utils/LZ4.h"
 #include "GLFW/glfw3.h"
 #include "Logging.h"
 
@@ -17,6 +24,54 @@ const std::string binaryExtension = ".bin";
 
 namespace fs = std::filesystem;
 
+// Version 2 data is compressed in blocks of this many bytes, so that they can be decompressed in parallel
+const size_t COMPRESSION_BLOCK_SIZE = 256 * 1024;
+// The minimum number of vertices to decode in a single job
+const size_t DECODE_GRAIN_SIZE = 4096;
+
+inline size_t AlignUp(size_t value, size_t alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+// Octahedral encoding of unit vectors, see "A Survey of Efficient Representations for Independent Unit Vectors"
+inline glm::vec2 OctahedralEncode(const glm::vec3& value) {
+	float length = glm::abs(value.x) + glm::abs(value.y) + glm::abs(value.z);
+	if (length == 0.0f) {
+		return glm::vec2(0.0f);
+	}
+	glm::vec3 n = value / length;
+	glm::vec2 result = glm::vec2(n.x, n.y);
+	if (n.z < 0.0f) {
+		result = (1.0f - glm::abs(glm::vec2(n.y, n.x))) * glm::vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+	}
+	return result;
+}
+
+inline glm::vec3 OctahedralDecode(const glm::vec2& value) {
+	glm::vec3 n = glm::vec3(value.x, value.y, 1.0f - glm::abs(value.x) - glm::abs(value.y));
+	if (n.z < 0.0f) {
+		glm::vec2 folded = (1.0f - glm::abs(glm::vec2(n.y, n.x))) * glm::vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+		n.x = folded.x;
+		n.y = folded.y;
+	}
+	return glm::normalize(n);
+}
+
+/// <summary>
+/// Makes sure every attribute lands inside of a vertex, otherwise the GPU would read past the buffer
+/// </summary>
+static bool ValidateVertexDeclaration(const std::vector<BufferAttribute>& vertexDeclaration, uint16_t vertexStride, const std::string& filename) {
+	for (const BufferAttribute& attrib : vertexDeclaration) {
+		size_t attribSize = GetAttributeSize(attrib.Type, attrib.Size);
+		if (attribSize == 0 || attrib.Size > 4 || attrib.Stride != vertexStride ||
+			attrib.Offset < 0 || attrib.Offset + attribSize > vertexStride) {
+			LOG_ERROR("Invalid vertex attribute in slot {} of \"{}\"", attrib.Slot, filename);
+			return false;
+		}
+	}
+	return true;
+}
+
 VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& filename) {
 	// Get the file extension and lowercase it
 	fs::path filePath = std::filesystem::path(filename);
@@ -28,7 +83,7 @@ VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& file
 		// Get the binary path
 		fs::path binPath = filePath.replace_extension(binaryExtension);
 		// If the file does not exist, convert the OBJ file to a binary file
-		if (!fs::exists(binPath)) {
+		if (!FileHelpers::Exists(binPath.string())) {
 			ConvertToBinary(filename, binPath.string());
 		}
 		// Load the corresponding binary file
@@ -73,152 +128,33 @@ void OptimizedObjLoader::ConvertToBinary(const std::string& inFile, const std::s
 }
 
 MeshBuilder<VertexPosNormTexColTangents>* OptimizedObjLoader::_LoadFromObjFile(const std::string& filename) {
-	// Open our file in binary mode
-	std::ifstream file;
-	file.open(filename, std::ios::binary);
+	float startTime = static_cast<float>(glfwGetTime());
 
-	// If our file fails to open, we will throw an error
-	if (!file) {
-		throw std::runtime_error("Failed to open file");
-	}
+	// Parse the file, which may be in a pak archive
+	ObjData data = ObjParser::Parse(FileHelpers::OpenFile(filename));
 
 	// Could also take this in as a parameter
 	glm::vec4 color = glm::vec4(1.0f);
 
-	// Our attributes
-	std::vector<glm::vec3>  positions;
-	std::vector<glm::vec3>  normals;
-	std::vector<glm::vec2>  uvs;
-	std::vector<glm::ivec3> vertices;
-	std::vector<uint32_t>   indices;
-
-	// Maps a key generated from obj indices to a vertex index that
-	// has been added to the mesh already
-	std::unordered_map<uint64_t, uint32_t> vertexMap;
-
 	// We'll use the mesh builder since it supports easily adding
 	// vertices and indices
 	MeshBuilder<VertexPosNormTexColTangents>* mesh = new MeshBuilder<VertexPosNormTexColTangents>();
 
-	// Storage for temporary data
-	std::string line;
-	glm::vec3 vecData;
-	glm::ivec3 vertexIndices;
-
-	float startTime = static_cast<float>(glfwGetTime());
-
-	// Read and process the entire file
-	while (file.peek() != EOF) {
-		// Read in the first part of the line (ex: f, v, vn, etc...)
-		std::string command;
-		file >> command;
-
-		// We will ignore the rest of the line for comment lines
-		if (command == "#") {
-			std::getline(file, line);
-		}
-
-		// The v command defines a vertex's position
-		else if (command == "v") {
-			// Read in and store a position
-			file >> vecData.x >> vecData.y >> vecData.z;
-			positions.push_back(vecData);
-		}
-		// TODO: handle normals and textures
-		else if (command == "vn") {
-			// Read in and store a position
-			file >> vecData.x >> vecData.y >> vecData.z;
-			normals.push_back(vecData);
-		} else if (command == "vt") {
-			// Read in and store a position
-			file >> vecData.x >> vecData.y;
-			uvs.push_back(vecData);
-		}
-
-		// The f command defines a polygon in the mesh
-		// NOTE: make sure you triangulate in blender, otherwise it will
-		// output quads instead of triangles
-		else if (command == "f") {
-			// Read the rest of the line from the file
-			std::getline(file, line);
-			// Trim whitespace from either end of the line
-			StringTools::Trim(line);
-			// Create a string stream so we can use streaming operators on it
-			std::stringstream stream = std::stringstream(line);
-
-			uint32_t edges[4];
-			int ix = 0;
-			// Iterate over up to 4 sets of attributes
-			for (; ix < 4; ix++) {
-				if (stream.peek() != EOF) {
-					// Load in the faces, split up by slashes
-					char tempChar;
-					vertexIndices = glm::ivec3(0);
-					stream >> vertexIndices.x >> tempChar >> vertexIndices.y >> tempChar >> vertexIndices.z;
-					// The OBJ format can have negative values, which are a reference from the last added attributes
-					if (vertexIndices.x < 0) { vertexIndices.x = positions.size() + 1 + vertexIndices.x; }
-					if (vertexIndices.y < 0) { vertexIndices.y = uvs.size()       + 1 + vertexIndices.y; }
-					if (vertexIndices.z < 0) { vertexIndices.z = normals.size()   + 1 + vertexIndices.z; }
-
-					// We can construct a key using a bitmask of the attribute indices
-					// This let's us quickly look up a combination of attributes to see if it's already been added
-					// Note that this limits us to 2,097,150 unique attributes for positions, normals and textures
-					const uint64_t mask = 0b0'000000000000000000000'000000000000000000000'111111111111111111111;
-					uint64_t key = ((vertexIndices.x & mask) << 42) | ((vertexIndices.y & mask) << 21) | (vertexIndices.z & mask);
-
-					// Find the index associated with the combination of attributes
-					auto it = vertexMap.find(key);
-
-					// If it exists, we push the index to our indices
-					if (it != vertexMap.end()) {
-						edges[ix] = it->second;
-					} else {
-						vertices.push_back(vertexIndices - glm::ivec3(1));
-						uint32_t index = static_cast<uint32_t>(vertices.size()) - 1;
-
-						// Cache the index based on our key
-						vertexMap[key] = index;
-						// Add index to mesh, and add to edges list for if we are using quads
-						edges[ix] = index;
-					}
-				}
-				// We've reached the end of the line, break out of the loop
-				else { break; }
-			}
-
-			// Handling for triangle faces
-			if (ix == 3) {
-				indices.push_back(edges[0]);
-				indices.push_back(edges[1]);
-				indices.push_back(edges[2]);
-			}
-			// Handling for quad faces
-			else if (ix == 4) {
-				indices.push_back(edges[0]);
-				indices.push_back(edges[1]);
-				indices.push_back(edges[2]);
-
-				indices.push_back(edges[0]);
-				indices.push_back(edges[2]);
-				indices.push_back(edges[3]);
-			}
-		}
-	}
-
-	mesh->ReserveVertexSpace(vertices.size());
-	for (const auto& vertexIndices : vertices) {
+	mesh->ReserveVertexSpace(data.Vertices.size());
+	for (const auto& vertexIndices : data.Vertices) {
 		// Construct a new vertex using the indices for the vertex
+		// NOTE: the first UV and normal are treated as missing, same as they always have been
 		VertexPosNormTexColTangents vertex;
-		vertex.Position = positions[vertexIndices.x];
-		vertex.UV       = vertexIndices.y != 0 ? uvs[vertexIndices.y] : glm::vec2(0.0f);
-		vertex.Normal   = vertexIndices.z != 0 ? normals[vertexIndices.z] : glm::vec3(0.0f, 0.0f, 1.0f);
+		vertex.Position = data.Positions[vertexIndices.x];
+		vertex.UV       = vertexIndices.y > 0 ? data.UVs[vertexIndices.y] : glm::vec2(0.0f);
+		vertex.Normal   = vertexIndices.z > 0 ? data.Normals[vertexIndices.z] : glm::vec3(0.0f, 0.0f, 1.0f);
 		vertex.Color    = color;
 
 		// Add to the mesh, get index of the added vertex
 		mesh->AddVertex(vertex);
 	}
-	mesh->ReserveIndexSpace(indices.size());
-	for (uint32_t ix : indices) {
+	mesh->ReserveIndexSpace(data.Indices.size());
+	for (uint32_t ix : data.Indices) {
 		mesh->AddIndex(ix);
 	}
 
@@ -235,37 +171,45 @@ MeshBuilder<VertexPosNormTexColTangents>* OptimizedObjLoader::_LoadFromObjFile(c
 
 VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string& filename) {
 
-	// Open the output file
-	std::ifstream file(filename, std::ios::binary);
+	// Map the binary file, everything below reads straight out of the mapping (or the archive's mapping)
+	FileData::Sptr file = FileHelpers::OpenFile(filename);
 	// If our file fails to open, we will throw an error
-	if (!file) { throw std::runtime_error("Failed to open file"); }
+	if (file == nullptr) { throw std::runtime_error("Failed to open file"); }
 
 	float startTime = static_cast<float>(glfwGetTime());
 
-	// Get the file size so we can avoid reading past the end
-	file.seekg(0, std::ios::end);
-	size_t size = file.tellg();
-	file.seekg(0, std::ios::beg);
+	const uint8_t* data = file->Data();
+	size_t size = file->Size();
 
-	// Read the header from the file
+	// Copy the header out, the mapping makes no promises about alignment
 	BinaryHeader header = BinaryHeader();
 	if (size >= sizeof(BinaryHeader)) {
-		file.read(reinterpret_cast<char*>(&header), sizeof(BinaryHeader));
+		memcpy(&header, data, sizeof(BinaryHeader));
 	} else {
 		LOG_ERROR("Not enough data in the file!");
 		return nullptr;
 	}
 
-	// TODO: validate header
+	// Make sure this is actually one of our files
+	if (memcmp(header.HeaderBytes, HEADER_BYTES, sizeof(HEADER_BYTES)) != 0) {
+		LOG_ERROR("\"{}\" is not a binary mesh file!", filename);
+		return nullptr;
+	}
 
 	// Handle our version
 	if (header.Version == 0x01) {
+		size_t indexSize = GetIndexTypeSize(header.IndicesType);
+		if (header.NumIndices > 0 && indexSize == 0) {
+			LOG_ERROR("Unknown index type in \"{}\"", filename);
+			return nullptr;
+		}
+
 		// Determine how many bytes we need in the file
 		size_t requiredBytes =
 			sizeof(BinaryHeader) +
 			(header.NumAttributes * sizeof(BufferAttribute)) +
 			(header.VertexStride * (size_t)header.NumVertices) +
-			(header.NumIndices * GetIndexTypeSize(header.IndicesType));
+			(header.NumIndices * indexSize);
 
 		// Make sure there's enough data in the file
 		if (size < requiredBytes) {
@@ -273,41 +217,32 @@ VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string&
 			return nullptr;
 		}
 
-		// Read all attributes from the file, this is basically our VDECL
+		// Copy out the attributes, this is basically our VDECL. It's tiny, and the VAO needs its own copy anyways
 		std::vector<BufferAttribute> vertexDeclaration;
 		vertexDeclaration.resize(header.NumAttributes);
-		for (int ix = 0; ix < header.NumAttributes; ix++) {
-			file.read(reinterpret_cast<char*>(&vertexDeclaration[ix]), sizeof(BufferAttribute));
+		const uint8_t* cursor = data + sizeof(BinaryHeader);
+		memcpy(vertexDeclaration.data(), cursor, header.NumAttributes * sizeof(BufferAttribute));
+		cursor += header.NumAttributes * sizeof(BufferAttribute);
+
+		if (!ValidateVertexDeclaration(vertexDeclaration, header.VertexStride, filename)) {
+			return nullptr;
 		}
 
 		// These will have the buffer pointers
 		IndexBuffer::Sptr indices = nullptr;
 		VertexBuffer::Sptr vertices = nullptr;
 
-		// If we have index data, load it
+		// If we have index data, upload it straight from the file. The data is never modified, so
+		// immutable storage lets the driver put it wherever it likes
 		if (header.NumIndices > 0) {
-			// Create index buffer
 			indices = IndexBuffer::Create(BufferUsage::StaticDraw);
-
-			// Create memory to store indices, then read from the file
-			void* dataStore = malloc(header.NumIndices * GetIndexTypeSize(header.IndicesType));
-			file.read(reinterpret_cast<char*>(dataStore), header.NumIndices * GetIndexTypeSize(header.IndicesType));
-			
-			// Load data into OpenGL and free the CPU memory we allocated
-			indices->LoadData(dataStore, GetIndexTypeSize(header.IndicesType), header.NumIndices, header.IndicesType);
-			free(dataStore);
+			indices->LoadImmutableData(cursor, (uint32_t)indexSize, header.NumIndices, header.IndicesType);
+			cursor += header.NumIndices * indexSize;
 		}
 
-		// Create a new VBO
+		// Same deal for the vertices
 		vertices = VertexBuffer::Create(BufferUsage::StaticDraw);
-
-		// Create memory to store vertices and load from file
-		void* vertexStore = malloc(header.NumVertices * (size_t)header.VertexStride);
-		file.read(reinterpret_cast<char*>(vertexStore), header.NumVertices * (size_t)header.VertexStride);
-
-		// Load data into OpenGL and free the CPU copy
-		vertices->LoadData(vertexStore, header.VertexStride, header.NumVertices);
-		free(vertexStore);
+		vertices->LoadImmutableData(cursor, header.VertexStride, header.NumVertices);
 
 		// Create the VAO and attach our index and vertex buffers
 		VertexArrayObject::Sptr result = VertexArrayObject::Create();
@@ -323,6 +258,406 @@ VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string&
 
 		return result;
 	}
+	else if (header.Version == 0x02) {
+		VertexArrayObject::Sptr result = _LoadBinaryV2(data, size, header, filename);
+		if (result != nullptr) {
+			float endTime = static_cast<float>(glfwGetTime());
+			LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices)", filename, endTime - startTime, header.NumVertices, header.NumIndices);
+		}
+		return result;
+	}
 
+	LOG_ERROR("Unsupported binary mesh version {} in \"{}\"", header.Version, filename);
 	return nullptr;
 }
+
+OptimizedObjLoader::AttribEncoding OptimizedObjLoader::_ChooseEncoding(const BufferAttribute& attrib) {
+	if (attrib.Type != AttributeType::Float || attrib.Normalized) {
+		return AttribEncoding::Raw;
+	}
+	switch (attrib.Usage) {
+		case AttribUsage::Position:
+			return attrib.Size == 3 ? AttribEncoding::Quantized16 : AttribEncoding::Raw;
+		case AttribUsage::Normal:
+		case AttribUsage::Tangent:
+		case AttribUsage::BiTangent:
+			return attrib.Size == 3 ? AttribEncoding::Octahedral16 : AttribEncoding::Raw;
+		case AttribUsage::Texture:
+		case AttribUsage::Texture1:
+		case AttribUsage::Texture2:
+		case AttribUsage::Texture3:
+			return attrib.Size == 2 ? AttribEncoding::Half2 : AttribEncoding::Raw;
+		case AttribUsage::Color:
+		case AttribUsage::Color1:
+		case AttribUsage::Color2:
+		case AttribUsage::Color3:
+			return attrib.Size == 4 ? AttribEncoding::UNorm8x4 : AttribEncoding::Raw;
+		default:
+			return AttribEncoding::Raw;
+	}
+}
+
+size_t OptimizedObjLoader::_GetEncodedSize(AttribEncoding encoding, const BufferAttribute& attrib) {
+	bool isFloat = attrib.Type == AttributeType::Float;
+	switch (encoding) {
+		case AttribEncoding::Raw:          return GetAttributeSize(attrib.Type, attrib.Size);
+		case AttribEncoding::Quantized16:  return isFloat && attrib.Size == 3 ? 3 * sizeof(uint16_t) : 0;
+		case AttribEncoding::Octahedral16: return isFloat && attrib.Size == 3 ? 2 * sizeof(int16_t)  : 0;
+		case AttribEncoding::Half2:        return isFloat && attrib.Size == 2 ? 2 * sizeof(uint16_t) : 0;
+		case AttribEncoding::UNorm8x4:     return isFloat && attrib.Size == 4 ? 4 * sizeof(uint8_t)  : 0;
+		default:
+			return 0;
+	}
+}
+
+VertexArrayObject::Sptr OptimizedObjLoader::_LoadBinaryV2(const uint8_t* data, size_t size, const BinaryHeader& header, const std::string& filename) {
+	size_t indexSize = GetIndexTypeSize(header.IndicesType);
+	if (header.NumIndices > 0 && indexSize == 0) {
+		LOG_ERROR("Unknown index type in \"{}\"", filename);
+		return nullptr;
+	}
+
+	// The attributes describe the layout that was saved, and are followed by how each one is stored
+	size_t headerBytes = sizeof(BinaryHeader) + header.NumAttributes * (sizeof(BufferAttribute) + sizeof(AttribEncoding)) + sizeof(BinaryHeaderV2);
+	if (size < headerBytes) {
+		LOG_ERROR("Not enough data in the file!");
+		return nullptr;
+	}
+
+	std::vector<BufferAttribute> vertexDeclaration;
+	vertexDeclaration.resize(header.NumAttributes);
+	std::vector<AttribEncoding> encodings;
+	encodings.resize(header.NumAttributes);
+	BinaryHeaderV2 extra;
+
+	const uint8_t* cursor = data + sizeof(BinaryHeader);
+	memcpy(vertexDeclaration.data(), cursor, header.NumAttributes * sizeof(BufferAttribute));
+	cursor += header.NumAttributes * sizeof(BufferAttribute);
+	memcpy(encodings.data(), cursor, header.NumAttributes * sizeof(AttribEncoding));
+	cursor += header.NumAttributes * sizeof(AttribEncoding);
+	memcpy(&extra, cursor, sizeof(BinaryHeaderV2));
+	cursor += sizeof(BinaryHeaderV2);
+
+	if (!ValidateVertexDeclaration(vertexDeclaration, header.VertexStride, filename)) {
+		return nullptr;
+	}
+
+	// Work out where each stream of data is, the indices come first followed by one stream per attribute
+	std::vector<size_t> streamOffsets;
+	streamOffsets.resize(header.NumAttributes);
+	size_t dataSize = AlignUp(header.NumIndices * indexSize, 4);
+	for (int ix = 0; ix < header.NumAttributes; ix++) {
+		size_t encodedSize = _GetEncodedSize(encodings[ix], vertexDeclaration[ix]);
+		if (encodedSize == 0) {
+			LOG_ERROR("Invalid encoding for the attribute in slot {} of \"{}\"", vertexDeclaration[ix].Slot, filename);
+			return nullptr;
+		}
+		streamOffsets[ix] = dataSize;
+		dataSize += AlignUp(encodedSize * header.NumVertices, 4);
+	}
+	if (extra.DataSize != dataSize) {
+		LOG_ERROR("Data size in \"{}\" does not match its layout!", filename);
+		return nullptr;
+	}
+
+	// Compressed data has a table with the size of each block, then the data starts on a 16 byte boundary
+	size_t numBlocks = (dataSize + COMPRESSION_BLOCK_SIZE - 1) / COMPRESSION_BLOCK_SIZE;
+	if (extra.NumBlocks != 0 && extra.NumBlocks != numBlocks) {
+		LOG_ERROR("Unexpected number of compressed blocks in \"{}\"", filename);
+		return nullptr;
+	}
+	if (size < headerBytes + extra.NumBlocks * sizeof(uint32_t)) {
+		LOG_ERROR("Not enough data in the file!");
+		return nullptr;
+	}
+	std::vector<uint32_t> blockSizes;
+	blockSizes.resize(extra.NumBlocks);
+	memcpy(blockSizes.data(), cursor, extra.NumBlocks * sizeof(uint32_t));
+	size_t dataOffset = AlignUp(headerBytes + extra.NumBlocks * sizeof(uint32_t), 16);
+
+	// Uncompressed data can be decoded straight out of the file, otherwise we need somewhere to put it
+	const uint8_t* decoded = nullptr;
+	std::vector<uint8_t> decompressed;
+	if (extra.NumBlocks == 0) {
+		if (size < dataOffset + dataSize) {
+			LOG_ERROR("Not enough data in the file!");
+			return nullptr;
+		}
+		decoded = data + dataOffset;
+	} else {
+		std::vector<size_t> blockOffsets;
+		blockOffsets.resize(extra.NumBlocks);
+		size_t storedSize = 0;
+		for (size_t ix = 0; ix < extra.NumBlocks; ix++) {
+			blockOffsets[ix] = dataOffset + storedSize;
+			storedSize += blockSizes[ix];
+		}
+		if (size < dataOffset + storedSize) {
+			LOG_ERROR("Not enough data in the file!");
+			return nullptr;
+		}
+
+		// Every block decompresses on its own, so they can all go at once. Blocks that didn't get any
+		// smaller are stored as is
+		decompressed.resize(dataSize);
+		std::atomic<bool> failed(false);
+		JobSystem::ParallelFor(extra.NumBlocks, [&](size_t begin, size_t end) {
+			for (size_t ix = begin; ix < end; ix++) {
+				size_t rawSize = std::min(COMPRESSION_BLOCK_SIZE, dataSize - ix * COMPRESSION_BLOCK_SIZE);
+				uint8_t* target = decompressed.data() + ix * COMPRESSION_BLOCK_SIZE;
+				if (blockSizes[ix] == rawSize) {
+					memcpy(target, data + blockOffsets[ix], rawSize);
+				} else if (!LZ4::Decompress(data + blockOffsets[ix], blockSizes[ix], target, rawSize)) {
+					failed = true;
+				}
+			}
+		}, 1);
+		if (failed) {
+			LOG_ERROR("Failed to decompress \"{}\"", filename);
+			return nullptr;
+		}
+		decoded = decompressed.data();
+	}
+
+	// Indices are stored as is, so those go straight to the GPU
+	IndexBuffer::Sptr indices = nullptr;
+	if (header.NumIndices > 0) {
+		indices = IndexBuffer::Create(BufferUsage::StaticDraw);
+		indices->LoadImmutableData(decoded, (uint32_t)indexSize, header.NumIndices, header.IndicesType);
+	}
+
+	VertexArrayObject::Sptr result = VertexArrayObject::Create();
+	result->SetIndexBuffer(indices);
+
+	// Packed tangents carry the handedness of the tangent frame (see VertexParamMap::SetBiTangent), which we
+	// can only work out if the normals and bitangents are in the file as well
+	const uint32_t* normals = nullptr;
+	const uint32_t* bitangents = nullptr;
+	for (size_t attribIx = 0; attribIx < vertexDeclaration.size(); attribIx++) {
+		if (encodings[attribIx] != AttribEncoding::Octahedral16) {
+			continue;
+		}
+		const uint32_t* stream = reinterpret_cast<const uint32_t*>(decoded + streamOffsets[attribIx]);
+		if (vertexDeclaration[attribIx].Usage == AttribUsage::Normal) {
+			normals = stream;
+		} else if (vertexDeclaration[attribIx].Usage == AttribUsage::BiTangent) {
+			bitangents = stream;
+		}
+	}
+
+	// Every attribute gets a buffer of its own, in a format that the GPU can read. Raw streams, UVs and colors
+	// already are one, so they are uploaded straight from the file (or the decompressed data). Positions are
+	// decoded to floats so that they can still be read back for physics, and octahedral vectors are re-packed
+	// into 10 bit values since shaders can't unpack them. Only one attribute is decoded at a time, so we never
+	// hold more than a float3 per vertex on top of the file
+	glm::vec3 boundsMin = extra.BoundsMin;
+	glm::vec3 boundsScale = (extra.BoundsMax - extra.BoundsMin) / 65535.0f;
+	std::vector<BufferAttribute> layout;
+	layout.reserve(vertexDeclaration.size());
+	std::vector<uint8_t> scratch;
+	for (size_t attribIx = 0; attribIx < vertexDeclaration.size(); attribIx++) {
+		const BufferAttribute& attrib = vertexDeclaration[attribIx];
+		const uint8_t* stream = decoded + streamOffsets[attribIx];
+		const uint8_t* upload = stream;
+		BufferAttribute packed = attrib;
+		packed.Offset = 0;
+
+		switch (encodings[attribIx]) {
+			case AttribEncoding::Quantized16: {
+				packed.Stride = sizeof(glm::vec3);
+				scratch.resize(header.NumVertices * sizeof(glm::vec3));
+				const uint16_t* in = reinterpret_cast<const uint16_t*>(stream);
+				glm::vec3* out = reinterpret_cast<glm::vec3*>(scratch.data());
+				JobSystem::ParallelFor(header.NumVertices, [&](size_t begin, size_t end) {
+					for (size_t ix = begin; ix < end; ix++) {
+						out[ix] = boundsMin + glm::vec3(in[ix * 3], in[ix * 3 + 1], in[ix * 3 + 2]) * boundsScale;
+					}
+				}, DECODE_GRAIN_SIZE);
+				upload = scratch.data();
+			} break;
+			case AttribEncoding::Octahedral16: {
+				packed.Type = AttributeType::Int2_10_10_10;
+				packed.Size = 4;
+				packed.Normalized = true;
+				packed.Stride = sizeof(uint32_t);
+				scratch.resize(header.NumVertices * sizeof(uint32_t));
+				const uint32_t* in = reinterpret_cast<const uint32_t*>(stream);
+				uint32_t* out = reinterpret_cast<uint32_t*>(scratch.data());
+				bool hasHandedness = attrib.Usage == AttribUsage::Tangent && normals != nullptr && bitangents != nullptr;
+				JobSystem::ParallelFor(header.NumVertices, [&](size_t begin, size_t end) {
+					for (size_t ix = begin; ix < end; ix++) {
+						glm::vec3 value = OctahedralDecode(glm::unpackSnorm2x16(in[ix]));
+						float w = 0.0f;
+						if (hasHandedness) {
+							glm::vec3 normal = OctahedralDecode(glm::unpackSnorm2x16(normals[ix]));
+							glm::vec3 bitangent = OctahedralDecode(glm::unpackSnorm2x16(bitangents[ix]));
+							w = glm::dot(glm::cross(normal, value), bitangent) < 0.0f ? -1.0f : 1.0f;
+						}
+						out[ix] = glm::packSnorm3x10_1x2(glm::vec4(value, w));
+					}
+				}, DECODE_GRAIN_SIZE);
+				upload = scratch.data();
+			} break;
+			case AttribEncoding::Half2:
+				packed.Type = AttributeType::HalfFloat;
+				packed.Stride = sizeof(uint32_t);
+				break;
+			case AttribEncoding::UNorm8x4:
+				packed.Type = AttributeType::UByte;
+				packed.Normalized = true;
+				packed.Stride = sizeof(uint32_t);
+				break;
+			case AttribEncoding::Raw:
+			default:
+				packed.Stride = (GLsizei)GetAttributeSize(attrib.Type, attrib.Size);
+				break;
+		}
+
+		VertexBuffer::Sptr vertices = VertexBuffer::Create(BufferUsage::StaticDraw);
+		vertices->LoadImmutableData(upload, packed.Stride, header.NumVertices);
+		result->AddVertexBuffer(vertices, { packed });
+		layout.push_back(packed);
+	}
+	result->SetVDecl(layout);
+
+	return result;
+}
+
+void OptimizedObjLoader::_SaveBinaryFile(const uint8_t* vertices, const std::vector<BufferAttribute>& vertexDeclaration, const BinaryHeader& header, const uint32_t* indices, const std::string& outFilename, bool compress) {
+	// Open the output file
+	std::ofstream file(outFilename, std::ios::binary);
+	if (!file) {
+		throw std::runtime_error("Failed to open output file");
+	}
+
+	std::vector<AttribEncoding> encodings;
+	encodings.reserve(vertexDeclaration.size());
+	for (const BufferAttribute& attrib : vertexDeclaration) {
+		encodings.push_back(_ChooseEncoding(attrib));
+	}
+
+	// Positions are quantized within the bounds of the mesh
+	BinaryHeaderV2 extra = BinaryHeaderV2();
+	extra.BoundsMin = glm::vec3(0.0f);
+	extra.BoundsMax = glm::vec3(0.0f);
+	for (size_t attribIx = 0; attribIx < vertexDeclaration.size(); attribIx++) {
+		if (encodings[attribIx] != AttribEncoding::Quantized16) {
+			continue;
+		}
+		for (size_t ix = 0; ix < header.NumVertices; ix++) {
+			glm::vec3 position;
+			memcpy(&position, vertices + ix * header.VertexStride + vertexDeclaration[attribIx].Offset, sizeof(glm::vec3));
+			extra.BoundsMin = ix == 0 ? position : glm::min(extra.BoundsMin, position);
+			extra.BoundsMax = ix == 0 ? position : glm::max(extra.BoundsMax, position);
+		}
+		break;
+	}
+
+	// Encode the indices, followed by a stream for each attribute
+	std::vector<uint8_t> encoded;
+	if (header.IndicesType == IndexType::UShort) {
+		for (size_t ix = 0; ix < header.NumIndices; ix++) {
+			uint16_t index = static_cast<uint16_t>(indices[ix]);
+			encoded.insert(encoded.end(), reinterpret_cast<const uint8_t*>(&index), reinterpret_cast<const uint8_t*>(&index) + sizeof(uint16_t));
+		}
+	} else {
+		encoded.insert(encoded.end(), reinterpret_cast<const uint8_t*>(indices), reinterpret_cast<const uint8_t*>(indices + header.NumIndices));
+	}
+	encoded.resize(AlignUp(encoded.size(), 4));
+
+	glm::vec3 extent = extra.BoundsMax - extra.BoundsMin;
+	glm::vec3 quantizeScale = glm::vec3(
+		extent.x > 0.0f ? 65535.0f / extent.x : 0.0f,
+		extent.y > 0.0f ? 65535.0f / extent.y : 0.0f,
+		extent.z > 0.0f ? 65535.0f / extent.z : 0.0f
+	);
+	for (size_t attribIx = 0; attribIx < vertexDeclaration.size(); attribIx++) {
+		const BufferAttribute& attrib = vertexDeclaration[attribIx];
+		size_t attribSize = GetAttributeSize(attrib.Type, attrib.Size);
+
+		for (size_t ix = 0; ix < header.NumVertices; ix++) {
+			const uint8_t* in = vertices + ix * header.VertexStride + attrib.Offset;
+			switch (encodings[attribIx]) {
+				case AttribEncoding::Quantized16: {
+					glm::vec3 value;
+					memcpy(&value, in, sizeof(glm::vec3));
+					glm::vec3 quantized = glm::round(glm::clamp((value - extra.BoundsMin) * quantizeScale, 0.0f, 65535.0f));
+					uint16_t packed[3] = { (uint16_t)quantized.x, (uint16_t)quantized.y, (uint16_t)quantized.z };
+					encoded.insert(encoded.end(), reinterpret_cast<const uint8_t*>(packed), reinterpret_cast<const uint8_t*>(packed) + sizeof(packed));
+				} break;
+				case AttribEncoding::Octahedral16: {
+					glm::vec3 value;
+					memcpy(&value, in, sizeof(glm::vec3));
+					uint32_t packed = glm::packSnorm2x16(OctahedralEncode(value));
+					encoded.insert(encoded.end(), reinterpret_cast<const uint8_t*>(&packed), reinterpret_cast<const uint8_t*>(&packed) + sizeof(uint32_t));
+				} break;
+				case AttribEncoding::Half2: {
+					glm::vec2 value;
+					memcpy(&value, in, sizeof(glm::vec2));
+					uint32_t packed = glm::packHalf2x16(value);
+					encoded.insert(encoded.end(), reinterpret_cast<const uint8_t*>(&packed), reinterpret_cast<const uint8_t*>(&packed) + sizeof(uint32_t));
+				} break;
+				case AttribEncoding::UNorm8x4: {
+					glm::vec4 value;
+					memcpy(&value, in, sizeof(glm::vec4));
+					uint32_t packed = glm::packUnorm4x8(value);
+					encoded.insert(encoded.end(), reinterpret_cast<const uint8_t*>(&packed), reinterpret_cast<const uint8_t*>(&packed) + sizeof(uint32_t));
+				} break;
+				case AttribEncoding::Raw:
+				default:
+					encoded.insert(encoded.end(), in, in + attribSize);
+					break;
+			}
+		}
+		encoded.resize(AlignUp(encoded.size(), 4));
+	}
+	extra.DataSize = encoded.size();
+
+	// Compress each block on its own, same as the pak archives we only keep it if it's worth it
+	std::vector<std::vector<uint8_t>> blocks;
+	std::vector<uint32_t> blockSizes;
+	if (compress && !encoded.empty()) {
+		size_t numBlocks = (encoded.size() + COMPRESSION_BLOCK_SIZE - 1) / COMPRESSION_BLOCK_SIZE;
+		blocks.resize(numBlocks);
+		JobSystem::ParallelFor(numBlocks, [&](size_t begin, size_t end) {
+			for (size_t ix = begin; ix < end; ix++) {
+				size_t offset = ix * COMPRESSION_BLOCK_SIZE;
+				size_t rawSize = std::min(COMPRESSION_BLOCK_SIZE, encoded.size() - offset);
+				blocks[ix] = LZ4::Compress(encoded.data() + offset, rawSize);
+				if (blocks[ix].empty() || blocks[ix].size() >= rawSize) {
+					blocks[ix].assign(encoded.begin() + offset, encoded.begin() + offset + rawSize);
+				}
+			}
+		}, 1);
+
+		size_t storedSize = 0;
+		for (const auto& block : blocks) {
+			storedSize += block.size();
+			blockSizes.push_back(static_cast<uint32_t>(block.size()));
+		}
+		if (storedSize > encoded.size() - encoded.size() / 10) {
+			blocks.clear();
+			blockSizes.clear();
+		}
+	}
+	extra.NumBlocks = static_cast<uint32_t>(blocks.size());
+
+	// Write the headers, followed by the data on a 16 byte boundary
+	file.write(reinterpret_cast<const char*>(&header), sizeof(BinaryHeader));
+	file.write(reinterpret_cast<const char*>(vertexDeclaration.data()), vertexDeclaration.size() * sizeof(BufferAttribute));
+	file.write(reinterpret_cast<const char*>(encodings.data()), encodings.size() * sizeof(AttribEncoding));
+	file.write(reinterpret_cast<const char*>(&extra), sizeof(BinaryHeaderV2));
+	file.write(reinterpret_cast<const char*>(blockSizes.data()), blockSizes.size() * sizeof(uint32_t));
+
+	size_t headerBytes = sizeof(BinaryHeader) + vertexDeclaration.size() * (sizeof(BufferAttribute) + sizeof(AttribEncoding)) + sizeof(BinaryHeaderV2) + blockSizes.size() * sizeof(uint32_t);
+	const char padding[16] = { 0 };
+	file.write(padding, AlignUp(headerBytes, 16) - headerBytes);
+
+	if (blocks.empty()) {
+		file.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+	} else {
+		for (const auto& block : blocks) {
+			file.write(reinterpret_cast<const char*>(block.data()), block.size());
+		}
+	}
+}
@@ -35,12 +35,20 @@ public:
 
 	/// <summary>
 	/// Saves a mesh builder of the given type to a binary file
+	///
+	/// Files are written in version 2 of the format. Positions are quantized to 16 bits within the mesh's
+	/// bounds, normals and tangents are octahedral encoded, UVs are stored as half floats and colors
+	/// as 8 bit values. Indices are stored as 16 bit values when there are few enough vertices. When it's
+	/// loaded, each attribute gets its own vertex buffer in a packed format (full precision positions, 10
+	/// bit normals and tangents, half float UVs and 8 bit colors), so the VAO's declaration won't match
+	/// VertexType::V_DECL
 	/// </summary>
-	/// <typeparam name="VertexType"></typeparam>
-	/// <param name="mesh"></param>
-	/// <param name="outFilename"></param>
+	/// <typeparam name="VertexType">The type of vertex stored in the mesh</typeparam>
+	/// <param name="mesh">The mesh to save</param>
+	/// <param name="outFilename">The path of the file to write</param>
+	/// <param name="compress">True to LZ4 compress the data in blocks, if it gets at least 10% smaller</param>
 	template <typename VertexType>
-	static void SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename);
+	static void SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename, bool compress = true);
 
 protected:
 	// Will be put at the start of the binary file, contains info about the contents of the file
@@ -61,42 +69,67 @@ protected:
 		uint8_t   NumAttributes = 0;
 	};
 
+	/// <summary>
+	/// How a vertex attribute's data is stored in a version 2 file
+	/// </summary>
+	enum class AttribEncoding : uint8_t {
+		// Copied as is
+		Raw          = 0,
+		// 3 floats, quantized to 16 bit unsigned values within the mesh's bounds
+		Quantized16  = 1,
+		// A unit vector, octahedral encoded into 2 16 bit signed normalized values
+		Octahedral16 = 2,
+		// 2 floats, stored as half floats
+		Half2        = 3,
+		// 4 floats in the [0, 1] range, stored as 8 bit unsigned normalized values
+		UNorm8x4     = 4
+	};
+
+	#pragma pack(push, 1)
+	// Comes after the attributes and their encodings in a version 2 file
+	struct BinaryHeaderV2 {
+		// The bounds that positions are quantized within
+		glm::vec3 BoundsMin;
+		glm::vec3 BoundsMax;
+		// The number of compressed blocks the data is split into, or 0 if it's stored uncompressed
+		uint32_t  NumBlocks;
+		uint32_t  Reserved;
+		// The size of all of the encoded index and vertex data, before compression
+		uint64_t  DataSize;
+	};
+	#pragma pack(pop)
+
 	OptimizedObjLoader() = default;
 	~OptimizedObjLoader() = default;
 
 	static MeshBuilder<VertexPosNormTexColTangents>* _LoadFromObjFile(const std::string& filename);
 	static VertexArrayObject::Sptr _LoadFromBinFile(const std::string& filename);
+	/// <summary>
+	/// Picks the most compact encoding for an attribute, based on what it's used for
+	/// </summary>
+	static AttribEncoding _ChooseEncoding(const BufferAttribute& attrib);
+	/// <summary>
+	/// Gets the number of bytes a single value of an attribute takes up with the given encoding, or 0
+	/// if the encoding can't be used for the attribute
+	/// </summary>
+	static size_t _GetEncodedSize(AttribEncoding encoding, const BufferAttribute& attrib);
+
+	static VertexArrayObject::Sptr _LoadBinaryV2(const uint8_t* data, size_t size, const BinaryHeader& header, const std::string& filename);
+
+	static void _SaveBinaryFile(const uint8_t* vertices, const std::vector<BufferAttribute>& vertexDeclaration, const BinaryHeader& header, const uint32_t* indices, const std::string& outFilename, bool compress);
 };
 
 template <typename VertexType>
-void OptimizedObjLoader::SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename) {
-	// Open the output file
-	std::ofstream file(outFilename, std::ios::binary);
-	if (!file) {
-		throw std::runtime_error("Failed to open output file");
-	}
-
+void OptimizedObjLoader::SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename, bool compress) {
 	// Create the fixed size header for our output file
 	BinaryHeader header  = BinaryHeader();
-	header.Version       = 0x01; // This is version 1! Update this and implement different readers if changes to format are made
+	header.Version       = 0x02; // This is version 2! Update this and implement different readers if changes to format are made
 	header.NumIndices    = mesh.GetIndexCount();
-	header.IndicesType   = IndexType::UInt;
+	header.IndicesType   = mesh.GetVertexCount() <= 0x10000 ? IndexType::UShort : IndexType::UInt;
 	header.NumVertices   = mesh.GetVertexCount();
 	header.VertexStride  = sizeof(VertexType);
 	header.NumAttributes = VertexType::V_DECL.size();
 
-	// Write header bytes to the stream
-	file.write(reinterpret_cast<const char*>(&header), sizeof(BinaryHeader));
-
-	// Write which attributes we have to the stream
-	for (int ix = 0; ix < VertexType::V_DECL.size(); ix++) {
-		file.write(reinterpret_cast<const char*>(&VertexType::V_DECL[ix]), sizeof(BufferAttribute));
-	}
-	// Write any index data to the file
-	if (mesh.GetIndexCount() > 0) {
-		file.write(reinterpret_cast<const char*>(mesh.GetIndexDataPtr()), mesh.GetIndexCount() * sizeof(uint32_t));
-	}
-
-	// Write vertex data to file
-	file.write(reinterpret_cast<const char*>(mesh.GetVertexDataPtr()), mesh.GetVertexCount() * sizeof(VertexType));
+	// The encoding is the same for any vertex type, so it lives in the cpp
+	_SaveBinaryFile(reinterpret_cast<const uint8_t*>(mesh.GetVertexDataPtr()), VertexType::V_DECL, header, mesh.GetIndexDataPtr(), outFilename, compress);
 }
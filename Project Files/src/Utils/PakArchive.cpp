@@ -0,0 +1,301 @@
+#include "Utils/PakArchive.h"
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <mutex>
+#include <Logging.h>
+
+#include "Utils/FileHelpers.h"
+#include "Utils/LZ4.h"
+#include "Utils/StringUtils.h"
+
+// Magic number at the start of every archive, followed by the version
+static const char PAK_MAGIC[4] = { 'P', 'A', 'K', '1' };
+// Version 2 aligned the entry data, version 1 archives have to be rebuilt
+static const uint32_t PAK_VERSION = 2;
+// Entry data is aligned so that mapped entries can be read directly as larger types
+static const uint64_t PAK_DATA_ALIGNMENT = 16;
+
+std::vector<PakArchive::Sptr> PakArchive::_mounted;
+std::shared_mutex             PakArchive::_mountLock;
+std::atomic<bool>             PakArchive::_looseFileOverrides(false);
+
+PakArchive::PakArchive() :
+	_path(""),
+	_file(nullptr),
+	_entries(std::vector<Entry>()),
+	_numEntries(0),
+	_writeTime(std::filesystem::file_time_type::min()),
+	_lookup(std::unordered_map<std::string, size_t>())
+{ }
+
+PakArchive::Sptr PakArchive::Open(const std::string& path) {
+	MemoryMappedFile::Sptr file = MemoryMappedFile::Open(path);
+	if (file == nullptr) {
+		return nullptr;
+	}
+
+	const uint8_t* data = file->Data();
+	const size_t size = file->Size();
+	if (size < sizeof(Header)) {
+		LOG_ERROR("'{}' is not a pak archive", path);
+		return nullptr;
+	}
+
+	Header header;
+	memcpy(&header, data, sizeof(Header));
+	if (memcmp(header.Magic, PAK_MAGIC, sizeof(PAK_MAGIC)) != 0) {
+		LOG_ERROR("'{}' is not a pak archive", path);
+		return nullptr;
+	}
+	if (header.Version != PAK_VERSION) {
+		LOG_ERROR("Pak archive '{}' has unsupported version {}", path, header.Version);
+		return nullptr;
+	}
+	if (header.TableOffset > size || (size - header.TableOffset) / sizeof(Entry) < header.NumEntries || header.StringsOffset > size) {
+		LOG_ERROR("Pak archive '{}' is truncated or corrupt", path);
+		return nullptr;
+	}
+
+	PakArchive::Sptr result(new PakArchive());
+	result->_path       = path;
+	result->_file       = file;
+	result->_numEntries = header.NumEntries;
+	result->_entries.resize(header.NumEntries);
+	memcpy(result->_entries.data(), data + header.TableOffset, header.NumEntries * sizeof(Entry));
+	result->_lookup.reserve(header.NumEntries);
+
+	std::error_code timeError;
+	result->_writeTime = std::filesystem::last_write_time(path, timeError);
+	if (timeError) {
+		// If we can't tell how old the archive is, loose files always win
+		result->_writeTime = std::filesystem::file_time_type::min();
+	}
+
+	const size_t stringsSize = size - header.StringsOffset;
+	for (size_t ix = 0; ix < result->_numEntries; ix++) {
+		const Entry& entry = result->_entries[ix];
+		bool valid =
+			entry.DataOffset <= size && entry.StoredSize <= size - entry.DataOffset &&
+			entry.PathOffset <= stringsSize && entry.PathLength <= stringsSize - entry.PathOffset &&
+			(entry.Method == Compression::None ? entry.StoredSize == entry.Size : entry.Method == Compression::LZ4);
+		if (!valid) {
+			LOG_ERROR("Pak archive '{}' has a corrupt entry at index {}", path, ix);
+			return nullptr;
+		}
+
+		const char* entryPath = reinterpret_cast<const char*>(data + header.StringsOffset + entry.PathOffset);
+		result->_lookup[std::string(entryPath, entry.PathLength)] = ix;
+	}
+
+	return result;
+}
+
+bool PakArchive::Build(const std::string& directory, const std::string& outputPath, bool compress) {
+	namespace fs = std::filesystem;
+
+	// Things that get built alongside the assets, but are never loaded through FileHelpers
+	static const std::vector<std::string> skippedExtensions = {
+		".exe", ".dll", ".pdb", ".ilk", ".lib", ".exp", ".pak", ".tmp"
+	};
+
+	std::error_code error;
+	const fs::path root = fs::path(directory);
+	const fs::path output = fs::absolute(outputPath, error);
+
+	// Collect the files up front so that the archive is laid out in a stable order
+	std::vector<std::pair<std::string, fs::path>> files;
+	for (const auto& item : fs::recursive_directory_iterator(root, error)) {
+		if (!item.is_regular_file()) {
+			continue;
+		}
+		std::string extension = item.path().extension().string();
+		StringTools::ToLower(extension);
+		if (std::find(skippedExtensions.begin(), skippedExtensions.end(), extension) != skippedExtensions.end()) {
+			continue;
+		}
+		std::error_code sameError;
+		if (fs::equivalent(item.path(), output, sameError)) {
+			continue;
+		}
+		files.push_back({ FileHelpers::NormalizePath(fs::relative(item.path(), root).generic_string()), item.path() });
+	}
+	if (error) {
+		LOG_ERROR("Could not list files in '{}': {}", directory, error.message());
+		return false;
+	}
+	std::sort(files.begin(), files.end());
+
+	// Write to a temporary file first, so that a failed build doesn't clobber an existing archive
+	const std::string tempPath = outputPath + ".tmp";
+	std::ofstream out(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!out) {
+		LOG_ERROR("Could not open file '{}' for writing", tempPath);
+		return false;
+	}
+
+	Header header;
+	memset(&header, 0, sizeof(Header));
+	out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+
+	std::vector<Entry> entries;
+	std::string strings;
+	entries.reserve(files.size());
+	uint64_t offset = sizeof(Header);
+	uint64_t totalSize = 0;
+
+	for (const auto& [name, path] : files) {
+		// Read the loose file directly, FileHelpers would find it in any archive that's already mounted
+		MemoryMappedFile::Sptr file = MemoryMappedFile::Open(path.string());
+		if (file == nullptr) {
+			continue;
+		}
+
+		Entry entry;
+		memset(&entry, 0, sizeof(Entry));
+		entry.Size       = file->Size();
+		entry.PathOffset = static_cast<uint32_t>(strings.size());
+		entry.PathLength = static_cast<uint32_t>(name.size());
+		entry.Method     = Compression::None;
+		strings += name;
+
+		const uint8_t* data = file->Data();
+		std::vector<uint8_t> compressed;
+		if (compress && file->Size() > 0) {
+			compressed = LZ4::Compress(file->Data(), file->Size());
+			// Not worth paying for decompression if it barely gets smaller
+			if (!compressed.empty() && compressed.size() <= file->Size() - file->Size() / 10) {
+				entry.Method = Compression::LZ4;
+				data = compressed.data();
+			}
+		}
+		entry.StoredSize = entry.Method == Compression::LZ4 ? compressed.size() : file->Size();
+
+		uint64_t padding = (PAK_DATA_ALIGNMENT - offset % PAK_DATA_ALIGNMENT) % PAK_DATA_ALIGNMENT;
+		static const char zeroes[PAK_DATA_ALIGNMENT] = { 0 };
+		out.write(zeroes, padding);
+		offset += padding;
+
+		entry.DataOffset = offset;
+		if (entry.StoredSize > 0) {
+			out.write(reinterpret_cast<const char*>(data), entry.StoredSize);
+		}
+		offset += entry.StoredSize;
+		totalSize += entry.Size;
+
+		entries.push_back(entry);
+	}
+
+	header.TableOffset = offset;
+	out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Entry));
+	offset += entries.size() * sizeof(Entry);
+
+	header.StringsOffset = offset;
+	out.write(strings.data(), strings.size());
+
+	memcpy(header.Magic, PAK_MAGIC, sizeof(PAK_MAGIC));
+	header.Version    = PAK_VERSION;
+	header.NumEntries = static_cast<uint32_t>(entries.size());
+	out.seekp(0, std::ios::beg);
+	out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+
+	out.close();
+	if (!out) {
+		LOG_ERROR("Failed to write pak archive '{}'", tempPath);
+		return false;
+	}
+
+	fs::rename(tempPath, outputPath, error);
+	if (error) {
+		LOG_ERROR("Could not replace '{}': {}", outputPath, error.message());
+		return false;
+	}
+
+	LOG_INFO("Packed {} files from \"{}\" into \"{}\" ({:.1f} MB -> {:.1f} MB)", entries.size(), directory, outputPath,
+		totalSize / (1024.0 * 1024.0), (offset + strings.size()) / (1024.0 * 1024.0));
+	return true;
+}
+
+FileData::Sptr PakArchive::OpenFile(const std::string& path) const {
+	auto it = _lookup.find(FileHelpers::NormalizePath(path));
+	if (it == _lookup.end()) {
+		return nullptr;
+	}
+
+	const Entry& entry = _entries[it->second];
+	const uint8_t* data = _file->Data() + entry.DataOffset;
+
+	if (entry.Method == Compression::LZ4) {
+		std::vector<uint8_t> buffer(entry.Size);
+		if (!LZ4::Decompress(data, entry.StoredSize, buffer.data(), buffer.size())) {
+			LOG_ERROR("Failed to decompress '{}' from pak archive '{}'", path, _path);
+			return nullptr;
+		}
+		return std::make_shared<FileData>(std::move(buffer));
+	}
+
+	// The view keeps the mapping alive, even if the archive gets unmounted
+	return std::make_shared<FileData>(_file, entry.Size > 0 ? data : nullptr, entry.Size);
+}
+
+bool PakArchive::Contains(const std::string& path) const {
+	return _lookup.find(FileHelpers::NormalizePath(path)) != _lookup.end();
+}
+
+bool PakArchive::_IsShadowedByLooseFile(const std::string& path) const {
+	std::error_code error;
+	std::filesystem::file_time_type looseTime = std::filesystem::last_write_time(path, error);
+	return !error && looseTime > _writeTime;
+}
+
+bool PakArchive::Mount(const std::string& path) {
+	PakArchive::Sptr archive = Open(path);
+	if (archive == nullptr) {
+		return false;
+	}
+
+	std::unique_lock<std::shared_mutex> lock(_mountLock);
+	_mounted.push_back(archive);
+	LOG_INFO("Mounted pak archive \"{}\" with {} files", path, archive->NumEntries());
+	return true;
+}
+
+void PakArchive::UnmountAll() {
+	std::unique_lock<std::shared_mutex> lock(_mountLock);
+	_mounted.clear();
+}
+
+FileData::Sptr PakArchive::OpenMountedFile(const std::string& path) {
+	std::shared_lock<std::shared_mutex> lock(_mountLock);
+	for (const auto& archive : _mounted) {
+		// Only decompression failures come back as null for an entry that exists, so stop there too
+		if (archive->Contains(path)) {
+			// The editor writes scenes, manifests and caches as loose files, the copy in the archive is stale
+			if (_looseFileOverrides && archive->_IsShadowedByLooseFile(path)) {
+				return nullptr;
+			}
+			return archive->OpenFile(path);
+		}
+	}
+	return nullptr;
+}
+
+void PakArchive::SetLooseFileOverrides(bool enabled) {
+	_looseFileOverrides = enabled;
+}
+
+bool PakArchive::MountedContains(const std::string& path) {
+	std::shared_lock<std::shared_mutex> lock(_mountLock);
+	for (const auto& archive : _mounted) {
+		if (archive->Contains(path)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+size_t PakArchive::NumMounted() {
+	std::shared_lock<std::shared_mutex> lock(_mountLock);
+	return _mounted.size();
+}
@@ -0,0 +1,159 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <shared_mutex>
+#include <atomic>
+#include <filesystem>
+#include <cstdint>
+
+#include "Utils/FileData.h"
+#include "Utils/MemoryMappedFile.h"
+
+/// <summary>
+/// A read-only archive that packs many asset files into a single file, so that a shipped build can
+/// open one file instead of hundreds of small ones
+///
+/// The archive is memory mapped when it's opened, and the entry table is indexed by normalized path
+/// (see FileHelpers::NormalizePath), so finding a file is a single hash lookup. Uncompressed entries are handed out as views straight
+/// into the mapping without copying them. Entries can optionally be stored LZ4 compressed, in which
+/// case they are decompressed into their own buffer when they are opened
+///
+/// Archives are mounted globally with Mount, after which FileHelpers::OpenFile, ReadFile and Exists
+/// will look in them before falling back to loose files on disk. With SetLooseFileOverrides turned on
+/// (the editor does this), a loose file that was written after the archive was built (ex: a scene saved
+/// from the editor) wins over the stale copy in the archive
+/// </summary>
+class PakArchive {
+public:
+	typedef std::shared_ptr<PakArchive> Sptr;
+
+	/// <summary>
+	/// How an entry's data is stored in the archive
+	/// </summary>
+	enum class Compression : uint32_t {
+		None = 0,
+		// Standard LZ4 block format, without the frame header
+		LZ4  = 1
+	};
+
+	~PakArchive() = default;
+
+	PakArchive(const PakArchive& other) = delete;
+	PakArchive& operator=(const PakArchive& other) = delete;
+
+	/// <summary>
+	/// Opens and indexes an archive
+	/// </summary>
+	/// <param name="path">The path of the archive to open</param>
+	/// <returns>The archive, or nullptr if it could not be opened or is not a valid archive</returns>
+	static PakArchive::Sptr Open(const std::string& path);
+
+	/// <summary>
+	/// Packs all the files in a directory (recursively) into a new archive. Executables, debug symbols
+	/// and other archives are skipped
+	/// </summary>
+	/// <param name="directory">The directory to pack, paths in the archive are relative to it</param>
+	/// <param name="outputPath">The path of the archive to write</param>
+	/// <param name="compress">True to compress entries that get at least 10% smaller</param>
+	/// <returns>True if the archive was written</returns>
+	static bool Build(const std::string& directory, const std::string& outputPath, bool compress = true);
+
+	/// <summary>
+	/// Opens the entry with the given path
+	/// </summary>
+	/// <param name="path">The path of the file, relative to the directory the archive was built from</param>
+	/// <returns>The file's contents, or nullptr if the archive has no such entry</returns>
+	FileData::Sptr OpenFile(const std::string& path) const;
+	/// <summary>
+	/// Checks whether the archive has an entry with the given path
+	/// </summary>
+	bool Contains(const std::string& path) const;
+
+	/// <summary>
+	/// Gets the path that the archive was opened from
+	/// </summary>
+	const std::string& GetPath() const { return _path; }
+	/// <summary>
+	/// Gets the number of files in the archive
+	/// </summary>
+	size_t NumEntries() const { return _numEntries; }
+
+	/// <summary>
+	/// Opens an archive and adds it to the set of archives that are searched by FileHelpers. Archives
+	/// are searched in the order that they were mounted
+	/// </summary>
+	/// <param name="path">The path of the archive to mount</param>
+	/// <returns>True if the archive was opened and mounted</returns>
+	static bool Mount(const std::string& path);
+	/// <summary>
+	/// Removes all mounted archives. Files that were opened from them stay valid
+	/// </summary>
+	static void UnmountAll();
+	/// <summary>
+	/// Looks for a file in all of the mounted archives
+	/// </summary>
+	/// <returns>The file's contents, or nullptr if no mounted archive has it, or the loose file is newer</returns>
+	static FileData::Sptr OpenMountedFile(const std::string& path);
+	/// <summary>
+	/// Sets whether loose files written after an archive was built win over the archive's copy. This costs
+	/// a stat for every file opened from an archive, so it's off by default and only meant for the editor
+	/// </summary>
+	static void SetLooseFileOverrides(bool enabled);
+	/// <summary>
+	/// Checks whether any of the mounted archives have the given file
+	/// </summary>
+	static bool MountedContains(const std::string& path);
+	/// <summary>
+	/// Gets the number of mounted archives
+	/// </summary>
+	static size_t NumMounted();
+
+protected:
+	PakArchive();
+
+	#pragma pack(push, 1)
+	struct Header {
+		char     Magic[4];
+		uint32_t Version;
+		uint32_t NumEntries;
+		uint32_t Reserved;
+		// Offset of the entry table from the start of the file
+		uint64_t TableOffset;
+		// Offset of the block holding all the entry paths
+		uint64_t StringsOffset;
+	};
+
+	struct Entry {
+		uint64_t    DataOffset;
+		// The number of bytes taken up in the archive, only differs from Size if compressed
+		uint64_t    StoredSize;
+		uint64_t    Size;
+		// The entry's normalized path, relative to the strings block. Not null terminated
+		uint32_t    PathOffset;
+		uint32_t    PathLength;
+		Compression Method;
+		uint32_t    Reserved;
+	};
+	#pragma pack(pop)
+
+	std::string            _path;
+	MemoryMappedFile::Sptr _file;
+	// Copied out of the mapping when the archive is opened, so we never read the table in place
+	std::vector<Entry>     _entries;
+	size_t                 _numEntries;
+	// When the archive was last written, loose files newer than this win over our entries
+	std::filesystem::file_time_type _writeTime;
+	// Maps normalized paths to indices in _entries
+	std::unordered_map<std::string, size_t> _lookup;
+
+	/// <summary>
+	/// Checks whether there is a loose file on disk at the given path that was written after this archive was built
+	/// </summary>
+	bool _IsShadowedByLooseFile(const std::string& path) const;
+
+	static std::vector<PakArchive::Sptr> _mounted;
+	static std::shared_mutex             _mountLock;
+	static std::atomic<bool>             _looseFileOverrides;
+};
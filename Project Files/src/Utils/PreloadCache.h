@@ -0,0 +1,55 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+/// <summary>
+/// A thread safe store for asset data that has been decoded ahead of time (ex: on a worker
+/// thread while a scene is loading), keyed by the path of the file it was decoded from.
+/// Entries are removed when they are taken, so decoded data is only ever used once
+/// </summary>
+/// <typeparam name="T">The type of decoded data to store</typeparam>
+template <typename T>
+class PreloadCache {
+public:
+	PreloadCache() = default;
+	~PreloadCache() = default;
+
+	PreloadCache(const PreloadCache& other) = delete;
+	PreloadCache& operator=(const PreloadCache& other) = delete;
+
+	/// <summary>
+	/// Stores decoded data for a file, replacing anything that was already stored for it
+	/// </summary>
+	void Store(const std::string& path, std::unique_ptr<T>&& data) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		_entries[path] = std::move(data);
+	}
+
+	/// <summary>
+	/// Removes and returns the decoded data for a file, or nullptr if none has been stored
+	/// </summary>
+	std::unique_ptr<T> Take(const std::string& path) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto it = _entries.find(path);
+		if (it == _entries.end()) {
+			return nullptr;
+		}
+		std::unique_ptr<T> result = std::move(it->second);
+		_entries.erase(it);
+		return result;
+	}
+
+	/// <summary>
+	/// Frees all of the decoded data that has not been taken yet
+	/// </summary>
+	void Clear() {
+		std::lock_guard<std::mutex> lock(_mutex);
+		_entries.clear();
+	}
+
+protected:
+	std::mutex _mutex;
+	std::unordered_map<std::string, std::unique_ptr<T>> _entries;
+};
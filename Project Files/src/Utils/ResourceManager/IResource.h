@@ -12,6 +12,21 @@
 /// Resources must additionally define a static method as such:
 /// static std::shared_ptr<Type> FromJson(const nlohmann::json&);
 /// where Type is the Type of resource
+///
+/// Resources that do expensive CPU work while loading (reading and decoding files) can also define:
+/// static void Preload(const nlohmann::json&);
+/// static void ClearPreloadedFiles();
+/// Preload is given the same blob as FromJson, and is run on a worker thread ahead of FromJson. It must
+/// not touch OpenGL or the resource manager, and should stash its results for FromJson to pick up
+///
+/// Resources that are loaded from a source (like a file) can define a key for each constructor that
+/// loads one, taking the same arguments as that constructor:
+/// static std::string GetSourceKey(const ConstructorArgs&...);
+/// ResourceManager::CreateAsset will hand back the existing resource for a key instead of loading the
+/// source again. The key should include any parameters that change how the source is loaded, and be
+/// empty if the resource should not be shared. Resources with state that can be changed after they are
+/// loaded (ex: a texture's filtering) should also include that state in the key, and override
+/// GetCurrentSourceKey so that a resource someone has changed stops being handed out for the old key
 /// </summary>
 class IResource {
 public:
@@ -33,6 +48,31 @@ public:
 
 	virtual void ResolveReferences() {};
 
+	/// <summary>
+	/// Gets an estimate of how much GPU memory this resource is using, in bytes
+	/// </summary>
+	virtual size_t GetGpuMemoryUsage() const { return 0; }
+	/// <summary>
+	/// Gets an estimate of how much CPU memory this resource is holding on to, in bytes
+	/// </summary>
+	virtual size_t GetCpuMemoryUsage() const { return 0; }
+	/// <summary>
+	/// Returns true if this resource can be recreated from the JSON returned by ToJson, which lets
+	/// the resource manager unload it while nothing else is using it
+	/// </summary>
+	virtual bool IsReloadable() const { return false; }
+
+	/// <summary>
+	/// Gets the source key that matches this resource's current state, or an empty string if the resource
+	/// can't be changed in a way that affects its key
+	/// </summary>
+	virtual std::string GetCurrentSourceKey() const { return std::string(); }
+	/// <summary>
+	/// Returns true if ResourceManager::CreateAsset has handed this resource out to more than one caller,
+	/// in which case it should not be changed
+	/// </summary>
+	bool IsShared() const { return _isShared; }
+
 	/// <summary>
 	/// Converts this resource into it's JSON manifest format
 	/// Should contain all the data required to reconstruct the
@@ -42,8 +82,11 @@ public:
 	virtual nlohmann::json ToJson() const = 0;
 
 protected:
+	friend class ResourceManager;
+
 	Guid _guid;
-	IResource() : _guid(Guid::New()){}
+	bool _isShared;
+	IResource() : _guid(Guid::New()), _isShared(false) {}
 };
 
 /// <summary>
@@ -55,4 +98,25 @@ protected:
 template <typename T>
 constexpr bool is_valid_resource() {
 	return std::is_base_of<IResource, T>::value && test_json<T, const nlohmann::json&>::value;
-}
\ No newline at end of file
+}
+
+/// <summary>
+/// Value is true if the given resource type defines static Preload and ClearPreloadedFiles methods
+/// </summary>
+/// <typeparam name="T">The type to check</typeparam>
+template <typename T, typename = void>
+struct has_preload : std::false_type {};
+template <typename T>
+struct has_preload<T, std::void_t<decltype(T::Preload(std::declval<const nlohmann::json&>())), decltype(T::ClearPreloadedFiles())>> : std::true_type {};
+
+template <typename Void, typename T, typename ... TArgs>
+struct has_source_key_impl : std::false_type {};
+template <typename T, typename ... TArgs>
+struct has_source_key_impl<std::void_t<decltype(T::GetSourceKey(std::declval<const TArgs&>()...))>, T, TArgs...> : std::true_type {};
+/// <summary>
+/// Value is true if the given resource type defines a static GetSourceKey method for the given constructor arguments
+/// </summary>
+/// <typeparam name="T">The type to check</typeparam>
+/// <typeparam name="TArgs">The constructor arguments</typeparam>
+template <typename T, typename ... TArgs>
+struct has_source_key : has_source_key_impl<void, T, TArgs...> {};
@@ -1,11 +1,29 @@
 #include "Utils/ResourceManager/ResourceManager.h"
 
+#include <algorithm>
+#include <GLFW/glfw3.h>
+#include <Logging.h>
+
 #include "Utils/ObjLoader.h"
 #include "Utils/FileHelpers.h"
 #include "Utils/StringUtils.h"
+#include "Utils/JobSystem.h"
 
-std::map<std::type_index, std::map<Guid, IResource::Sptr>> ResourceManager::_resources;
-std::map<std::string, std::function<Guid(const nlohmann::json&)>> ResourceManager::_typeLoaders;
+std::unordered_map<std::type_index, ResourceManager::TypeStore> ResourceManager::_resources;
+std::unordered_map<std::string, ResourceManager::TypeStore*> ResourceManager::_typeStores;
+std::unordered_map<Guid, ResourceManager::ResidentInfo> ResourceManager::_resident;
+uint64_t ResourceManager::_useCounter = 0;
+size_t ResourceManager::_residentBytes = 0;
+bool ResourceManager::_wasOverBudget = false;
+size_t ResourceManager::_memoryBudget = 0;
+size_t ResourceManager::_numEvicted = 0;
+size_t ResourceManager::_evictedBytes = 0;
+size_t ResourceManager::_numDeduplicated = 0;
+size_t ResourceManager::_deduplicatedBytes = 0;
+std::vector<PendingResourceLoad::Sptr> ResourceManager::_pendingLoads;
+std::unordered_map<Guid, PendingResourceLoad::Sptr> ResourceManager::_pendingByGuid;
+std::mutex ResourceManager::_decodeMutex;
+std::condition_variable ResourceManager::_decodeFinished;
 
 nlohmann::ordered_json ResourceManager::_manifest;
 
@@ -27,25 +45,310 @@ void ResourceManager::LoadManifest(const std::string& path, bool preloadAssets)
 	_manifest = blob;
 
 	if (preloadAssets) {
-		for (auto& [typeName, items] : blob.items()) {
-			auto& func = _typeLoaders[typeName];
-			if (func) {
-				for (auto& [guid, blob] : items.items()) {
-					func(blob);
-				}
+		_PreloadManifest();
+	}
+}
+
+/// <summary>
+/// Searches a manifest entry for strings that are the GUID of another entry in the manifest
+/// </summary>
+static void FindDependencies(const nlohmann::json& value, const std::unordered_map<std::string, size_t>& indices, std::vector<size_t>& result) {
+	if (value.is_string()) {
+		auto it = indices.find(value.get_ref<const std::string&>());
+		if (it != indices.end() && std::find(result.begin(), result.end(), it->second) == result.end()) {
+			result.push_back(it->second);
+		}
+	} else if (value.is_structured()) {
+		for (const auto& item : value) {
+			FindDependencies(item, indices, result);
+		}
+	}
+}
+
+void ResourceManager::_PreloadManifest() {
+	double startTime = glfwGetTime();
+
+	// Every entry in the manifest becomes a load, in manifest order so that we prefer the manifest's order when
+	// nothing else decides it. The loads are registered like any other pending load, so that a nested Get from
+	// a loader finishes the load we already started rather than decoding the resource a second time
+	std::vector<PendingResourceLoad::Sptr> loads;
+	std::vector<PendingResourceLoad::Sptr> newLoads;
+	std::unordered_map<std::string, size_t> indices;
+	for (auto& [typeName, items] : _manifest.items()) {
+		for (auto& [guid, item] : items.items()) {
+			Guid id = Guid(guid);
+			indices[guid] = loads.size();
+
+			// Something may have asked for it with GetAsync already
+			auto existing = _pendingByGuid.find(id);
+			if (existing != _pendingByGuid.end() && existing->second->TypeName == typeName) {
+				loads.push_back(existing->second);
+				continue;
+			}
+
+			PendingResourceLoad::Sptr load = std::make_shared<PendingResourceLoad>();
+			load->TypeName = typeName;
+			load->Blob = item;
+			load->Id = id;
+			if (existing == _pendingByGuid.end()) {
+				_pendingByGuid[id] = load;
 			}
+			loads.push_back(load);
+			newLoads.push_back(load);
+		}
+	}
+
+	// Anything an entry refers to by GUID (ex: a material's shader and textures) has to be created before it
+	std::vector<std::vector<size_t>> dependents(loads.size());
+	std::vector<size_t> numDependencies(loads.size(), 0);
+	for (size_t ix = 0; ix < loads.size(); ix++) {
+		std::vector<size_t> dependencies;
+		FindDependencies(loads[ix]->Blob, indices, dependencies);
+		for (size_t dependency : dependencies) {
+			if (dependency != ix) {
+				dependents[dependency].push_back(ix);
+				numDependencies[ix]++;
+			}
+		}
+	}
+
+	// Start decoding everything at once, the workers don't need to wait for dependencies since decoding
+	// doesn't touch other resources
+	for (const auto& load : newLoads) {
+		_SubmitDecode(load);
+	}
+
+	// Entries that have all of their dependencies created, in manifest order
+	std::vector<size_t> ready;
+	for (size_t ix = 0; ix < loads.size(); ix++) {
+		if (numDependencies[ix] == 0) {
+			ready.push_back(ix);
+		}
+	}
+
+	// Create resources as soon as they're decoded, and queue up the resources that depend on them once they can be created
+	size_t numCreated = 0;
+	while (!ready.empty()) {
+		// Prefer something a worker has finished (or a nested Get has already created). If nothing is, do the
+		// first one that no worker has started ourselves rather than sitting idle
+		auto next = std::find_if(ready.begin(), ready.end(), [&](size_t ix) {
+			PendingResourceLoad::LoadState state = loads[ix]->State;
+			return state == PendingResourceLoad::LoadState::Decoded || state == PendingResourceLoad::LoadState::Done;
+		});
+		if (next == ready.end()) {
+			next = std::find_if(ready.begin(), ready.end(), [&](size_t ix) {
+				return loads[ix]->State == PendingResourceLoad::LoadState::Queued;
+			});
+		}
+		if (next == ready.end()) {
+			// Everything we can do is being decoded, sleep until a worker finishes something
+			std::unique_lock<std::mutex> lock(_decodeMutex);
+			_decodeFinished.wait(lock, [&]() {
+				return std::any_of(ready.begin(), ready.end(), [&](size_t ix) {
+					return loads[ix]->State != PendingResourceLoad::LoadState::Decoding;
+				});
+			});
+			continue;
+		}
+
+		size_t ix = *next;
+		ready.erase(next);
+		_FinishLoad(loads[ix]);
+		numCreated++;
+
+		for (size_t dependent : dependents[ix]) {
+			if (--numDependencies[dependent] == 0) {
+				ready.push_back(dependent);
+			}
+		}
+	}
+
+	// Anything left over is part of a reference cycle, the loaders can sort those out with nested Gets
+	for (const auto& load : loads) {
+		if (load->State != PendingResourceLoad::LoadState::Done) {
+			_FinishLoad(load);
+			numCreated++;
+		}
+	}
+
+	ClearPreloadedResources();
+	LOG_INFO("Preloaded {} resources in {:.1f}ms", numCreated, (glfwGetTime() - startTime) * 1000.0);
+}
+
+ResourceManager::TypeStore& ResourceManager::_InitStore(const std::type_index& type) {
+	TypeStore& result = _resources[type];
+	if (result.TypeName.empty()) {
+		result.TypeName = StringTools::SanitizeClassName(type.name());
+	}
+	return result;
+}
+
+void ResourceManager::_Touch(const Guid& id, const IResource::Sptr& resource) {
+	ResidentInfo& info = _resident[id];
+	size_t size = resource->GetCpuMemoryUsage() + resource->GetGpuMemoryUsage();
+	_residentBytes = _residentBytes - info.Size + size;
+	info.Size = size;
+	info.LastUsed = ++_useCounter;
+}
+
+void ResourceManager::SetManifest(const nlohmann::ordered_json& manifest) {
+	_manifest = manifest;
+}
+
+bool ResourceManager::LoadResource(const std::string& typeName, const nlohmann::json& blob) {
+	auto store = _typeStores.find(typeName);
+	if (store == _typeStores.end() || !store->second->Loader) {
+		return false;
+	}
+
+	// Skip anything that's already been loaded (ex: as a dependency of another resource)
+	auto& resources = store->second->Resources;
+	auto existing = resources.find(Guid(blob["guid"]));
+	if (existing == resources.end() || existing->second == nullptr) {
+		store->second->Loader(blob);
+	}
+	return true;
+}
+
+bool ResourceManager::CanPreload(const std::string& typeName) {
+	auto store = _typeStores.find(typeName);
+	return store != _typeStores.end() && store->second->Preload;
+}
+
+void ResourceManager::PreloadResource(const std::string& typeName, const nlohmann::json& blob) {
+	auto store = _typeStores.find(typeName);
+	if (store != _typeStores.end() && store->second->Preload) {
+		store->second->Preload(blob);
+	}
+}
+
+void ResourceManager::ClearPreloadedResources() {
+	for (auto& [typeName, store] : _typeStores) {
+		if (store->ClearPreloaded) {
+			store->ClearPreloaded();
+		}
+	}
+}
+
+void ResourceManager::UpdateAsync(double budget) {
+	double start = glfwGetTime();
+
+	// Loads can finish out of order (ex: if something calls Get on a pending resource), so we skip
+	// over anything that's done and only stop at the budget
+	size_t ix = 0;
+	while (ix < _pendingLoads.size()) {
+		PendingResourceLoad::Sptr load = _pendingLoads[ix];
+		PendingResourceLoad::LoadState state = load->State;
+
+		if (state == PendingResourceLoad::LoadState::Decoded) {
+			_FinishLoad(load);
+			state = load->State;
+		}
+
+		if (state == PendingResourceLoad::LoadState::Done) {
+			_pendingLoads.erase(_pendingLoads.begin() + ix);
+		} else {
+			ix++;
+			continue;
+		}
+
+		if (glfwGetTime() - start >= budget) {
+			break;
 		}
 	}
 }
 
+size_t ResourceManager::NumPendingLoads() {
+	return _pendingByGuid.size();
+}
+
+PendingResourceLoad::Sptr ResourceManager::_QueueLoad(const std::string& typeName, Guid id) {
+	auto existing = _pendingByGuid.find(id);
+	if (existing != _pendingByGuid.end() && existing->second->TypeName == typeName) {
+		return existing->second;
+	}
+
+	PendingResourceLoad::Sptr result = std::make_shared<PendingResourceLoad>();
+	result->TypeName = typeName;
+	result->Id = id;
+
+	// Nothing to load, so the handle is ready right away with no resource. The same goes for a GUID that
+	// is already loading as a different type, since handles expect their result to be of their type
+	std::string guid = id.str();
+	if (existing != _pendingByGuid.end() || !_manifest.contains(typeName) || !_manifest[typeName].contains(guid)) {
+		result->State = PendingResourceLoad::LoadState::Done;
+		return result;
+	}
+	result->Blob = _manifest[typeName][guid];
+
+	_pendingLoads.push_back(result);
+	_pendingByGuid[id] = result;
+	_SubmitDecode(result);
+
+	return result;
+}
+
+void ResourceManager::_SubmitDecode(const PendingResourceLoad::Sptr& load) {
+	if (CanPreload(load->TypeName)) {
+		JobSystem::SubmitBackground([load]() {
+			// The main thread may have taken over the load if someone needed it right away
+			PendingResourceLoad::LoadState expected = PendingResourceLoad::LoadState::Queued;
+			if (load->State.compare_exchange_strong(expected, PendingResourceLoad::LoadState::Decoding)) {
+				PreloadResource(load->TypeName, load->Blob);
+				load->State = PendingResourceLoad::LoadState::Decoded;
+
+				// Taking the lock means anyone waiting has either seen the new state, or is asleep and will get the notify
+				{ std::lock_guard<std::mutex> lock(_decodeMutex); }
+				_decodeFinished.notify_all();
+			}
+		});
+	} else {
+		load->State = PendingResourceLoad::LoadState::Decoded;
+	}
+}
+
+void ResourceManager::_FinishLoad(const PendingResourceLoad::Sptr& load) {
+	if (load->State == PendingResourceLoad::LoadState::Done) {
+		return;
+	}
+
+	// If no worker has picked up the load yet we do it ourselves, otherwise wait for the worker to finish
+	PendingResourceLoad::LoadState expected = PendingResourceLoad::LoadState::Queued;
+	if (!load->State.compare_exchange_strong(expected, PendingResourceLoad::LoadState::Decoded)) {
+		_WaitForDecode(load);
+	}
+
+	LoadResource(load->TypeName, load->Blob);
+	auto store = _typeStores.find(load->TypeName);
+	if (store != _typeStores.end()) {
+		auto& resources = store->second->Resources;
+		auto it = resources.find(load->Id);
+		load->Result = it != resources.end() ? it->second : nullptr;
+	}
+	load->State = PendingResourceLoad::LoadState::Done;
+
+	// The load stays in _pendingLoads until UpdateAsync gets to it, since it may be iterating over the list.
+	// A load of another type with the same GUID may be the one that's registered, so only remove ourselves
+	auto registered = _pendingByGuid.find(load->Id);
+	if (registered != _pendingByGuid.end() && registered->second == load) {
+		_pendingByGuid.erase(registered);
+	}
+}
+
+void ResourceManager::_WaitForDecode(const PendingResourceLoad::Sptr& load) {
+	std::unique_lock<std::mutex> lock(_decodeMutex);
+	_decodeFinished.wait(lock, [&]() {
+		return load->State != PendingResourceLoad::LoadState::Decoding;
+	});
+}
+
 void ResourceManager::SaveManifest(const std::string& path) {
 	// Update all resources in the manifest so they match their current representation
-	for (auto& [type, map] : _resources) {
-		std::string typeName = StringTools::SanitizeClassName(type.name());
-		for (auto& [guid, res] : map) {
+	for (auto& [type, store] : _resources) {
+		for (auto& [guid, res] : store.Resources) {
 			if (res != nullptr) {
-				_manifest[typeName][guid.str()] = res->ToJson();
-				_manifest[typeName][guid.str()]["guid"] = res->GetGUID().str();
+				_manifest[store.TypeName][guid.str()] = res->ToJson();
+				_manifest[store.TypeName][guid.str()]["guid"] = res->GetGUID().str();
 			}
 		}
 	}
@@ -53,8 +356,120 @@ void ResourceManager::SaveManifest(const std::string& path) {
 }
 
 void ResourceManager::Cleanup() {
-	for (auto& [type, map] : _resources) {
-		map.clear();
+	// Cancel loads that no worker has started, and wait for the rest so nothing decodes into the preload caches after we clear them
+	for (const auto& load : _pendingLoads) {
+		PendingResourceLoad::LoadState expected = PendingResourceLoad::LoadState::Queued;
+		if (!load->State.compare_exchange_strong(expected, PendingResourceLoad::LoadState::Done)) {
+			_WaitForDecode(load);
+		}
+	}
+	_pendingLoads.clear();
+	_pendingByGuid.clear();
+	ClearPreloadedResources();
+
+	// The stores themselves stay around, see _resources
+	for (auto& [type, store] : _resources) {
+		store.Resources.clear();
+		store.Sources.clear();
 	}
+	_resident.clear();
+	_residentBytes = 0;
+}
+
+void ResourceManager::SetMemoryBudget(size_t bytes) {
+	_memoryBudget = bytes;
+}
+
+size_t ResourceManager::GetMemoryBudget() {
+	return _memoryBudget;
 }
 
+void ResourceManager::EnforceMemoryBudget() {
+	// The running total keeps this cheap enough to call every frame, we only look at the resources when it's over
+	if (_memoryBudget == 0 || _residentBytes <= _memoryBudget) {
+		_wasOverBudget = false;
+		return;
+	}
+
+	struct Candidate {
+		TypeStore* Store;
+		Guid        Id;
+		size_t      Size;
+		uint64_t    LastUsed;
+	};
+
+	// Measure everything again while we're at it, since resources can change size while they're held
+	size_t total = 0;
+	std::vector<Candidate> candidates;
+	for (auto& [type, store] : _resources) {
+		for (auto& [guid, res] : store.Resources) {
+			if (res == nullptr) {
+				continue;
+			}
+			size_t size = res->GetCpuMemoryUsage() + res->GetGpuMemoryUsage();
+			ResidentInfo& info = _resident[guid];
+			info.Size = size;
+			total += size;
+
+			// If anything else is holding on to the resource, unloading it wouldn't free anything
+			if (res.use_count() == 1 && size > 0 && res->IsReloadable()) {
+				candidates.push_back({ &store, guid, size, info.LastUsed });
+			}
+		}
+	}
+	_residentBytes = total;
+
+	if (total <= _memoryBudget) {
+		_wasOverBudget = false;
+		return;
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+		return a.LastUsed < b.LastUsed;
+	});
+
+	size_t numEvicted = 0;
+	size_t evictedBytes = 0;
+	for (const Candidate& candidate : candidates) {
+		if (total <= _memoryBudget) {
+			break;
+		}
+
+		// The resource may have been changed since it was loaded, so store its current state for the next time it's loaded
+		auto it = candidate.Store->Resources.find(candidate.Id);
+		std::string guid = candidate.Id.str();
+		_manifest[candidate.Store->TypeName][guid] = it->second->ToJson();
+		_manifest[candidate.Store->TypeName][guid]["guid"] = guid;
+
+		candidate.Store->Resources.erase(it);
+		_resident.erase(candidate.Id);
+		total -= candidate.Size;
+		numEvicted++;
+		evictedBytes += candidate.Size;
+	}
+	_residentBytes = total;
+
+	_numEvicted += numEvicted;
+	_evictedBytes += evictedBytes;
+	if (numEvicted > 0) {
+		LOG_INFO("Unloaded {} unused resources ({:.1f}MB) to stay within the resource memory budget", numEvicted, evictedBytes / (1024.0 * 1024.0));
+	}
+	if (total > _memoryBudget && !_wasOverBudget) {
+		LOG_WARN("Resources in use are over the memory budget ({:.1f}MB / {:.1f}MB)", total / (1024.0 * 1024.0), _memoryBudget / (1024.0 * 1024.0));
+	}
+	_wasOverBudget = total > _memoryBudget;
+}
+
+ResourceManager::MemoryStats ResourceManager::GetMemoryStats() {
+	MemoryStats result = { 0, 0, 0, _memoryBudget, _numEvicted, _evictedBytes, _numDeduplicated, _deduplicatedBytes };
+	for (auto& [type, store] : _resources) {
+		for (auto& [guid, res] : store.Resources) {
+			if (res != nullptr) {
+				result.NumResident++;
+				result.CpuBytes += res->GetCpuMemoryUsage();
+				result.GpuBytes += res->GetGpuMemoryUsage();
+			}
+		}
+	}
+	return result;
+}
@@ -3,17 +3,102 @@
 #include <json.hpp>
 #include <unordered_map>
 #include <typeindex>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
 
 #include "Utils/GUID.hpp"
 #include "Utils/ResourceManager/IResource.h"
 #include "Utils/StringUtils.h"
 
+/// <summary>
+/// The shared state for a resource that is being loaded in the background, see ResourceManager::GetAsync
+/// </summary>
+struct PendingResourceLoad {
+	typedef std::shared_ptr<PendingResourceLoad> Sptr;
+
+	enum class LoadState {
+		Queued,   // Waiting for a worker to pick it up
+		Decoding, // A worker is reading and decoding the resource's files
+		Decoded,  // Waiting for the main thread to create the resource
+		Done      // Result has been set, and will not change
+	};
+
+	std::string            TypeName;
+	nlohmann::json         Blob;
+	Guid                   Id;
+	std::atomic<LoadState> State;
+	// Only valid once State is Done, nullptr if the resource could not be loaded
+	IResource::Sptr        Result;
+
+	PendingResourceLoad() : TypeName(""), Blob(nlohmann::json()), Id(), State(LoadState::Queued), Result(nullptr) {}
+};
+
+/// <summary>
+/// A handle to a resource that may still be loading, returned by ResourceManager::GetAsync
+/// </summary>
+/// <typeparam name="T">The type of resource being loaded</typeparam>
+template <typename T>
+class ResourceHandle {
+public:
+	ResourceHandle() : _resource(nullptr), _load(nullptr) {}
+	ResourceHandle(const std::shared_ptr<T>& resource) : _resource(resource), _load(nullptr) {}
+	ResourceHandle(const PendingResourceLoad::Sptr& load) : _resource(nullptr), _load(load) {}
+
+	/// <summary>
+	/// Returns true once the load has finished, the resource may still be null if it failed
+	/// </summary>
+	bool IsReady() const {
+		return _load == nullptr || _load->State == PendingResourceLoad::LoadState::Done;
+	}
+
+	/// <summary>
+	/// Gets the resource, or nullptr if it hasn't finished loading or the load failed
+	/// </summary>
+	std::shared_ptr<T> Get() const {
+		if (_resource == nullptr && _load != nullptr && _load->State == PendingResourceLoad::LoadState::Done) {
+			// Loads are only shared between requests for the same type, so the result is always a T
+			_resource = std::static_pointer_cast<T>(_load->Result);
+			_load = nullptr;
+		}
+		return _resource;
+	}
+
+	/// <summary>
+	/// Finishes the load right away if it is still pending, blocking until the resource has been created.
+	/// Must be called from the main thread
+	/// </summary>
+	std::shared_ptr<T> Wait() const;
+
+private:
+	mutable std::shared_ptr<T>         _resource;
+	mutable PendingResourceLoad::Sptr  _load;
+};
+
 /// <summary>
 /// Utility class for managing and loading resources from JSON
 /// manifest files
 /// </summary>
 class ResourceManager {
 public:
+	/// <summary>
+	/// Stats on how much memory the loaded resources are using, and how much has been freed to stay within the budget
+	/// </summary>
+	struct MemoryStats {
+		size_t NumResident;
+		size_t CpuBytes;
+		size_t GpuBytes;
+		// 0 if there is no budget
+		size_t Budget;
+		// Totals since startup
+		size_t NumEvicted;
+		size_t EvictedBytes;
+		// Resources that CreateAsset handed out again instead of loading a duplicate, and the memory that saved
+		size_t NumDeduplicated;
+		size_t DeduplicatedBytes;
+	};
+
 	/// <summary>
 	/// Initializes the resource manager and performs any first-time
 	/// setup required
@@ -21,7 +106,9 @@ public:
 	static void Init();
 
 	/// <summary>
-	/// Creates a new asset, and forwards the arguments to it's constructor
+	/// Creates a new asset, and forwards the arguments to it's constructor. If the type defines a source key
+	/// for the arguments (see IResource) and an asset has already been created from the same source, that
+	/// asset is returned instead of loading the source again, unless it has been changed since then
 	/// </summary>
 	/// <typeparam name="T">The type of asset to create</typeparam>
 	/// <typeparam name="...TArgs">The types for the arguments to forward to the constructor</typeparam>
@@ -29,9 +116,38 @@ public:
 	/// <returns>The GUID of the newly created asset</returns>
 	template <typename T, typename ... TArgs, typename = std::enable_if<is_valid_resource<T>()>::type>
 	static std::shared_ptr<T> CreateAsset(TArgs&&... args) {
+		TypeStore& store = _GetStore<T>();
+
+		// Share resources that come from the same source, rather than decoding and uploading it again
+		std::string sourceKey;
+		if constexpr (has_source_key<T, TArgs...>::value) {
+			sourceKey = T::GetSourceKey(args...);
+			auto source = sourceKey.empty() ? store.Sources.end() : store.Sources.find(sourceKey);
+			if (source != store.Sources.end()) {
+				// If it was evicted, Get will load it again from the manifest
+				bool isResident = store.Resources.find(source->second) != store.Resources.end();
+				std::shared_ptr<T> existing = Get<T>(source->second);
+				// If the first caller changed it after loading it (ex: set a different filter), it no longer
+				// matches the key, so we load a fresh copy and leave theirs alone
+				std::string currentKey = existing != nullptr ? existing->GetCurrentSourceKey() : std::string();
+				if (existing != nullptr && (currentKey.empty() || currentKey == sourceKey)) {
+					if (isResident) {
+						_numDeduplicated++;
+						_deduplicatedBytes += existing->GetGpuMemoryUsage() + existing->GetCpuMemoryUsage();
+					}
+					existing->_isShared = true;
+					return existing;
+				}
+			}
+		}
+
 		// Create and store the asset
 		std::shared_ptr<T> asset = std::make_shared<T>(std::forward<TArgs>(args)...);
-		_resources[std::type_index(typeid(T))][asset->IResource::GetGUID()] = asset;
+		store.Resources[asset->IResource::GetGUID()] = asset;
+		if (!sourceKey.empty()) {
+			store.Sources[sourceKey] = asset->IResource::GetGUID();
+		}
+		_Touch(asset->IResource::GetGUID(), asset);
 
 		// Get the JSON representation of the asset so we can store it in the manifest
 		nlohmann::json data = asset->ToJson();
@@ -41,7 +157,7 @@ public:
 		data["guid"] = guid;
 
 		// Store the JSON data in the resource manifest (based on the type's name)
-		_manifest[StringTools::SanitizeClassName(typeid(T).name())][guid] = data;
+		_manifest[store.TypeName][guid] = data;
 		return asset;
 	}
 
@@ -53,28 +169,73 @@ public:
 	/// <returns>The resource with the given GUID, or nullptr if none exists</returns>
 	template<typename T, typename = std::enable_if<is_valid_resource<T>()>::type>
 	static std::shared_ptr<T> Get(Guid id) {
-		// Try and grab the asset from the resource pool
-		std::shared_ptr<T> result =  std::dynamic_pointer_cast<T>(_resources[std::type_index(typeid(T))][id]);
+		// Try and grab the asset from the resource pool, only T's loader and CreateAsset<T> add
+		// resources to T's store so we can skip the dynamic cast
+		TypeStore& store = _GetStore<T>();
+		auto it = store.Resources.find(id);
+		if (it != store.Resources.end() && it->second != nullptr) {
+			_Touch(id, it->second);
+			return std::static_pointer_cast<T>(it->second);
+		}
 
-		// If the asset is null, we can try finding it in the manifest to load it
-		if (result == nullptr) {
-			// Get the type name it'll be stored under
-			std::string typeName = StringTools::SanitizeClassName(typeid(T).name());
+		// If it's already loading in the background, finish that load instead of starting over
+		auto pending = _pendingByGuid.find(id);
+		if (pending != _pendingByGuid.end() && pending->second->TypeName == store.TypeName) {
+			PendingResourceLoad::Sptr load = pending->second;
+			_FinishLoad(load);
+			return std::static_pointer_cast<T>(load->Result);
+		}
 
-			// If the manifest has an entry, we can load it!
-			if (_manifest[typeName].contains(id)) {
-				// Invoke the loader function with the manifest data
-				_typeLoaders[typeName](_manifest[typeName][id]);
+		// If the manifest has an entry, we can load it!
+		auto entries = _manifest.find(store.TypeName);
+		std::string guid = id.str();
+		if (store.Loader && entries != _manifest.end() && entries->contains(guid)) {
+			// Invoke the loader function with the manifest data
+			store.Loader((*entries)[guid]);
 
-				// Search resources again to get the resource
-				return std::dynamic_pointer_cast<T>(_resources[std::type_index(typeid(T))][id]);
+			// Search resources again to get the resource
+			it = store.Resources.find(id);
+			if (it != store.Resources.end()) {
+				return std::static_pointer_cast<T>(it->second);
 			}
 		}
 
-		// If result wasn't null, or couldn't be found in the manifest, return here
-		return result;
+		// Couldn't be found in the manifest
+		return nullptr;
 	}
 
+	/// <summary>
+	/// Starts loading a resource in the background, and returns a handle that will hold the resource once
+	/// it is ready. Reading and decoding the resource's files happens on the job system's worker threads,
+	/// while creating the resource itself (which creates OpenGL objects) is done on the main thread by
+	/// UpdateAsync. Must be called from the main thread
+	/// </summary>
+	/// <typeparam name="T">The type of resource to retreive</typeparam>
+	/// <param name="id">The ID of the resource to retrieve</param>
+	/// <returns>A handle to the resource, which is ready right away if the resource is already loaded</returns>
+	template<typename T, typename = std::enable_if<is_valid_resource<T>()>::type>
+	static ResourceHandle<T> GetAsync(Guid id) {
+		TypeStore& store = _GetStore<T>();
+		auto it = store.Resources.find(id);
+		if (it != store.Resources.end() && it->second != nullptr) {
+			_Touch(id, it->second);
+			return ResourceHandle<T>(std::static_pointer_cast<T>(it->second));
+		}
+		return ResourceHandle<T>(_QueueLoad(store.TypeName, id));
+	}
+
+	/// <summary>
+	/// Creates resources that were requested with GetAsync and have finished decoding, in the order they
+	/// were requested. Must be called once per frame from the main thread. At least one resource is
+	/// created per call (if any are ready), so loads always progress
+	/// </summary>
+	/// <param name="budget">The time in seconds that we can spend creating resources this frame</param>
+	static void UpdateAsync(double budget);
+	/// <summary>
+	/// Gets the number of resources requested with GetAsync that have not finished loading
+	/// </summary>
+	static size_t NumPendingLoads();
+
 	/// <summary>
 	/// Registers a resource type with the resource manager, only types that have been registered
 	/// can be loaded from JSON manifest files!
@@ -83,17 +244,28 @@ public:
 	/// <typeparam name=""></typeparam>
 	template <typename T, typename = std::enable_if<is_valid_resource<T>()>::type>
 	static void RegisterType() {
-		// Extract the type name from a sanitized version of they typeid name
-		std::string typeName = StringTools::SanitizeClassName(typeid(T).name());
+		// The store's type name is a sanitized version of the typeid name
+		TypeStore& store = _GetStore<T>();
+		const std::string& typeName = store.TypeName;
+
+		// Remember which store the name belongs to, so we can look up resources by type name
+		_typeStores.emplace(typeName, &store);
 
-		// Create the type loader for the type
-		_typeLoaders[typeName] = [](const nlohmann::json& data) {
-			IResource::Sptr res = T::FromJson(data);
+		// Create the type loader for the type, FromJson gives us a T so we know it's safe to store
+		store.Loader = [](const nlohmann::json& data) {
+			std::shared_ptr<T> res = T::FromJson(data);
 			res->OverrideGUID(Guid(data["guid"]));
-			_resources[std::type_index(typeid(T))][res->GetGUID()] = res;
+			_GetStore<T>().Resources[res->GetGUID()] = res;
+			_Touch(res->GetGUID(), res);
 			return res->GetGUID();
 		};
 
+		// Types that read files can do that part of the load on worker threads
+		if constexpr (has_preload<T>::value) {
+			store.Preload = &T::Preload;
+			store.ClearPreloaded = &T::ClearPreloadedFiles;
+		}
+
 		// Make sure we haven't registered the type yet, then add an empty object
 		// to the manifest to ensure it can be saved
 		if (!_manifest.contains(typeName)) {
@@ -112,15 +284,12 @@ public:
 		typename = typename std::enable_if<std::is_base_of<IResource, ResourceType>::value>::type>
 		static void Each(std::function<void(const std::shared_ptr<ResourceType>&)> callback, bool includeDisabled = false) {
 
-		// We can use typeid and type_index to get a unique ID for our types
-		std::type_index type = std::type_index(typeid(ResourceType));
-
 		// Iterate over all the resources in the store
-		for (auto& [key, value] : _resources[type]) {
+		for (auto& [key, value] : _GetStore<ResourceType>().Resources) {
 			// If the pointer is alive and matches our enabled criteria, invoke the callback
 			if (value != nullptr) {
-				// Upcast to resource type and invoke the callback
-				callback(std::dynamic_pointer_cast<ResourceType>(value));
+				// Everything in the store is a ResourceType, see Get
+				callback(std::static_pointer_cast<ResourceType>(value));
 			}
 		}
 	}
@@ -132,11 +301,48 @@ public:
 	/// <summary>
 	/// Loads a manifest file into the resource manager. Note that this will not perform load on the assets themselves 
 	/// unless preloadAssets is set to true
+	///
+	/// When preloading, files are decoded on the job system's worker threads all at once, and each resource
+	/// is created on the main thread as soon as it's decoded and everything it refers to (ex: a material's
+	/// shader and textures) has been created
 	/// </summary>
 	/// <param name="path">The path to the JSON manifest file</param>
 	/// <param name="preloadAssets">True if all assets should be loaded into memory</param>
 	static void LoadManifest(const std::string& path, bool preloadAssets = false);
 	/// <summary>
+	/// Replaces the current manifest with one that has already been parsed (ex: on a worker thread).
+	/// Like LoadManifest, assets are not loaded until they are requested or loaded with LoadResource
+	/// </summary>
+	/// <param name="manifest">The manifest to use</param>
+	static void SetManifest(const nlohmann::ordered_json& manifest);
+	/// <summary>
+	/// Loads a single resource from its manifest entry, unless a resource with the same GUID has
+	/// already been loaded. This will create any OpenGL objects the resource needs, so it must be
+	/// called from the main thread
+	/// </summary>
+	/// <param name="typeName">The name of the resource type, as used for the manifest</param>
+	/// <param name="blob">The resource's manifest entry</param>
+	/// <returns>True if the resource is loaded, false if the type has not been registered</returns>
+	static bool LoadResource(const std::string& typeName, const nlohmann::json& blob);
+	/// <summary>
+	/// Returns true if the given resource type can do part of its loading ahead of time with PreloadResource
+	/// </summary>
+	/// <param name="typeName">The name of the resource type, as used for the manifest</param>
+	static bool CanPreload(const std::string& typeName);
+	/// <summary>
+	/// Reads and decodes any files needed by a resource, so that the main thread only has to upload them
+	/// when the resource is loaded. This is safe to call from any thread, as long as no types are being
+	/// registered at the same time. Does nothing for types that don't support preloading
+	/// </summary>
+	/// <param name="typeName">The name of the resource type, as used for the manifest</param>
+	/// <param name="blob">The resource's manifest entry</param>
+	static void PreloadResource(const std::string& typeName, const nlohmann::json& blob);
+	/// <summary>
+	/// Frees any preloaded data that was never used by a resource. Pending background loads that were
+	/// already decoded will decode their files again on the main thread
+	/// </summary>
+	static void ClearPreloadedResources();
+	/// <summary>
 	/// Saves the manifest to the given JSON file
 	/// </summary>
 	/// <param name="path">The path to the file to output</param>
@@ -147,21 +353,146 @@ public:
 	/// </summary>
 	static void Cleanup();
 
+	/// <summary>
+	/// Sets how much memory (CPU and GPU combined) the loaded resources may use before the resource
+	/// manager starts unloading resources that aren't in use, see EnforceMemoryBudget
+	/// </summary>
+	/// <param name="bytes">The budget in bytes, or 0 for no limit</param>
+	static void SetMemoryBudget(size_t bytes);
+	static size_t GetMemoryBudget();
+	/// <summary>
+	/// If the loaded resources are over the memory budget, unloads resources that nothing outside of the
+	/// resource manager is using, least recently used first, until we're back under budget. Only resources
+	/// that can be reloaded are unloaded, their manifest entries are updated so that the next Get will load
+	/// them again as they were. Should be called once per frame from the main thread
+	/// </summary>
+	static void EnforceMemoryBudget();
+	/// <summary>
+	/// Gets the current memory use of all loaded resources, along with eviction totals
+	/// </summary>
+	static MemoryStats GetMemoryStats();
+
 protected:
 	/// <summary>
-	/// This is a map of maps
-	/// The top level map uses type_index, so there's a map per resource type
-	/// The inner map handles mapping GUIDs to the corresponding resource
+	/// Everything we know about a single resource type, and all of the loaded resources of that type.
+	/// Only the type's loader and CreateAsset add resources, so everything in a type's store is of that
+	/// type, which lets us use static casts when handing resources out
+	/// </summary>
+	struct TypeStore {
+		// The name the type is stored under in the manifest
+		std::string TypeName;
+		// Loads a resource from its manifest entry, empty until the type is registered
+		std::function<Guid(const nlohmann::json&)> Loader;
+		// The preload and cleanup functions for types that support preloading. These are called from worker
+		// threads, so they must only be modified while registering types
+		std::function<void(const nlohmann::json&)> Preload;
+		std::function<void()> ClearPreloaded;
+		// The loaded resources, keyed by GUID
+		std::unordered_map<Guid, IResource::Sptr> Resources;
+		// The resource created from each source key by CreateAsset. Entries stay when a resource is evicted,
+		// so that the same GUID is reloaded
+		std::unordered_map<std::string, Guid> Sources;
+	};
+
+	/// <summary>
+	/// One store per resource type. Stores are never removed (Cleanup only empties them), and elements of
+	/// an unordered_map never move, so pointers to stores stay valid for the lifetime of the application
+	/// </summary>
+	static std::unordered_map<std::type_index, TypeStore> _resources;
+	/// <summary>
+	/// Maps registered type names to their store in _resources
+	/// </summary>
+	static std::unordered_map<std::string, TypeStore*> _typeStores;
+
+	/// <summary>
+	/// Gets the store for a resource type, creating it if needed. The lookup is only done once per type
 	/// </summary>
-	static std::map<std::type_index, std::map<Guid, IResource::Sptr>> _resources;
+	template <typename T>
+	static TypeStore& _GetStore() {
+		static TypeStore* store = &_InitStore(std::type_index(typeid(T)));
+		return *store;
+	}
+	static TypeStore& _InitStore(const std::type_index& type);
+	/// <summary>
+	/// Marks a resource as just used, and updates its size in the running total
+	/// </summary>
+	static void _Touch(const Guid& id, const IResource::Sptr& resource);
+
 	/// <summary>
-	/// This map stores registered types, so we can load them from JSON files
+	/// What we know about each loaded resource for enforcing the memory budget
 	/// </summary>
-	static std::map<std::string, std::function<Guid(const nlohmann::json&)>> _typeLoaders;
+	struct ResidentInfo {
+		// The value of _useCounter when the resource was last loaded or requested, for picking what to evict
+		uint64_t LastUsed = 0;
+		// The resource's memory use when it was last loaded or requested
+		size_t   Size = 0;
+	};
+	static std::unordered_map<Guid, ResidentInfo> _resident;
+	static uint64_t _useCounter;
+	// The sum of the sizes in _resident, so we only have to look at every resource when we might be over budget.
+	// Resources that change size while they're held are caught up the next time they're requested, or when we scan
+	static size_t _residentBytes;
+	// Set while the resources in use are over the budget, so we only warn when we first go over
+	static bool _wasOverBudget;
+	static size_t _memoryBudget;
+	static size_t _numEvicted;
+	static size_t _evictedBytes;
+	static size_t _numDeduplicated;
+	static size_t _deduplicatedBytes;
+
+	/// <summary>
+	/// Background loads that have not been created on the main thread yet, in the order they were requested
+	/// </summary>
+	static std::vector<PendingResourceLoad::Sptr> _pendingLoads;
+	/// <summary>
+	/// The loads that are not done yet (from _pendingLoads, and from preloading the manifest), so repeat
+	/// requests share the same load
+	/// </summary>
+	static std::unordered_map<Guid, PendingResourceLoad::Sptr> _pendingByGuid;
+	/// <summary>
+	/// Notified by the workers every time they finish decoding a load, so the main thread can sleep
+	/// while it waits on them
+	/// </summary>
+	static std::mutex              _decodeMutex;
+	static std::condition_variable _decodeFinished;
+
+	/// <summary>
+	/// Starts a background load for a resource in the manifest, or returns the existing load for it
+	/// </summary>
+	static PendingResourceLoad::Sptr _QueueLoad(const std::string& typeName, Guid id);
+	/// <summary>
+	/// Starts decoding the files for a load on a worker thread, if its type supports preloading. Otherwise
+	/// the load is marked as decoded right away, and all the work is done when the resource is created
+	/// </summary>
+	static void _SubmitDecode(const PendingResourceLoad::Sptr& load);
+	/// <summary>
+	/// Loads every resource in the manifest, see LoadManifest
+	/// </summary>
+	static void _PreloadManifest();
+	/// <summary>
+	/// Creates the resource for a background load on the main thread. If no worker has started
+	/// decoding it yet the whole load is done here, otherwise we wait for the worker to finish
+	/// </summary>
+	static void _FinishLoad(const PendingResourceLoad::Sptr& load);
+	/// <summary>
+	/// Blocks until no worker is decoding the given load
+	/// </summary>
+	static void _WaitForDecode(const PendingResourceLoad::Sptr& load);
+
+	template <typename T>
+	friend class ResourceHandle;
 
 	/// <summary>
 	/// We use an ORDERED JSON file to allow serializing types in the order they are registered.
 	/// This allows us to register dependencies before the dependent resource
 	/// </summary>
 	static nlohmann::ordered_json _manifest;
-};
\ No newline at end of file
+};
+
+template <typename T>
+std::shared_ptr<T> ResourceHandle<T>::Wait() const {
+	if (_load != nullptr) {
+		ResourceManager::_FinishLoad(_load);
+	}
+	return Get();
+}